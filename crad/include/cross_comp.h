@@ -10,21 +10,61 @@
 #if defined(__unix__) || defined(__APPLE__)
 #define CCM_FILE_SYSTEM_SEP "/"
 
+#include "stddef.h"
+#include "stdio.h"
+
 int mkdirp(const char *path, int mode);
+int rename_replace(const char *from, const char *to);
+void *map_file(const char *filename, size_t *size);
+void unmap_file(void *addr, size_t size);
+void *shm_create(const char *name, size_t size);
+void *shm_attach(const char *name, size_t *size);
+void shm_remove(const char *name);
+int seek_file(FILE *fh, unsigned long long offset);
+int sync_file(FILE *fh);
+
+int cpus_available(int *cpus, int n);
+int pin_thread(int cpu);
+
+#define aligned_free(ptr) free(ptr)
+
+#define CCM_THREAD_LOCAL _Thread_local
 
 #elif defined(_WIN32) || defined(_WIN64)
 #define CCM_FILE_SYSTEM_SEP "\\"
 
 #define _CRT_SECURE_NO_WARNINGS
 
+#include "stddef.h"
+#include "stdio.h"
+
 #define __PRETTY_FUNCTION__ __FUNCSIG__
 
 #define mkdirp(path, mode) mkdirp_w(path)
 
 int mkdirp_w(const char *path);
+int rename_replace(const char *from, const char *to);
+void *map_file(const char *filename, size_t *size);
+void unmap_file(void *addr, size_t size);
+void *shm_create(const char *name, size_t size);
+void *shm_attach(const char *name, size_t *size);
+void shm_remove(const char *name);
+int seek_file(FILE *fh, unsigned long long offset);
+int sync_file(FILE *fh);
+
+int cpus_available(int *cpus, int n);
+int pin_thread(int cpu);
 
 #define localtime_r(prawtime, ptm) localtime_s(ptm, prawtime);
 #define asctime_r(ptm, timestamp) asctime_s(timestamp, 26, ptm);
+#define strtok_r(str, delim, saveptr) strtok_s(str, delim, saveptr)
+
+#include "malloc.h"
+
+#define aligned_alloc(align, size) _aligned_malloc(size, align)
+#define aligned_free(ptr) _aligned_free(ptr)
+
+#define CCM_THREAD_LOCAL __declspec(thread)
 
 #else
 #error Operating system is not supported.
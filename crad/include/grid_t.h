@@ -32,6 +32,7 @@ typedef struct grid_st grid_t;
 
 void grid_init(grid_t *g, short n, double m, double M, double w);
 void grid_init_str(grid_t *g, const char *init_str);
+int grid_reset_str(grid_t *g, const char *init_str);
 
 void grid_copy(grid_t *dest, const grid_t *source);
 
@@ -2,7 +2,8 @@
  * @brief Logging macros
  * @details To reset the logging level in a file, (re)define the macro
  *   RAD_LOG_LEVEL
- * and include this file. */
+ * and include this file. Messages are passed to the log sink of the current
+ * context if one is set (see rad_ctx.h). */
 
 #ifndef _LOGGER_MACROS_H_
 #define _LOGGER_MACROS_H_
@@ -25,6 +26,25 @@
 #define _LOG_FUNCTION_TAG "Function      : "
 #define _LOG_THREAD_TAG "Thread %d : ", thrd_current()
 
+/* Log mode levels */
+#define _LOG_ERROR_LEVEL 1
+#define _LOG_WARN_LEVEL 2
+#define _LOG_INFO_LEVEL 3
+#define _LOG_VERB_LEVEL 4
+#define _LOG_DEBUG_LEVEL 5
+#define _LOG_FUNCTION_LEVEL 6
+#define _LOG_THREAD_LEVEL 7
+
+/* Size of formatted messages */
+#define RAD_LOG_BUFFER_SZ 1024
+
+#if defined(__GNUC__)
+int rad_log(int level, char *msg, const char *fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+#else
+int rad_log(int level, char *msg, const char *fmt, ...);
+#endif /* __GNUC__ */
+
 /* Set log buffers */
 #define _LOG_ERROR_BUFFER stderr
 #define _LOG_ERROR_FILE NULL
@@ -41,15 +61,18 @@
 #define _LOG_THREAD_BUFFER stdout
 #define _LOG_THREAD_FILE NULL
 
-/* Define logging macro with locking */
+/* Define logging macro with locking (the arguments are evaluated once) */
 #define _LOG_OUT_AP(mode, ...)                                                 \
-  {                                                                            \
-    lock_output_buffer(_LOG##mode##BUFFER);                                    \
-    fprintf(_LOG##mode##BUFFER, _LOG##mode##TAG);                              \
-    fprintf(_LOG##mode##BUFFER, __VA_ARGS__);                                  \
-    fprintf(_LOG##mode##BUFFER, "\n");                                         \
-    unlock_output_buffer(_LOG##mode##BUFFER);                                  \
-  }
+  do {                                                                         \
+    char _log_msg[RAD_LOG_BUFFER_SZ];                                          \
+    if (!rad_log(_LOG##mode##LEVEL, _log_msg, __VA_ARGS__)) {                  \
+      lock_output_buffer(_LOG##mode##BUFFER);                                  \
+      fprintf(_LOG##mode##BUFFER, _LOG##mode##TAG);                            \
+      fputs(_log_msg, _LOG##mode##BUFFER);                                     \
+      fputc('\n', _LOG##mode##BUFFER);                                         \
+      unlock_output_buffer(_LOG##mode##BUFFER);                                \
+    }                                                                          \
+  } while (0)
 #define _LOG_OUT(mode, ...) _LOG_OUT_AP(mode, __VA_ARGS__)
 
 #endif /* _LOGGER_MACROS_H_ */
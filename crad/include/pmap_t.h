@@ -28,6 +28,8 @@ typedef struct pmap_st pmap_t;
 int pmap_init(pmap_t *pmap, const char *pfilename);
 
 void pmap_add(pmap_t *pmap, const char *key, const char *val);
+void pmap_set(pmap_t *pmap, const char *key, const char *val);
+void pmap_copy(pmap_t *dest, const pmap_t *source);
 void pmap_add_int(pmap_t *pmap, const char *key, int val);
 void pmap_add_double(pmap_t *pmap, const char *key, double val);
 void pmap_save(const pmap_t *pmap, const char *pfilename);
@@ -0,0 +1,59 @@
+/** @file rad_cache.h
+ * @brief Content-addressed solution cache.
+ * @details Solved setups are stored in a cache directory under a key that is
+ * derived from their configuration, so that a repeated solve of the same
+ * configuration, e.g. by another user, notebook or sweep, loads the stored
+ * solution instead of iterating. The configuration is written in a canonical
+ * text form, i.e. the solver version, the model parameters, the functional
+ * specification (see rad_specs.h), the grid specifications, the adaptation
+ * scales and the tolerance, one `key = value` line each with all the digits
+ * of the numbers. The key is the 64-bit FNV-1a hash of the text in
+ * hexadecimal notation. Thread counts, budgets, warm starts and other
+ * settings that do not define the model or its accuracy are not part of the
+ * key.
+ *
+ * An entry consists of the text (`<key>.key`), the converged solution
+ * (`<key>.rad`) and the last state of a halted solve of the configuration
+ * (`<key>.part.rad`, see rad_file.h). The entries are placed in
+ * subdirectories named by the first two digits of their keys. Files are
+ * written under unique names and renamed when they are complete, so that
+ * concurrent processes can share a cache. A solution is only loaded if the
+ * stored text matches the configuration, thus hash collisions are misses. */
+
+#ifndef RAD_CACHE_H_
+#define RAD_CACHE_H_
+
+#include "rad_conf.h"
+#include "rad_types.h"
+
+#include "stdbool.h"
+
+/** Key size in bytes (including the terminating zero) */
+#define CACHE_KEY_SZ 17
+/** Key file extension */
+#define RAD_CACHE_KEY_EXT ".key"
+/** Extension of the halted solves (before RAD_FILE_EXT) */
+#define RAD_CACHE_PART_EXT ".part"
+
+/** @brief Cache structure
+ * @details Describes the cache entry of a configured setup */
+struct cache_st {
+  /** @brief Cache directory */
+  char dir[RAD_PATH_BUFFER_SZ];
+  /** @brief Key of the configuration (empty if there is none) */
+  char key[CACHE_KEY_SZ];
+  /** @brief Canonical text of the configuration (NULL if there is none) */
+  char *text;
+};
+/** @brief Cache type */
+typedef struct cache_st cache_t;
+
+int cache_init(cache_t *h, const char *dir);
+void cache_key(cache_t *h, const model_t *m, const sol_t *s);
+int cache_load(const cache_t *h, bool partial, const objpart_t *objparts,
+               model_t *m, sol_t *s);
+int cache_store(const cache_t *h, bool partial, const model_t *m,
+                const sol_t *s);
+void cache_free(cache_t *h);
+
+#endif /* RAD_CACHE_H_ */
@@ -0,0 +1,86 @@
+/** @file rad_ckpt.h
+ * @brief Background checkpointing.
+ * @details Periodic saves of a running solve are taken as snapshots, i.e.
+ * memory copies of the model and the solution, and they are written to the
+ * file system by a dedicated I/O thread while the solver continues. At most
+ * RAD_SAVE_QUEUE snapshots are outstanding; further saves wait for a free
+ * snapshot. Saves are container files (see rad_file.h) that are either
+ * complete or absent. Their variables are encoded with RAD_SAVE_ENCODING; delta
+ * saves depend on the previous save. If RAD_SAVE_KEEP is positive, older saves
+ * are removed as new ones are published. If the thread backend cannot create
+ * single threads (see RAD_THREADS_FORK_JOIN), the snapshots are written
+ * synchronously. */
+
+#ifndef RAD_CKPT_H_
+#define RAD_CKPT_H_
+
+#include "rad_conf.h"
+#include "rad_threads.h"
+#include "rad_types.h"
+
+#include "stdbool.h"
+
+struct rad_ctx_st;
+
+/** @brief Snapshot structure */
+struct snapshot_st {
+  /** @brief Model copy */
+  model_t m;
+  /** @brief Solution copy */
+  sol_t s;
+  /** @brief Save path */
+  char path[RAD_PATH_BUFFER_SZ];
+};
+
+/** @brief Retained save structure */
+struct retained_st {
+  /** @brief Save path */
+  char path[RAD_PATH_BUFFER_SZ];
+  /** @brief The save does not depend on previous saves */
+  bool key;
+};
+
+/** @brief Checkpointer structure */
+struct ckpt_st {
+  /** @brief Execution context of the I/O thread */
+  const struct rad_ctx_st *x;
+  /** @brief Snapshot ring */
+  struct snapshot_st *snaps;
+  /** @brief Number of snapshots */
+  int n;
+  /** @brief Index of the next snapshot to be written */
+  int head;
+  /** @brief Number of outstanding snapshots */
+  int count;
+  /** @brief Snapshots are written by the I/O thread */
+  bool async;
+  /** @brief The I/O thread should exit */
+  bool stop;
+  /** @brief I/O thread */
+  rad_thrd_t thread;
+  /** @brief Snapshot ring mutex */
+  rad_mtx_t mtx;
+  /** @brief A snapshot is pushed */
+  rad_cnd_t pushed;
+  /** @brief A snapshot is written */
+  rad_cnd_t written;
+  /** @brief Base of delta saves (the last published solution) */
+  sol_t base;
+  /** @brief Save path of the base */
+  char base_path[RAD_PATH_BUFFER_SZ];
+  /** @brief Number of delta saves since the last full save */
+  int chain;
+  /** @brief Retained saves, oldest first (NULL if all are retained) */
+  struct retained_st *kept;
+  /** @brief Number of retained saves */
+  int nkept;
+};
+/** @brief Checkpointer type */
+typedef struct ckpt_st ckpt_t;
+
+void ckpt_init(ckpt_t *k, int n, const struct rad_ctx_st *x);
+void ckpt_push(ckpt_t *k, const model_t *m, const sol_t *s, const char *path);
+void ckpt_drain(ckpt_t *k);
+void ckpt_free(ckpt_t *k);
+
+#endif /* RAD_CKPT_H_ */
@@ -0,0 +1,35 @@
+/** @file rad_codec.h
+ * @brief Lossless compression of floating point arrays.
+ * @details Arrays of doubles are compressed by regrouping their bytes by
+ * significance (byte shuffle) and compressing the result with a byte-oriented
+ * LZ77 codec. After the shuffle, the sign, exponent and leading mantissa bytes
+ * of smooth data form long runs that the LZ codec removes. Differences of
+ * consecutive approximations are encoded by combining the bit patterns of the
+ * values with the ones of a base array (see codec_xor()) before shuffling.
+ *
+ * The LZ stream is a sequence of blocks. Each block consists of a token byte,
+ * whose high and low nibbles are the literal and match lengths, the literals,
+ * a two-byte little-endian match offset and the match length's extension.
+ * Lengths of fifteen or more are extended by bytes that are added to them
+ * until a byte is smaller than 255. The minimum match length is
+ * CODEC_MIN_MATCH. The last block consists only of literals. */
+
+#ifndef RAD_CODEC_H_
+#define RAD_CODEC_H_
+
+#include "stddef.h"
+#include "stdint.h"
+
+/** Minimum match length of the LZ codec */
+#define CODEC_MIN_MATCH 4
+
+void codec_shuffle(uint8_t *dest, const uint8_t *source, size_t n);
+void codec_unshuffle(uint8_t *dest, const uint8_t *source, size_t n);
+void codec_xor(uint8_t *data, const uint8_t *base, size_t size);
+uint32_t codec_crc32(uint32_t crc, const uint8_t *data, size_t n);
+size_t codec_bound(size_t size);
+size_t codec_compress(uint8_t *dest, const uint8_t *source, size_t size);
+int codec_decompress(uint8_t *dest, size_t size, const uint8_t *source,
+                     size_t n);
+
+#endif /* RAD_CODEC_H_ */
@@ -0,0 +1,76 @@
+/** @file rad_ctx.h
+ * @brief Execution context.
+ * @details A context holds the process-level resources of a setup, i.e. the
+ * thread budget, the input and output directories, the log sink and the
+ * allocator of the large arrays. Every setup can have its own context (see
+ * setup_st), so that independent setups can be solved concurrently in one
+ * process. The setup functions make the setup's context current for the
+ * calling thread and for the setup's worker threads. Lower-level functions
+ * (e.g. rad_file_save()) use the current context of the calling thread. If no
+ * context is set, the configuration values (see rad_conf.h) and the standard
+ * streams are used. */
+
+#ifndef RAD_CTX_H_
+#define RAD_CTX_H_
+
+#include "stddef.h"
+
+/** @brief Log sink
+ * @param arg User argument of the sink
+ * @param level Log level (1: error, 2: warning, 3: info, 4: verbose, 5: debug)
+ * @param msg Formatted message without a trailing new line */
+typedef void (*rad_log_fnc)(void *arg, int level, const char *msg);
+
+/** @brief Allocation function
+ * @param arg User argument of the allocator
+ * @param size Size in bytes (a multiple of the alignment)
+ * @param align Alignment in bytes (a power of two)
+ * @return Allocated memory or NULL on failure */
+typedef void *(*rad_alloc_fnc)(void *arg, size_t size, size_t align);
+
+/** @brief Deallocation function
+ * @param arg User argument of the allocator
+ * @param ptr Memory allocated by the allocation function (can be NULL) */
+typedef void (*rad_free_fnc)(void *arg, void *ptr);
+
+/** @brief Context structure
+ * @details A context is initialized with the default values using
+ * rad_ctx_init(). The context should outlive the setups that use it. */
+struct rad_ctx_st {
+  /** @brief Worker thread budget
+   * @details Negative values resolve the number of worker threads from the
+   * parameter file, the environment or the available processors. */
+  int threads;
+  /** @brief Parameter file directory */
+  const char *data_dir;
+  /** @brief Output directory */
+  const char *temp_dir;
+  /** @brief Log sink (NULL logs to the standard streams) */
+  rad_log_fnc log;
+  /** @brief Log sink argument */
+  void *log_arg;
+  /** @brief Allocation function
+   * @details The allocator is used if both functions are set, otherwise
+   * aligned_alloc() and its deallocation (see cross_comp.h) are used. */
+  rad_alloc_fnc alloc;
+  /** @brief Deallocation function */
+  rad_free_fnc free;
+  /** @brief Allocator argument */
+  void *alloc_arg;
+};
+/** @brief Context type */
+typedef struct rad_ctx_st rad_ctx_t;
+
+void rad_ctx_init(rad_ctx_t *x);
+void rad_ctx_set(const rad_ctx_t *x);
+const rad_ctx_t *rad_ctx_get();
+
+const char *rad_data_dir();
+const char *rad_temp_dir();
+
+void *rad_alloc(size_t size);
+void rad_free(void *ptr);
+
+int rad_log(int level, char *msg, const char *fmt, ...);
+
+#endif /* RAD_CTX_H_ */
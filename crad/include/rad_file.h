@@ -0,0 +1,64 @@
+/** @file rad_file.h
+ * @brief Solution container file.
+ * @details A saved setup is stored in a single, self-describing binary file
+ * with the `.rad` extension. All integers are little-endian. The file consists
+ * of
+ *  - a header of RAD_FILE_ALIGN bytes with the magic string `RADSAVE`, the
+ * format version, the number of sections, the file size and the checksum of
+ * the section table,
+ *  - a section table with one entry of RAD_FILE_ALIGN bytes per section that
+ * holds the section's name, data type (numpy notation, e.g. `<f8`), number of
+ * dimensions, encoding, shape, offset, size and checksum and
+ *  - the sections' data, each one starting at a multiple of RAD_FILE_ALIGN
+ * bytes.
+ *
+ * The alignment allows readers to map the file and use the sections in place,
+ * e.g. rad_file_load() and numpy memory maps (see prad/rad.py).
+ *
+ * The `meta` section contains the model parameters, the functional
+ * specification, the grid specifications and the solver's state as text lines
+ * of the form `key = value` (see pmap_t.h). The grid sections (`xg`, `rg`,
+ * `qg` and `sg`) and the variable sections (`v0`, `v1`, `qpol` and `spol`)
+ * contain double arrays. Variables are stored in row-major order with the
+ * wealth as first dimension. Checksums are CRC-32 values (as in zlib).
+ *
+ * Variable sections can be encoded (see rad_codec.h). An encoded section
+ * starts with a 16-byte header that holds its raw size and the checksum of its
+ * raw data, followed by the LZ stream of its shuffled data. The data of delta
+ * sections are combined with the same section of a base file before they are
+ * shuffled; the base file's save path is stored in the `base` meta data key.
+ * The section table's checksum and size refer to the encoded data.
+ *
+ * Files are written to a hidden temporary file in one transfer and renamed to
+ * their final name when they are complete. Thus, a save file is either
+ * complete or absent. */
+
+#ifndef RAD_FILE_H_
+#define RAD_FILE_H_
+
+#include "rad_types.h"
+
+/** Format version */
+#define RAD_FILE_VERSION 2
+/** Header, table entry and section alignment in bytes */
+#define RAD_FILE_ALIGN 64
+/** File extension */
+#define RAD_FILE_EXT ".rad"
+/** Raw section */
+#define RAD_FILE_RAW 0
+/** Compressed section */
+#define RAD_FILE_LZ 1
+/** Compressed delta section */
+#define RAD_FILE_DELTA 2
+#ifndef RAD_FILE_VERIFY
+/** Verify the checksums of the variable sections when loading */
+#define RAD_FILE_VERIFY 0
+#endif
+
+int rad_file_save(const model_t *m, const sol_t *s, const char *path);
+int rad_file_save_enc(const model_t *m, const sol_t *s, const char *path,
+                      int enc, const sol_t *base, const char *base_path);
+int rad_file_load(model_t *m, sol_t *s, const char *path,
+                  const objpart_t *objparts);
+
+#endif /* RAD_FILE_H_ */
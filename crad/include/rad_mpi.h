@@ -0,0 +1,17 @@
+/** @file rad_mpi.h
+ * @brief Distributed-memory communication.
+ * @details Wraps the MPI calls of the solver. The logical state space is split
+ * among the ranks of the world communicator and every rank solves its part
+ * with its own threads. Only the main thread of a rank communicates. If the
+ * solver is built without MPI support (see RAD_MPI), there is a single rank
+ * and the functions do nothing. */
+
+#ifndef RAD_MPI_H_
+#define RAD_MPI_H_
+
+int rad_mpi_init(int *rank, int *size);
+void rad_mpi_max(double *vals, int n);
+void rad_mpi_allgather(double *data, const int *counts, const int *displs);
+void rad_mpi_gather(double *data, const int *counts, const int *displs);
+
+#endif /* RAD_MPI_H_ */
@@ -0,0 +1,134 @@
+/** @file rad_plan.h
+ * @brief Parameter sweep plans.
+ * @details A sweep plan describes the points of a parameter sweep of
+ * rad_pardep with keys of its parameter file that are prefixed by the sweep's
+ * name. Every `<name>.<key>` key, where `<key>` is a key of the parameter file
+ * such as a model parameter (e.g. `delta`) or a policy grid specification
+ * (e.g. `qg`), is a dimension of the sweep. A dimension is either a grid
+ * specification (e.g. `calib.delta = 5, 0.6, 0.97, 1.0`) or a list of values
+ * separated by semicolons (e.g. `calib.qg = 100, 0, 1e5, 1; 200, 0, 1e5, 1`).
+ * The `<name>.design` key selects how the dimensions are combined:
+ *  - `product` (default): the Cartesian product of the dimensions, the last
+ * dimension varies fastest,
+ *  - `lhs`: a Latin hypercube sample of `<name>.samples` points, for which
+ * every dimension gives its bounds and weighting as `m, M[, w]` (the sample is
+ * seeded with `<name>.seed`) and
+ *  - `list`: the points are the i-th values of the dimensions' lists, which
+ * have equal lengths.
+ *
+ * A sweep without dimension keys is the one-dimensional sweep of the `<name>`
+ * parameter over the grid specification of the `<name>g` key (e.g. `deltag`).
+ * The wealth and radius grids cannot be swept, since the points of a sweep are
+ * stored in one sweep store (see rad_sweep.h).
+ *
+ * The manifest `<name>.manifest` in the output directory records the sweep's
+ * specification, its points and the events of the points (`start`, `done`,
+ * `halted` and `failed` lines that are appended and synchronized as they
+ * occur). A sweep whose manifest matches its specification is resumed: the
+ * points of its store are complete and the others are solved, where points
+ * with periodic saves in their directories continue from their last save.
+ * Changes of the parameter file's other keys do not invalidate completed
+ * points.
+ *
+ * A one-dimensional numeric sweep is refined adaptively if its
+ * `<name>.refine` key sets a tolerance (see plan_refine()). After its points
+ * are solved, new points are inserted at the midpoints of the intervals where
+ * the stored policies deviate most from a linear interpolation, until the
+ * deviations are within the tolerance or the sweep has `<name>.budget` points
+ * (four times its initial points by default). The new points are appended to
+ * the manifest, so that a refined sweep is resumed with all its points. */
+
+#ifndef RAD_PLAN_H_
+#define RAD_PLAN_H_
+
+#include "rad_conf.h"
+#include "rad_sweep.h"
+
+#include "stdbool.h"
+#include "stdint.h"
+#include "stdio.h"
+
+struct pmap_st;
+
+/** Maximum number of dimensions */
+#define PLAN_MAX_DIMS 8
+/** Key size in bytes (including the terminating zero) */
+#define PLAN_KEY_SZ 32
+/** Value size in bytes (including the terminating zero) */
+#define PLAN_VALUE_SZ 128
+/** Maximum number of points */
+#define PLAN_MAX_POINTS (1 << 20)
+/** Default budget of a refined sweep in multiples of its initial points */
+#define PLAN_BUDGET 4
+/** Manifest file extension */
+#define RAD_MANIFEST_EXT ".manifest"
+
+/** Cartesian product design */
+#define PLAN_PRODUCT 0
+/** Latin hypercube design */
+#define PLAN_LHS 1
+/** Explicit list design */
+#define PLAN_LIST 2
+
+/** The point is not started */
+#define PLAN_PENDING 0
+/** The point is started (its solve may be partial) */
+#define PLAN_STARTED 1
+/** The point's solve is halted */
+#define PLAN_HALTED 2
+/** The point's solve failed */
+#define PLAN_FAILED 3
+/** The point is solved and stored */
+#define PLAN_DONE 4
+
+/** @brief Plan structure
+ * @details Describes the points of a sweep and its manifest */
+struct plan_st {
+  /** @brief Sweep name */
+  char name[SWEEP_NAME_SZ];
+  /** @brief Design (e.g. PLAN_PRODUCT) */
+  int design;
+  /** @brief Number of dimensions */
+  int nd;
+  /** @brief Keys of the dimensions */
+  char keys[PLAN_MAX_DIMS][PLAN_KEY_SZ];
+  /** @brief All the values of a dimension are numbers */
+  bool numeric[PLAN_MAX_DIMS];
+  /** @brief Coordinate ranges of the dimensions */
+  double span[PLAN_MAX_DIMS];
+  /** @brief Number of points */
+  int n;
+  /** @brief Values of the points [point x dimension x PLAN_VALUE_SZ] */
+  char *vals;
+  /** @brief Coordinates of the points [point x dimension], i.e. the numeric
+   * values or else the list indices */
+  double *coords;
+  /** @brief Point states (e.g. PLAN_DONE) */
+  int *status;
+  /** @brief Refinement tolerance (zero if the sweep is not refined) */
+  double refine;
+  /** @brief Maximum number of points of a refined sweep */
+  int budget;
+  /** @brief Checksum of the specification */
+  uint32_t spec;
+  /** @brief The manifest is rewritten by the first event */
+  bool fresh;
+  /** @brief Open manifest (NULL before the first event) */
+  FILE *fh;
+};
+/** @brief Plan type */
+typedef struct plan_st plan_t;
+
+int plan_init(plan_t *p, const struct pmap_st *pmap, const char *name);
+const char *plan_param(const plan_t *p);
+double plan_value(const plan_t *p, int i);
+double plan_distance(const plan_t *p, int i, int k);
+double plan_gap(const plan_t *p, int i, double value);
+int plan_find(const plan_t *p, double value);
+void plan_apply(const plan_t *p, int i, struct pmap_st *pmap);
+void plan_dir(const plan_t *p, int i, char *dir);
+int plan_mark(plan_t *p, int i, int status, int it, double acc);
+int plan_refine(plan_t *p);
+void plan_free(plan_t *p);
+
+#endif /* RAD_PLAN_H_ */
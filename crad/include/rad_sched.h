@@ -0,0 +1,84 @@
+/** @file rad_sched.h
+ * @brief Parameter sweep scheduler.
+ * @details The points of parameter sweeps (see rad_plan.h) are solved as
+ * independent jobs on a number of concurrent lanes. Every lane owns a setup,
+ * whose worker thread budget is an equal share of the available processors. A
+ * lane takes the pending job of the greatest expected cost, solves it and
+ * hands a copy of the solution over to the calling thread. The calling thread
+ * appends the copy to the job's sweep store (see rad_sweep.h), while the lane
+ * solves its next job.
+ *
+ * The expected cost of a job is the iteration count of the nearest point of a
+ * previous sweep in the job's store, or else of the nearest point of the same
+ * sweep that is solved in the current run. Jobs without an estimate are taken
+ * first and in their order, so that estimates become available early.
+ *
+ * In the continuation modes, a job is warm started from the converged
+ * solution of the nearest solved job of the same sweep (SCHED_NEAREST), or
+ * from a linear extrapolation of the two nearest ones if the three points are
+ * on a line (SCHED_EXTRAPOLATE, see setup_continue()). Since the jobs without
+ * an estimate are taken in their order, an ordered sweep grid is solved as a
+ * chain on a single lane.
+ *
+ * Points that differ only in the scalar parameters of the model can be solved
+ * in batches: every lane thread then advances the setups of several lanes in
+ * lockstep (see setup_batch()), so that the loops of an iteration are shared
+ * by the points. The lanes of a batch take their jobs and hand their
+ * solutions over independently, and a lane whose solve ends takes the next
+ * pending job while the others continue.
+ *
+ * A sweep can be split into shards that are solved by independent processes,
+ * e.g. the tasks of a batch scheduler's job array. Every shard assigns the
+ * jobs to the shards by their expected costs from the stores in the same way
+ * (see sched_shard()), and solves its own share. */
+
+#ifndef RAD_SCHED_H_
+#define RAD_SCHED_H_
+
+#include "rad_plan.h"
+#include "rad_sweep.h"
+#include "rad_types.h"
+
+#include "stdbool.h"
+
+/** The job is pending */
+#define SCHED_PENDING 0
+/** The job is solved by a lane */
+#define SCHED_RUNNING 1
+/** The job is solved */
+#define SCHED_DONE 2
+
+/** Every job starts cold */
+#define SCHED_COLD 0
+/** Jobs continue from the nearest solved job */
+#define SCHED_NEAREST 1
+/** Jobs continue from an extrapolation of the two nearest solved jobs */
+#define SCHED_EXTRAPOLATE 2
+
+/** @brief Job structure
+ * @details Describes a sweep point */
+struct sched_job_st {
+  /** @brief Sweep plan of the point */
+  plan_t *plan;
+  /** @brief Point index */
+  int point;
+  /** @brief Sweep store of the solution */
+  sweep_t *store;
+  /** @brief Expected cost (negative if unknown, see sched_run()) */
+  double cost;
+  /** @brief Job state (e.g. SCHED_PENDING) */
+  int state;
+  /** @brief Iteration count of the solve */
+  int it;
+  /** @brief The solve continues from the last periodic save of the point */
+  bool resume;
+};
+/** @brief Job type */
+typedef struct sched_job_st sched_job_t;
+
+int sched_shard(sched_job_t *jobs, int n, int shard, int shards);
+int sched_run(sched_job_t *jobs, int n, int lanes, int batch, int cont,
+              int policies, const char *parameter_filename,
+              const objpart_t *objparts);
+
+#endif /* RAD_SCHED_H_ */
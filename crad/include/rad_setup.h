@@ -5,10 +5,29 @@
 #define RAD_SETUP_H_
 
 struct objpart_st;
+struct pmap_st;
 struct model_st;
 struct sol_st;
 
 struct concurrency_st;
+struct rad_ctx_st;
+struct sweep_st;
+
+/** Return value of setup_solve() and setup_resume() if the solve is halted
+ * before convergence */
+#define SETUP_HALTED 1
+/** Exit status of the applications if the solve is halted before convergence
+ * (EX_TEMPFAIL of sysexits.h, the job can be resumed with rad_mcont) */
+#define SETUP_EXIT_HALTED 75
+
+/** Return value of the next callback of setup_batch() that retires the lane */
+#define SETUP_BATCH_RETIRE 0
+/** Return value of the next callback of setup_batch() that solves the lane's
+ * setup from the start (see setup_solve()) */
+#define SETUP_BATCH_SOLVE 1
+/** Return value of the next callback of setup_batch() that resumes the lane's
+ * setup (see setup_resume()) */
+#define SETUP_BATCH_RESUME 2
 
 /** Setup structure
  * @brief Execution consolidating structure
@@ -21,19 +40,40 @@ struct setup_st {
 
   /** @brief Concurrency data */
   struct concurrency_st *c;
+  /** @brief Execution context (NULL uses the default context) */
+  const struct rad_ctx_st *x;
 };
 /** @brief Setup type */
 typedef struct setup_st setup_t;
 
+/** @brief Batch callback that prepares the next solve of a lane
+ * @details Returns SETUP_BATCH_SOLVE, SETUP_BATCH_RESUME or
+ * SETUP_BATCH_RETIRE (see setup_batch()) */
+typedef int (*setup_next_t)(void *arg, int lane);
+/** @brief Batch callback that receives the return value of a lane's solve
+ * (see setup_solve()) */
+typedef void (*setup_done_t)(void *arg, int lane, int ec);
+
 int setup_init(setup_t *u, const char *parameter_filename,
                const struct objpart_st *obhparts);
+int setup_reset(setup_t *u, const struct pmap_st *pmap,
+                const struct objpart_st *obhparts);
 int setup_solve(setup_t *u);
 int setup_resume(setup_t *u);
-void setup_load(setup_t *u, const char *setup_path,
-                const struct objpart_st *obhparts);
-void setup_save(const setup_t *u, const char *setup_path);
+int setup_batch(setup_t *const *us, int n, setup_next_t next,
+                setup_done_t done, void *arg);
+int setup_load(setup_t *u, const char *setup_path,
+               const struct objpart_st *obhparts);
+int setup_save(const setup_t *u, const char *setup_path);
+int setup_sweep(const setup_t *u, struct sweep_st *w, double value);
+int setup_warm(setup_t *u, const char *setup_path, int policies);
+int setup_continue(setup_t *u, const struct sol_st *a,
+                   const struct sol_st *b, double t, int policies);
+int setup_rank(const setup_t *u);
 void setup_free(setup_t *u);
 
 int setup_find_last_saved(char *save_point);
+int setup_clear_saved(void);
+void setup_catch_signals(void);
 
 #endif /* RAD_SETUP_H_ */
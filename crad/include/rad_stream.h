@@ -0,0 +1,121 @@
+/** @file rad_stream.h
+ * @brief Live solution stream.
+ * @details A running solve can publish its state into a named shared memory
+ * segment every few iterations (see the `stream` and `streamcycle` parameters
+ * of setup_init()), so that monitoring tools watch it converge without file
+ * I/O. Readers attach to the segment with stream_attach() and take consistent
+ * frames with stream_read() (see also the LiveStream class of prad/rad.py).
+ *
+ * The segment is guarded by a sequence lock: the writer increments the
+ * sequence number before and after it updates the segment, so that it is odd
+ * while an update is in progress. A reader copies the segment and retries if
+ * the sequence number was odd or changed during the copy. Thus, the writer
+ * never waits for readers and readers never see partial updates.
+ *
+ * Integers and doubles are stored in the byte order of the host. The segment
+ * consists of
+ *  - a header of STREAM_HEAD_SZ bytes with the magic string `RADLIVE`, the
+ * format version (u32 at 8), the wealth and radius grid sizes (i32 at 12 and
+ * 16) and the sequence number (u64 at 24), followed by the iteration count
+ * (i32 at 32), the solve state (i32 at 36), the accuracy (f64 at 40), the
+ * tolerance (f64 at 48), the quantity and effort grid bounds (f64 at 56 and
+ * 64) and the wall-clock time of the solve's setup in seconds (f64 at 72),
+ *  - the wealth and radius grids and
+ *  - the value function (`v1`), quantity policy and effort policy in row-major
+ * order with the wealth as first dimension.
+ *
+ * Every array starts at a multiple of 64 bytes. The segment of a finished
+ * setup is marked closed before it is removed, so that readers detach. */
+
+#ifndef RAD_STREAM_H_
+#define RAD_STREAM_H_
+
+#include "rad_conf.h"
+#include "rad_types.h"
+
+#include "stdbool.h"
+#include "stddef.h"
+#include "stdint.h"
+
+/** Format version */
+#define STREAM_VERSION 1
+/** Header size in bytes */
+#define STREAM_HEAD_SZ 128
+/** The solve is iterating */
+#define STREAM_SOLVING 0
+/** The solve is converged */
+#define STREAM_CONVERGED 1
+/** The solve is halted before convergence */
+#define STREAM_HALTED 2
+/** The segment is closed */
+#define STREAM_CLOSED 3
+
+/** @brief Stream structure
+ * @details Describes a mapped segment of a writer or a reader */
+struct stream_st {
+  /** @brief Segment name */
+  char name[RAD_PATH_BUFFER_SZ];
+  /** @brief Mapped segment (NULL if not mapped) */
+  uint8_t *seg;
+  /** @brief Segment size in bytes */
+  size_t size;
+  /** @brief Wealth grid size */
+  int xn;
+  /** @brief Radius grid size */
+  int rn;
+  /** @brief The stream is the segment's writer */
+  bool owner;
+};
+/** @brief Stream type */
+typedef struct stream_st stream_t;
+
+/** @brief Frame structure
+ * @details A consistent copy of a stream's segment taken by stream_read(). The
+ * arrays point into the frame's buffer. */
+struct stream_frame_st {
+  /** @brief Sequence number of the copy */
+  uint64_t seq;
+  /** @brief Iteration count */
+  int it;
+  /** @brief Solve state (e.g. STREAM_SOLVING) */
+  int state;
+  /** @brief Achieved accuracy */
+  double acc;
+  /** @brief Numerical error tolerance */
+  double tol;
+  /** @brief Quantity grid bound */
+  double qM;
+  /** @brief Effort grid bound */
+  double sM;
+  /** @brief Wall-clock time in seconds */
+  double time;
+  /** @brief Wealth grid size */
+  int xn;
+  /** @brief Radius grid size */
+  int rn;
+  /** @brief Wealth grid */
+  const double *xg;
+  /** @brief Radius grid */
+  const double *rg;
+  /** @brief Value function */
+  const double *v1;
+  /** @brief Quantity policy */
+  const double *qpol;
+  /** @brief Effort policy */
+  const double *spol;
+  /** @brief Copy buffer of the segment */
+  uint8_t *buf;
+  /** @brief Copy buffer size in bytes */
+  size_t bufsz;
+};
+/** @brief Frame type */
+typedef struct stream_frame_st stream_frame_t;
+
+int stream_init(stream_t *t, const char *name, int xn, int rn);
+void stream_publish(stream_t *t, const sol_t *s, int state, double time);
+int stream_attach(stream_t *t, const char *name);
+int stream_read(const stream_t *t, stream_frame_t *f);
+void stream_frame_free(stream_frame_t *f);
+void stream_free(stream_t *t);
+
+#endif /* RAD_STREAM_H_ */
@@ -0,0 +1,105 @@
+/** @file rad_sweep.h
+ * @brief Parameter sweep store.
+ * @details The solutions of a parameter sweep (see rad_pardep) are appended to
+ * a single file with the `.sweep` extension. The file holds an index of the
+ * solved parameter values and, for every stored variable, one contiguous
+ * array of dimensions [point x wealth x radius], so that a whole sweep is read
+ * with a single memory map (see the SweepStore class of prad/rad.py). Only a
+ * subset of the wealth and radius indices can be stored.
+ *
+ * All integers and doubles are little-endian. The file consists of
+ *  - two header slots of SWEEP_SLOT_SZ bytes, each one with the magic string
+ * `RADSWEEP`, the format version (u32 at 8), the number of variables (u32 at
+ * 12), the slot's generation (u64 at 16), the point capacity (u64 at 24), the
+ * number of points (u64 at 32), the stored and the full wealth and radius
+ * grid sizes (u32 at 40, 44, 48 and 52) and the CRC-32 checksum of the
+ * previous bytes (u32 at 56),
+ *  - the parameter name and the variable names (`v0`, `qpol` and `spol`) in
+ * fields of SWEEP_NAME_SZ bytes,
+ *  - the stored wealth indices (u32), their grid values (f64), the stored
+ * radius indices (u32) and their grid values (f64),
+ *  - a point table with one entry of SWEEP_ENTRY_SZ bytes per point that
+ * holds the parameter value (f64 at 0), the achieved accuracy (f64 at 8), the
+ * iteration count (i32 at 16) and the CRC-32 checksum of the point's variable
+ * data (u32 at 20) and
+ *  - the variable arrays for the point capacity.
+ *
+ * Every array starts at a multiple of SWEEP_ALIGN bytes. A point is appended
+ * by writing its data after the last point and synchronizing the file, and it
+ * is committed by writing the next generation of the header to the older slot.
+ * Readers use the valid slot of the greatest generation. Thus, a store that is
+ * interrupted during an append holds the previously committed points. If the
+ * capacity is exhausted, the store is rewritten with twice its capacity in a
+ * hidden file that replaces it when it is complete. */
+
+#ifndef RAD_SWEEP_H_
+#define RAD_SWEEP_H_
+
+#include "rad_conf.h"
+#include "rad_types.h"
+
+#include "stdint.h"
+#include "stdio.h"
+
+/** Format version */
+#define SWEEP_VERSION 1
+/** File extension */
+#define RAD_SWEEP_EXT ".sweep"
+/** Array alignment in bytes */
+#define SWEEP_ALIGN 64
+/** Header slot size in bytes */
+#define SWEEP_SLOT_SZ 64
+/** Name field size in bytes (including the terminating zero) */
+#define SWEEP_NAME_SZ 16
+/** Point table entry size in bytes */
+#define SWEEP_ENTRY_SZ 32
+/** Number of stored variables */
+#define SWEEP_NVARS 3
+
+/** @brief Sweep store structure
+ * @details Describes the writer of a sweep store. */
+struct sweep_st {
+  /** @brief Parameter name */
+  char param[SWEEP_NAME_SZ];
+  /** @brief Store path relative to the output directory, without extension */
+  char path[RAD_PATH_BUFFER_SZ];
+  /** @brief Stored wealth indices (NULL for all the indices) */
+  int *xi;
+  /** @brief Stored radius indices (NULL for all the indices) */
+  int *ri;
+  /** @brief Number of stored wealth indices */
+  int xn;
+  /** @brief Number of stored radius indices */
+  int rn;
+  /** @brief Wealth grid size */
+  int xN;
+  /** @brief Radius grid size */
+  int rN;
+  /** @brief Stored wealth grid values */
+  double *xv;
+  /** @brief Stored radius grid values */
+  double *rv;
+  /** @brief Point capacity */
+  uint64_t cap;
+  /** @brief Number of committed points */
+  uint64_t count;
+  /** @brief Header generation */
+  uint64_t gen;
+  /** @brief Open store file (NULL before the first append) */
+  FILE *fh;
+};
+/** @brief Sweep store type */
+typedef struct sweep_st sweep_t;
+
+int sweep_init(sweep_t *w, const char *param, const char *path, int cap,
+               const char *xsub, const char *rsub);
+int sweep_open(sweep_t *w);
+int sweep_append(sweep_t *w, const sol_t *s, double value);
+int sweep_copy(sweep_t *w, const char *path, double value, int *it,
+               double *acc);
+int sweep_index(const char *path, double **values, int **its);
+int sweep_read(const char *path, const char *var, double **values,
+               double **data, int *ls);
+void sweep_free(sweep_t *w);
+
+#endif /* RAD_SWEEP_H_ */
@@ -0,0 +1,75 @@
+/** @file rad_threads.h
+ * @brief Thread backend interface.
+ * @details Wraps the threads, mutexes and condition variables used by the
+ * solver's pipeline behind a common interface. The implementation is selected
+ * at configure time (see RAD_THREAD_BACKEND) among the C11 threads, the POSIX
+ * threads and the OpenMP backends. Backends that cannot create single threads
+ * (i.e. OpenMP) define RAD_THREADS_FORK_JOIN and launch the threads of a solve
+ * as a team using rad_thrd_team(). */
+
+#ifndef RAD_THREADS_H_
+#define RAD_THREADS_H_
+
+#include "rad_conf.h"
+
+#if defined(RAD_THREADS_C11)
+#include "threads.h"
+
+typedef thrd_t rad_thrd_t;
+typedef mtx_t rad_mtx_t;
+typedef cnd_t rad_cnd_t;
+
+#elif defined(RAD_THREADS_POSIX)
+#include "pthread.h"
+
+typedef pthread_t rad_thrd_t;
+typedef pthread_mutex_t rad_mtx_t;
+typedef pthread_cond_t rad_cnd_t;
+
+#elif defined(RAD_THREADS_OPENMP)
+#include "omp.h"
+#include "stdatomic.h"
+
+/** Threads are members of a team */
+#define RAD_THREADS_FORK_JOIN 1
+
+typedef int rad_thrd_t;
+typedef omp_lock_t rad_mtx_t;
+/** @brief Condition variable
+ * @details OpenMP has no condition variables. Waiters yield until the
+ * generation count changes. */
+typedef struct {
+  /** @brief Generation count */
+  atomic_uint gen;
+} rad_cnd_t;
+
+#else
+typedef int rad_thrd_t;
+typedef int rad_mtx_t;
+typedef int rad_cnd_t;
+#endif /* RAD_THREADS_C11, RAD_THREADS_POSIX, RAD_THREADS_OPENMP */
+
+/** @brief Thread start function */
+typedef int (*rad_thrd_start_t)(void *);
+
+int rad_thrd_create(rad_thrd_t *thr, rad_thrd_start_t func, void *arg);
+int rad_thrd_join(rad_thrd_t thr);
+#ifdef RAD_THREADS_FORK_JOIN
+int rad_thrd_team(int n, rad_thrd_start_t worker, rad_thrd_start_t master,
+                  void **args);
+#endif /* RAD_THREADS_FORK_JOIN */
+
+int rad_mtx_init(rad_mtx_t *mtx);
+void rad_mtx_destroy(rad_mtx_t *mtx);
+int rad_mtx_lock(rad_mtx_t *mtx);
+int rad_mtx_unlock(rad_mtx_t *mtx);
+
+int rad_cnd_init(rad_cnd_t *cnd);
+void rad_cnd_destroy(rad_cnd_t *cnd);
+int rad_cnd_wait(rad_cnd_t *cnd, rad_mtx_t *mtx);
+int rad_cnd_signal(rad_cnd_t *cnd);
+int rad_cnd_broadcast(rad_cnd_t *cnd);
+
+double rad_wall_time();
+
+#endif /* RAD_THREADS_H_ */
@@ -9,6 +9,8 @@
 #ifndef RAD_TYPES_H_
 #define RAD_TYPES_H_
 
+#include "stddef.h"
+
 struct grid_st;
 struct model_st;
 struct pmap_st;
@@ -87,8 +89,6 @@ typedef struct model_st model_t;
 
 void model_init(model_t *m, const struct pmap_st *pmap,
                 const objpart_t *objparts);
-void model_load(model_t *m, const char *model_path, const objpart_t *objparts);
-void model_save(const model_t *m, const char *model_path);
 
 /** @brief Solution structure
  * @details Contains solution information. This involves discretized domain data
@@ -119,8 +119,20 @@ struct sol_st {
   double **qpol;
   /** @brief Effort policy */
   double **spol;
+  /** @brief Memory arena of the approximation variables
+   * @details Holds the row pointers and the data of v0, v1, qpol and spol in a
+   * single allocation. The rows of each variable are contiguous and each
+   * variable starts on a cache line boundary. */
+  void *mem;
+  /** @brief Mapped save file
+   * @details If not NULL, the rows of v0, v1, qpol and spol point into a
+   * private, copy-on-write mapping of a loaded save file (see rad_file_load())
+   * instead of the memory arena. */
+  void *map;
+  /** @brief Size of the mapped save file in bytes */
+  size_t map_sz;
 
-  /** @brief Maximum number of iterations */
+  /** @brief Maximum number of iterations (non-positive values do not limit) */
   int maxit;
   /** @brief Numerical error tolerance */
   double tol;
@@ -138,8 +150,8 @@ struct sol_st {
 typedef struct sol_st sol_t;
 
 void solution_init(sol_t *s, const struct pmap_st *pmap);
-void solution_load(sol_t *s, const char *model_path);
-void solution_save(const sol_t *s, const char *model_path);
+void solution_reset(sol_t *s, const struct pmap_st *pmap);
+void solution_copy(sol_t *dest, const sol_t *source);
 void solution_free(sol_t *s);
 
 #endif /* RAD_TYPES_H_ */
@@ -1,7 +1,16 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif /* __linux__ */
+
 #include "cross_comp.h"
 
 #if defined(__unix__) || defined(__APPLE__)
 
+#if defined(__linux__)
+#include "sched.h"
+#endif /* __linux__ */
+#include "fcntl.h"
+#include "sys/mman.h"
 #include "sys/stat.h"
 #include "sys/types.h"
 #include "unistd.h"
@@ -10,11 +19,14 @@
 
 #include "Shlobj.h"
 #include "Shlobj_core.h"
+#include "io.h"
 
 #endif /* __unix__ || __APPLE__ */
 
 #include "limits.h"
+#include "math.h"
 #include "stdio.h"
+#include "stdlib.h"
 #include "string.h"
 
 #if defined(__unix__) || defined(__APPLE__)
@@ -42,6 +54,209 @@ int mkdirp(const char *path, int mode) {
   return mkdir(buffer, mode);
 }
 
+/** @brief Replacing rename
+ * @details Renames a file, replacing the destination file if it exists.
+ * @param from Existing file name
+ * @param to New file name
+ * @return Zero if success, an error status code otherwise. */
+int rename_replace(const char *from, const char *to) {
+  return rename(from, to);
+}
+
+/** @brief Map file
+ * @details Maps a whole file into memory for reading and writing. The mapping
+ * is private; written pages are copied on write and never reach the file.
+ * @param filename File name
+ * @param size Output file size in bytes
+ * @return The mapping's address on success, NULL otherwise */
+void *map_file(const char *filename, size_t *size) {
+  struct stat st;
+  void *addr;
+  int fd = open(filename, O_RDONLY);
+
+  if (fd < 0) {
+    return NULL;
+  }
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+    close(fd);
+    return NULL;
+  }
+  *size = (size_t)st.st_size;
+  addr = mmap(NULL, *size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  // The mapping holds its own reference to the file
+  close(fd);
+  return addr == MAP_FAILED ? NULL : addr;
+}
+
+/** @brief Unmap file
+ * @details Releases a mapping created by map_file(), shm_create() or
+ * shm_attach().
+ * @param addr Mapping address
+ * @param size File size in bytes */
+void unmap_file(void *addr, size_t size) { munmap(addr, size); }
+
+/** @brief Create shared memory
+ * @details Creates a named shared memory object of the passed size, replacing
+ * an existing one, and maps it for reading and writing. The object persists
+ * until it is removed by shm_remove().
+ * @param name Object name starting with a slash
+ * @param size Size in bytes
+ * @return The mapping's address on success, NULL otherwise */
+void *shm_create(const char *name, size_t size) {
+  void *addr;
+
+  shm_unlink(name);
+  int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (fd < 0) {
+    return NULL;
+  }
+  if (ftruncate(fd, (off_t)size) != 0) {
+    close(fd);
+    shm_unlink(name);
+    return NULL;
+  }
+  addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    shm_unlink(name);
+    return NULL;
+  }
+  return addr;
+}
+
+/** @brief Attach shared memory
+ * @details Maps an existing named shared memory object for reading.
+ * @param name Object name starting with a slash
+ * @param size Output size in bytes
+ * @return The mapping's address on success, NULL otherwise */
+void *shm_attach(const char *name, size_t *size) {
+  struct stat st;
+  void *addr;
+  int fd = shm_open(name, O_RDONLY, 0);
+
+  if (fd < 0) {
+    return NULL;
+  }
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+    close(fd);
+    return NULL;
+  }
+  *size = (size_t)st.st_size;
+  addr = mmap(NULL, *size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  return addr == MAP_FAILED ? NULL : addr;
+}
+
+/** @brief Remove shared memory
+ * @details Removes the name of a shared memory object. Existing mappings stay
+ * valid.
+ * @param name Object name starting with a slash */
+void shm_remove(const char *name) { shm_unlink(name); }
+
+/** @brief Seek file
+ * @details Sets the position of a file stream to a 64-bit offset.
+ * @param fh File stream
+ * @param offset Offset in bytes from the beginning of the file
+ * @return Zero on success, non-zero otherwise */
+int seek_file(FILE *fh, unsigned long long offset) {
+  return fseeko(fh, (off_t)offset, SEEK_SET);
+}
+
+/** @brief Synchronize file
+ * @details Flushes a file stream and waits until its data reach the storage
+ * device.
+ * @param fh File stream
+ * @return Zero on success, non-zero otherwise */
+int sync_file(FILE *fh) { return fflush(fh) != 0 || fsync(fileno(fh)) != 0; }
+
+#if defined(__linux__)
+static int cgroup_cpu_quota() {
+  FILE *fh;
+  char max[32];
+  double quota = 0, period = 0;
+
+  // cgroup v2
+  if ((fh = fopen("/sys/fs/cgroup/cpu.max", "r")) != NULL) {
+    int rc = fscanf(fh, "%31s %lf", max, &period);
+    fclose(fh);
+    if (rc == 2 && strcmp(max, "max") && period > 0) {
+      return (int)ceil(atof(max) / period);
+    }
+    return 0;
+  }
+
+  // cgroup v1
+  if ((fh = fopen("/sys/fs/cgroup/cpu/cpu.cfs_quota_us", "r")) != NULL) {
+    if (fscanf(fh, "%lf", &quota) != 1) {
+      quota = 0;
+    }
+    fclose(fh);
+  }
+  if ((fh = fopen("/sys/fs/cgroup/cpu/cpu.cfs_period_us", "r")) != NULL) {
+    if (fscanf(fh, "%lf", &period) != 1) {
+      period = 0;
+    }
+    fclose(fh);
+  }
+  if (quota > 0 && period > 0) {
+    return (int)ceil(quota / period);
+  }
+  return 0;
+}
+#endif /* __linux__ */
+
+/** @brief Available processors
+ * @details Lists the processors that the calling process may run on. On Linux,
+ * the list is taken from the process' affinity mask (e.g. a cpuset assigned by
+ * a batch scheduler) and it is truncated to the processor quota of the
+ * process' cgroup. On other systems, it lists the online processors.
+ * @param cpus Output array of processor identifiers (can be NULL)
+ * @param n Size of the output array
+ * @return The number of available processors */
+int cpus_available(int *cpus, int n) {
+  int count = 0;
+#if defined(__linux__)
+  cpu_set_t set;
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+    for (int i = 0; i < CPU_SETSIZE; ++i) {
+      if (CPU_ISSET(i, &set)) {
+        if (cpus && count < n) {
+          cpus[count] = i;
+        }
+        ++count;
+      }
+    }
+  }
+  int quota = cgroup_cpu_quota();
+  if (quota > 0 && quota < count) {
+    count = quota;
+  }
+#endif /* __linux__ */
+  if (count == 0) {
+    count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    for (int i = 0; cpus && i < count && i < n; ++i) {
+      cpus[i] = i;
+    }
+  }
+  return count > 0 ? count : 1;
+}
+
+/** @brief Pin thread
+ * @details Restricts the calling thread to run on the passed processor.
+ * Pinning is only supported on Linux.
+ * @param cpu Processor identifier
+ * @return Zero on success, non-zero otherwise */
+int pin_thread(int cpu) {
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return sched_setaffinity(0, sizeof(set), &set);
+#else
+  return -1;
+#endif /* __linux__ */
+}
+
 #else
 
 /** @brief Make multiple directories
@@ -51,4 +266,142 @@ int mkdirp(const char *path, int mode) {
  * @return Zero if success, an error status code otherwise. */
 int mkdirp_w(const char *path) { return SHCreateDirectoryEx(NULL, path, NULL); }
 
+/** @brief Replacing rename
+ * @details Renames a file, replacing the destination file if it exists.
+ * @param from Existing file name
+ * @param to New file name
+ * @return Zero if success, an error status code otherwise. */
+int rename_replace(const char *from, const char *to) {
+  return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING) ? 0 : -1;
+}
+
+/** @brief Map file
+ * @details Maps a whole file into memory for reading and writing. The mapping
+ * is private; written pages are copied on write and never reach the file.
+ * @param filename File name
+ * @param size Output file size in bytes
+ * @return The mapping's address on success, NULL otherwise */
+void *map_file(const char *filename, size_t *size) {
+  LARGE_INTEGER sz;
+  HANDLE fh, mh;
+  void *addr = NULL;
+
+  fh = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                   NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (fh == INVALID_HANDLE_VALUE) {
+    return NULL;
+  }
+  if (GetFileSizeEx(fh, &sz) && sz.QuadPart > 0 &&
+      (mh = CreateFileMappingA(fh, NULL, PAGE_WRITECOPY, 0, 0, NULL)) != NULL) {
+    *size = (size_t)sz.QuadPart;
+    addr = MapViewOfFile(mh, FILE_MAP_COPY, 0, 0, 0);
+    // The view holds its own reference to the mapping
+    CloseHandle(mh);
+  }
+  CloseHandle(fh);
+  return addr;
+}
+
+/** @brief Unmap file
+ * @details Releases a mapping created by map_file(), shm_create() or
+ * shm_attach().
+ * @param addr Mapping address
+ * @param size File size in bytes */
+void unmap_file(void *addr, size_t size) {
+  (void)size;
+  UnmapViewOfFile(addr);
+}
+
+/** @brief Create shared memory
+ * @details Creates a named, paging file backed mapping object of the passed
+ * size and maps it for reading and writing. The object persists while it is
+ * mapped.
+ * @param name Object name starting with a slash
+ * @param size Size in bytes
+ * @return The mapping's address on success, NULL otherwise */
+void *shm_create(const char *name, size_t size) {
+  char buf[MAX_PATH];
+  void *addr = NULL;
+  HANDLE mh;
+
+  snprintf(buf, sizeof(buf), "Local\\%s", name + 1);
+  mh = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                          (DWORD)((unsigned long long)size >> 32),
+                          (DWORD)(size & 0xFFFFFFFF), buf);
+  if (mh != NULL) {
+    addr = MapViewOfFile(mh, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    // The view holds its own reference to the mapping
+    CloseHandle(mh);
+  }
+  return addr;
+}
+
+/** @brief Attach shared memory
+ * @details Maps an existing named mapping object for reading.
+ * @param name Object name starting with a slash
+ * @param size Output size in bytes
+ * @return The mapping's address on success, NULL otherwise */
+void *shm_attach(const char *name, size_t *size) {
+  char buf[MAX_PATH];
+  MEMORY_BASIC_INFORMATION info;
+  void *addr = NULL;
+  HANDLE mh;
+
+  snprintf(buf, sizeof(buf), "Local\\%s", name + 1);
+  if ((mh = OpenFileMappingA(FILE_MAP_READ, FALSE, buf)) != NULL) {
+    addr = MapViewOfFile(mh, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mh);
+  }
+  if (addr && VirtualQuery(addr, &info, sizeof(info)) == sizeof(info)) {
+    *size = info.RegionSize;
+  }
+  return addr;
+}
+
+/** @brief Remove shared memory
+ * @details Mapping objects are removed with their last mapping.
+ * @param name Object name starting with a slash */
+void shm_remove(const char *name) { (void)name; }
+
+/** @brief Available processors
+ * @details Lists the processors of the system.
+ * @param cpus Output array of processor identifiers (can be NULL)
+ * @param n Size of the output array
+ * @return The number of available processors */
+int cpus_available(int *cpus, int n) {
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  int count = (int)info.dwNumberOfProcessors;
+  for (int i = 0; cpus && i < count && i < n; ++i) {
+    cpus[i] = i;
+  }
+  return count > 0 ? count : 1;
+}
+
+/** @brief Pin thread
+ * @details Restricts the calling thread to run on the passed processor.
+ * @param cpu Processor identifier
+ * @return Zero on success, non-zero otherwise */
+int pin_thread(int cpu) {
+  return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) == 0;
+}
+
+/** @brief Seek file
+ * @details Sets the position of a file stream to a 64-bit offset.
+ * @param fh File stream
+ * @param offset Offset in bytes from the beginning of the file
+ * @return Zero on success, non-zero otherwise */
+int seek_file(FILE *fh, unsigned long long offset) {
+  return _fseeki64(fh, (__int64)offset, SEEK_SET);
+}
+
+/** @brief Synchronize file
+ * @details Flushes a file stream and waits until its data reach the storage
+ * device.
+ * @param fh File stream
+ * @return Zero on success, non-zero otherwise */
+int sync_file(FILE *fh) {
+  return fflush(fh) != 0 || _commit(_fileno(fh)) != 0;
+}
+
 #endif /* __unix__ || __APPLE__ */
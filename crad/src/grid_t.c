@@ -75,38 +75,64 @@ void grid_init(grid_t *g, short n, double m, double M, double w) {
   grid_calc(g);
 }
 
-/** @brief Grid initialization from string
- * @details Parses the string using GRID_T_INIT_STR_MASK and calls
- * init_grid() using the parsed data.
+/** Parse initialization string
+ * @details Sets the grid parameters parsed using GRID_T_INIT_STR_MASK.
  * @param g Output grid object
  * @param init_str Initialization string */
-void grid_init_str(grid_t *g, const char *init_str) {
+static void parse_init_str(grid_t *g, const char *init_str) {
   size_t len = strlen(init_str);
-  char *buf = (char *)calloc(len, sizeof(char));
+  char *buf = (char *)calloc(len + 1, sizeof(char));
   memcpy(buf, init_str, len);
-  char *pbuf;
+  char *pbuf, *save = NULL;
 
-  pbuf = strtok(buf, ",");
+  pbuf = strtok_r(buf, ",", &save);
   if (pbuf)
     g->n = (short)atoi(pbuf);
-  pbuf = strtok(NULL, ",");
+  pbuf = strtok_r(NULL, ",", &save);
   if (pbuf)
     g->m = atof(pbuf);
-  pbuf = strtok(NULL, ",");
+  pbuf = strtok_r(NULL, ",", &save);
   if (pbuf)
     g->M = atof(pbuf);
-  pbuf = strtok(NULL, ",");
+  pbuf = strtok_r(NULL, ",", &save);
   if (pbuf)
     g->w = atof(pbuf);
   else
     g->w = 1;
 
   free(buf);
+}
 
+/** @brief Grid initialization from string
+ * @details Parses the string using GRID_T_INIT_STR_MASK and calls
+ * init_grid() using the parsed data.
+ * @param g Output grid object
+ * @param init_str Initialization string */
+void grid_init_str(grid_t *g, const char *init_str) {
+  parse_init_str(g, init_str);
   alloc_grid(g);
   grid_calc(g);
 }
 
+/** @brief Grid re-initialization from string
+ * @details Re-initializes an already initialized grid from the passed
+ * initialization string. The data array is reused if the number of grid points
+ * does not change. Otherwise, it is re-allocated.
+ * @param g Initialized grid object
+ * @param init_str Initialization string
+ * @return Zero if the data array is reused, non-zero if it is re-allocated. */
+int grid_reset_str(grid_t *g, const char *init_str) {
+  short n = g->n;
+  parse_init_str(g, init_str);
+  if (n != g->n) {
+    grid_free(g);
+    alloc_grid(g);
+  }
+  grid_calc(g);
+
+  return n != g->n;
+}
+
 /** @brief Grid copy
  * @details Performs a deep copy of one grid to another.
  * @param dest Destination grid
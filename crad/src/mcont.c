@@ -30,9 +30,19 @@ int main(void) {
     return EXIT_FAILURE;
   }
   LOGI("Resuming numerical solver from save point %s", save_point);
-  setup_load(&u, save_point, objparts);
+  if ((rc = setup_load(&u, save_point, objparts)) != 0) {
+    LOGE("Failed to load save point %s with code %d", save_point, rc);
+    return EXIT_FAILURE;
+  }
+
+  setup_catch_signals();
 
-  if ((rc = setup_resume(&u)) != 0) {
+  if ((rc = setup_resume(&u)) == SETUP_HALTED) {
+    LOGW("Numerical solver halted (%d iter)", s.it);
+    setup_free(&u);
+    return SETUP_EXIT_HALTED;
+  }
+  if (rc != 0) {
     LOGE("Numerical solver failed with code %d", rc);
     setup_free(&u);
     return EXIT_FAILURE;
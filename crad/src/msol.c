@@ -27,9 +27,16 @@ int main(void) {
     return EXIT_FAILURE;
   }
 
+  setup_catch_signals();
+
   LOGI("Initializing numerical solver");
   s.xbeg = clock();
-  if ((rc = setup_solve(&u)) != 0) {
+  if ((rc = setup_solve(&u)) == SETUP_HALTED) {
+    LOGW("Numerical solver halted (%d iter)", s.it);
+    setup_free(&u);
+    return SETUP_EXIT_HALTED;
+  }
+  if (rc != 0) {
     LOGE("Numerical solver failed with code %d", rc);
     setup_free(&u);
     return EXIT_FAILURE;
@@ -1,68 +1,406 @@
-#include "rad_conf.h"
-#include "rad_setup.h"
-#include "rad_specs.h"
-#include "rad_types.h"
+#include "rad_conf.h"
+#include "rad_ctx.h"
+#include "rad_plan.h"
+#include "rad_sched.h"
+#include "rad_setup.h"
+#include "rad_specs.h"
+#include "rad_sweep.h"
+#include "rad_types.h"
 
+#include "stdbool.h"
 #include "stdio.h"
 #include "stdlib.h"
-#include "time.h"
+#include "string.h"
 
-#include "grid_t.h"
-#include "pmap_t.h"
+#include "pmap_t.h"
 
 #define LM_LEVEL 3
-#include "cross_comp.h"
-#include "logger.h"
-
-int main(void) {
-  int rc;
-  double dur;
-  const objpart_t objparts[4] = {{util, CCM_STRINGIFY(_util_)},
-                                 {cost, CCM_STRINGIFY(_cost_)},
-                                 {radt, CCM_STRINGIFY(_radt_)},
-                                 {wltt, CCM_STRINGIFY(_wltt_)}};
-  model_t m;
-  sol_t s;
-  setup_t u = {.m = &m, .s = &s};
-  char path_buf[RAD_PATH_BUFFER_SZ];
-  pmap_t pmap;
-  grid_t deltag, alphag, gammag;
-
-  snprintf(path_buf, RAD_PATH_BUFFER_SZ, "%s" CCM_FILE_SYSTEM_SEP "pardep.prm",
-           RAD_DATA_DIR);
-  pmap_init(&pmap, path_buf);
-
-#define mdepparam(p)                                                           \
-  /* Dependence on p */                                                        \
-  grid_init_str(&p##g, pmap_find(&pmap, #p "g"));                              \
-  for (int it = 0; it < p##g.n; ++it) {                                        \
-    if (setup_init(&u, "pardep.prm", objparts)) {                              \
-      return EXIT_FAILURE;                                                     \
-    }                                                                          \
-    m.p = p##g.d[it];                                                          \
-    LOGI("Solving model for " #p " = %f (%d/%d)...", m.p, it + 1, p##g.n);     \
-    s.xbeg = clock();                                                          \
-    if ((rc = setup_solve(&u)) != 0) {                                         \
-      LOGE("Numerical solver failed with code %d", rc);                        \
-      setup_free(&u);                                                          \
-      return EXIT_FAILURE;                                                     \
-    }                                                                          \
-    s.xend = clock();                                                          \
-    dur = (double)(s.xend - s.xbeg) / CLOCKS_PER_SEC;                          \
-    LOGI("Numerical solver completed (%d iter, %f sec)", s.it, dur);           \
-    snprintf(path_buf, RAD_PATH_BUFFER_SZ, #p CCM_FILE_SYSTEM_SEP #p "%02d",   \
-             it);                                                              \
-    setup_save(&u, path_buf);                                                  \
-    setup_free(&u);                                                            \
-  }                                                                            \
-  grid_free(&p##g)
-
-  mdepparam(delta);
-  mdepparam(alpha);
-  mdepparam(gamma);
-
-#undef mdepparam
-
-  pmap_free(&pmap);
-  return EXIT_SUCCESS;
+#include "cross_comp.h"
+#include "logger.h"
+
+/** Maximum number of sweeps */
+#define MAX_SWEEPS 16
+/** Output directory of a shard relative to the output directory (shard index
+ * and number of shards) */
+#define SHARD_DIR "shard%dof%d"
+
+/** Parse sweep names
+ * @details Splits the comma separated list of sweep names.
+ * @param list List of names
+ * @param names Output buffer of MAX_SWEEPS names
+ * @return The number of names */
+int parse_names(const char *list, char names[][SWEEP_NAME_SZ]) {
+  int n = 0;
+
+  while (*list && n < MAX_SWEEPS) {
+    size_t len = strcspn(list, ",");
+    const char *beg = list, *end = list + len;
+    while (beg < end && (*beg == ' ' || *beg == '\t')) {
+      ++beg;
+    }
+    while (end > beg && (end[-1] == ' ' || end[-1] == '\t' ||
+                         end[-1] == '\r' || end[-1] == '\n')) {
+      --end;
+    }
+    if (end > beg) {
+      snprintf(names[n++], SWEEP_NAME_SZ, "%.*s", (int)(end - beg), beg);
+    }
+    list += len + (list[len] == ',');
+  }
+  return n;
+}
+
+/** Environment integer
+ * @param name Environment variable
+ * @param def Default value
+ * @return The variable's value, or the default value if it is not set */
+int env_int(const char *name, int def) {
+  const char *val = getenv(name);
+  return val && *val ? atoi(val) : def;
+}
+
+/** Configure shard
+ * @details Reads the shard of the process from the command line (`rad_pardep
+ * <shard> <shards>`), from the RAD_PARDEP_SHARD and RAD_PARDEP_SHARDS
+ * environment variables or from the array task variables of Slurm, Grid
+ * Engine or LSF (whose task indices start at one).
+ * @param argc Number of arguments
+ * @param argv Arguments
+ * @param shard Output shard index
+ * @param shards Output number of shards
+ * @return Zero on success, non-zero if the shard is invalid */
+int config_shard(int argc, char **argv, int *shard, int *shards) {
+  const char *sge = getenv("SGE_TASK_ID");
+
+  *shard = 0;
+  *shards = 1;
+  if (argc > 2) {
+    *shard = atoi(argv[1]);
+    *shards = atoi(argv[2]);
+  } else if (getenv("RAD_PARDEP_SHARD")) {
+    *shard = env_int("RAD_PARDEP_SHARD", 0);
+    *shards = env_int("RAD_PARDEP_SHARDS", 1);
+  } else if (getenv("SLURM_ARRAY_TASK_ID")) {
+    int step = env_int("SLURM_ARRAY_TASK_STEP", 1);
+    *shard = (env_int("SLURM_ARRAY_TASK_ID", 0) -
+              env_int("SLURM_ARRAY_TASK_MIN", 0)) /
+             (step > 0 ? step : 1);
+    *shards = env_int("SLURM_ARRAY_TASK_COUNT", 1);
+  } else if (sge && strcmp(sge, "undefined")) {
+    int first = env_int("SGE_TASK_FIRST", 1);
+    int step = env_int("SGE_TASK_STEPSIZE", 1);
+    step = step > 0 ? step : 1;
+    *shard = (atoi(sge) - first) / step;
+    *shards = (env_int("SGE_TASK_LAST", first) - first) / step + 1;
+  } else if (env_int("LSB_JOBINDEX", 0) > 0) {
+    int step = env_int("LSB_JOBINDEX_STEP", 1);
+    step = step > 0 ? step : 1;
+    *shard = (env_int("LSB_JOBINDEX", 1) - 1) / step;
+    *shards = (env_int("LSB_JOBINDEX_END", 1) - 1) / step + 1;
+  }
+  if (*shards < 1 || *shard < 0 || *shard >= *shards) {
+    LOGE("Invalid shard %d of %d", *shard, *shards);
+    return -1;
+  }
+  return 0;
+}
+
+/** Open sweep
+ * @details Initializes the plan and the store of the named sweep in the
+ * current output directory. The existing store of a resumed plan is opened
+ * for appending; if it does not match, the sweep starts over.
+ * @param plan Uninitialized plan
+ * @param store Uninitialized store
+ * @param pmap Parameter map
+ * @param name Sweep name
+ * @param xsub Comma separated list of the stored wealth indices (NULL for all)
+ * @param rsub Comma separated list of the stored radius indices (NULL for all)
+ * @return Zero on success, non-zero otherwise */
+int open_sweep(plan_t *plan, sweep_t *store, const pmap_t *pmap,
+               const char *name, const char *xsub, const char *rsub) {
+  if (plan_init(plan, pmap, name) != 0) {
+    return -1;
+  }
+  if (sweep_init(store, plan_param(plan), name, plan->n, xsub, rsub) != 0) {
+    sweep_free(store);
+    plan_free(plan);
+    return -2;
+  }
+  if (!plan->fresh && sweep_open(store) < -1) {
+    LOGW("Sweep store '%s' does not match, restarting the sweep", name);
+    sweep_free(store);
+    sweep_init(store, plan_param(plan), name, plan->n, xsub, rsub);
+    plan->fresh = true;
+    memset(plan->status, 0, plan->n * sizeof(int));
+  }
+  return 0;
+}
+
+/** Merge shards
+ * @details Appends the points of the shards' stores (see config_shard()) to
+ * the stores of the output directory and records them in the manifests. Only
+ * shards whose manifests match the plans are merged and points that are
+ * complete are skipped.
+ * @param pmap Parameter map
+ * @param names Sweep names
+ * @param nsweeps Number of sweeps
+ * @param shards Number of shards
+ * @param xsub Comma separated list of the stored wealth indices (NULL for all)
+ * @param rsub Comma separated list of the stored radius indices (NULL for all)
+ * @return Zero on success, non-zero otherwise */
+int merge_shards(const pmap_t *pmap, char names[][SWEEP_NAME_SZ], int nsweeps,
+                 int shards, const char *xsub, const char *rsub) {
+  char dir[RAD_PATH_BUFFER_SZ], path[RAD_PATH_BUFFER_SZ];
+  plan_t plan, part;
+  sweep_t store;
+  rad_ctx_t x;
+  int rc = 0;
+
+  rad_ctx_init(&x);
+  x.temp_dir = dir;
+  for (int p = 0; p < nsweeps; ++p) {
+    int merged = 0, done = 0;
+    if (open_sweep(&plan, &store, pmap, names[p], xsub, rsub) != 0) {
+      rc = -1;
+      continue;
+    }
+    for (int k = 0; k < shards; ++k) {
+      snprintf(dir, RAD_PATH_BUFFER_SZ, "%s" CCM_FILE_SYSTEM_SEP SHARD_DIR,
+               RAD_TEMP_DIR, k, shards);
+      snprintf(path, RAD_PATH_BUFFER_SZ, SHARD_DIR CCM_FILE_SYSTEM_SEP "%s", k,
+               shards, names[p]);
+      // The shard's manifest is read from its output directory
+      rad_ctx_set(&x);
+      int ec = plan_init(&part, pmap, names[p]);
+      rad_ctx_set(NULL);
+      if (ec != 0) {
+        rc = -2;
+        continue;
+      }
+      if (part.fresh) {
+        LOGW("Shard %d of sweep '%s' has no matching manifest", k, names[p]);
+      }
+      for (int i = 0; i < part.n && !part.fresh && ec == 0; ++i) {
+        int it;
+        double acc;
+        if (part.status[i] != PLAN_DONE || plan.status[i] == PLAN_DONE) {
+          continue;
+        }
+        if ((ec = sweep_copy(&store, path, plan_value(&plan, i), &it, &acc))) {
+          LOGE("Failed to merge point %d of '%s'", i, path);
+          rc = -3;
+        } else if (plan_mark(&plan, i, PLAN_DONE, it, acc) != 0) {
+          LOGW("Failed to record point %d of sweep '%s'", i, names[p]);
+        }
+        merged += ec == 0;
+      }
+      plan_free(&part);
+    }
+    for (int i = 0; i < plan.n; ++i) {
+      done += plan.status[i] == PLAN_DONE;
+    }
+    LOGI("Merged %d points of %d shards into sweep '%s' (%d of %d points done)",
+         merged, shards, names[p], done, plan.n);
+    sweep_free(&store);
+    plan_free(&plan);
+  }
+  return rc;
+}
+
+/** List jobs
+ * @details Lists every point of the open sweeps as a pending job.
+ * @param plans Sweep plans
+ * @param stores Sweep stores
+ * @param ready The sweeps that are open
+ * @param nsweeps Number of sweeps
+ * @param jobs Output jobs (freed by the caller)
+ * @return The number of jobs */
+int list_jobs(plan_t *plans, sweep_t *stores, const bool *ready, int nsweeps,
+              sched_job_t **jobs) {
+  int n = 0;
+
+  for (int p = 0; p < nsweeps; ++p) {
+    n += ready[p] ? plans[p].n : 0;
+  }
+  *jobs = (sched_job_t *)calloc(n > 0 ? n : 1, sizeof(**jobs));
+  for (int p = 0, j = 0; p < nsweeps; ++p) {
+    for (int i = 0; ready[p] && i < plans[p].n; ++i) {
+      (*jobs)[j++] = (sched_job_t){.plan = &plans[p],
+                                   .point = i,
+                                   .store = &stores[p],
+                                   .cost = -1,
+                                   .state = SCHED_PENDING};
+    }
+  }
+  return n;
+}
+
+/** Pending jobs
+ * @details Moves the jobs of the points that are not done to the front, where
+ * the started points resume from their periodic saves.
+ * @param jobs Jobs
+ * @param n Number of jobs
+ * @return The number of pending jobs */
+int pending_jobs(sched_job_t *jobs, int n) {
+  int pending = 0;
+
+  for (int j = 0; j < n; ++j) {
+    int status = jobs[j].plan->status[jobs[j].point];
+    if (status != PLAN_DONE) {
+      jobs[pending] = jobs[j];
+      jobs[pending++].resume = status != PLAN_PENDING;
+    }
+  }
+  return pending;
+}
+
+/** Refine sweeps
+ * @details Inserts new points into the refined sweeps (see plan_refine()).
+ * @param plans Sweep plans
+ * @param ready The sweeps that are open
+ * @param nsweeps Number of sweeps
+ * @return The number of inserted points, or a negative value on failure */
+int refine_sweeps(plan_t *plans, const bool *ready, int nsweeps) {
+  int added = 0;
+
+  for (int p = 0; p < nsweeps; ++p) {
+    int k = ready[p] ? plan_refine(&plans[p]) : 0;
+    if (k < 0) {
+      return k;
+    }
+    added += k;
+  }
+  return added;
+}
+
+int main(int argc, char **argv) {
+  int rc = 0, n = 0, nsweeps, lanes = 1, batch = 1, cont = SCHED_COLD;
+  int policies = 0;
+  int shard, shards;
+  const objpart_t objparts[4] = {{util, CCM_STRINGIFY(_util_)},
+                                 {cost, CCM_STRINGIFY(_cost_)},
+                                 {radt, CCM_STRINGIFY(_radt_)},
+                                 {wltt, CCM_STRINGIFY(_wltt_)}};
+  char names[MAX_SWEEPS][SWEEP_NAME_SZ];
+  char path_buf[RAD_PATH_BUFFER_SZ], shard_dir[RAD_PATH_BUFFER_SZ];
+  pmap_t pmap;
+  plan_t plans[MAX_SWEEPS];
+  sweep_t stores[MAX_SWEEPS];
+  bool ready[MAX_SWEEPS] = {false};
+  bool merge = argc > 1 && strcmp(argv[1], "merge") == 0;
+  rad_ctx_t x;
+  const char *val;
+
+  if (merge) {
+    shard = 0;
+    shards = argc > 2 ? atoi(argv[2]) : env_int("RAD_PARDEP_SHARDS", 0);
+    if (shards < 1) {
+      LOGE("Usage: rad_pardep merge <shards>");
+      return EXIT_FAILURE;
+    }
+  } else if (config_shard(argc, argv, &shard, &shards) != 0) {
+    return EXIT_FAILURE;
+  }
+  snprintf(path_buf, RAD_PATH_BUFFER_SZ, "%s" CCM_FILE_SYSTEM_SEP "pardep.prm",
+           RAD_DATA_DIR);
+  if (pmap_init(&pmap, path_buf) != 0) {
+    return EXIT_FAILURE;
+  }
+  setup_catch_signals();
+  // Number of concurrent solves
+  if ((val = pmap_find(&pmap, "jobs")) || (val = getenv("RAD_PARDEP_JOBS"))) {
+    lanes = atoi(val);
+  }
+  // Number of sweep points solved in lockstep by every concurrent solve
+  if ((val = pmap_find(&pmap, "batch")) || (val = getenv("RAD_PARDEP_BATCH"))) {
+    batch = atoi(val);
+  }
+  // Warm starts from the solved neighbours of the sweep points
+  if ((val = pmap_find(&pmap, "continuation")) ||
+      (val = getenv("RAD_PARDEP_CONTINUE"))) {
+    cont = atoi(val);
+  }
+  if ((val = pmap_find(&pmap, "warmpol")) ||
+      (val = getenv("RAD_WARM_POLICIES"))) {
+    policies = atoi(val);
+  }
+  // Optional subsets of the stored wealth and radius indices
+  const char *xsub = pmap_find(&pmap, "sweepx");
+  const char *rsub = pmap_find(&pmap, "sweepr");
+  // Swept plans (see rad_plan.h)
+  if (!(val = pmap_find(&pmap, "sweeps"))) {
+    val = "delta, alpha, gamma";
+  }
+  nsweeps = parse_names(val, names);
+
+  if (merge) {
+    rc = merge_shards(&pmap, names, nsweeps, shards, xsub, rsub);
+    pmap_free(&pmap);
+    return rc == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+  if (shards > 1) {
+    // Every shard has its own stores, manifests and periodic saves
+    snprintf(shard_dir, RAD_PATH_BUFFER_SZ,
+             "%s" CCM_FILE_SYSTEM_SEP SHARD_DIR, RAD_TEMP_DIR, shard, shards);
+    mkdirp(shard_dir, 0755);
+    rad_ctx_init(&x);
+    x.temp_dir = shard_dir;
+    rad_ctx_set(&x);
+  }
+
+  // Every pending sweep point is an independent job
+  for (int p = 0; p < nsweeps; ++p) {
+    if (open_sweep(&plans[p], &stores[p], &pmap, names[p], xsub, rsub) != 0) {
+      rc = -1;
+      continue;
+    }
+    ready[p] = true;
+    if (shards > 1 && plans[p].refine > 0) {
+      LOGW("Sweep '%s' is not refined in shards", names[p]);
+      plans[p].refine = 0;
+    }
+#if RAD_MPI
+    // The ranks would refine from a store that only rank zero writes
+    if (plans[p].refine > 0) {
+      LOGW("Sweep '%s' is not refined with MPI", names[p]);
+      plans[p].refine = 0;
+    }
+#endif /* RAD_MPI */
+  }
+  sched_job_t *jobs = NULL;
+  n = list_jobs(plans, stores, ready, nsweeps, &jobs);
+  if (shards > 1) {
+    // The shares are assigned by the costs of the merged stores
+    rad_ctx_set(NULL);
+    n = sched_shard(jobs, n, shard, shards);
+    rad_ctx_set(&x);
+  }
+  int pending = pending_jobs(jobs, n);
+
+  if (rc == 0 && pending > 0) {
+    rc = sched_run(jobs, pending, lanes, batch, cont, policies, "pardep.prm",
+                   objparts);
+  }
+  // Rounds of the points that are inserted by refined sweeps
+  while (rc == 0 && (rc = refine_sweeps(plans, ready, nsweeps)) > 0) {
+    free(jobs);
+    n = list_jobs(plans, stores, ready, nsweeps, &jobs);
+    pending = pending_jobs(jobs, n);
+    rc = sched_run(jobs, pending, lanes, batch, cont, policies, "pardep.prm",
+                   objparts);
+  }
+
+  free(jobs);
+  for (int p = 0; p < nsweeps; ++p) {
+    if (ready[p]) {
+      sweep_free(&stores[p]);
+      plan_free(&plans[p]);
+    }
+  }
+  pmap_free(&pmap);
+  rad_ctx_set(NULL);
+  if (rc == SETUP_HALTED) {
+    return SETUP_EXIT_HALTED;
+  }
+  return rc == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
 }
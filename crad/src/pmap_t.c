@@ -117,6 +117,36 @@ void pmap_add(pmap_t *pmap, const char *key, const char *val) {
   snprintf(pmap->p[pmap->n - 1].value, PMAP_T_PARAM_VALUE_SZ, "%s", val);
 }
 
+/** @brief Set pair
+ * @details Replaces the values of all the pairs with the passed key, or adds
+ * a pair if the key is not found.
+ * @param pmap Parameter map
+ * @param key Key
+ * @param val New value */
+void pmap_set(pmap_t *pmap, const char *key, const char *val) {
+  int found = 0;
+  for (int i = 0; i < pmap->n; ++i) {
+    if (!strcmp(pmap->p[i].key, key)) {
+      snprintf(pmap->p[i].value, PMAP_T_PARAM_VALUE_SZ, "%s", val);
+      found = 1;
+    }
+  }
+  if (!found) {
+    pmap_add(pmap, key, val);
+  }
+}
+
+/** @brief Copy parameter map
+ * @details Initializes a parameter map with copies of the passed map's pairs.
+ * The copy should be deallocated by the user.
+ * @param dest Uninitialized parameter map
+ * @param source Parameter map */
+void pmap_copy(pmap_t *dest, const pmap_t *source) {
+  dest->n = source->n;
+  dest->p = (param_pair_t *)malloc((source->n + 1) * sizeof(param_pair_t));
+  memcpy(dest->p, source->p, source->n * sizeof(param_pair_t));
+}
+
 /** @brief Add pair from int value
  * @details Adds a key value pair into the parameter map. The passed value
  * is of integer data type. The function converts it to string and
@@ -0,0 +1,281 @@
+#include "rad_cache.h"
+
+#include "cross_comp.h"
+#include "grid_t.h"
+#include "rad_ctx.h"
+#include "rad_file.h"
+#include "rad_threads.h"
+
+#include "ctype.h"
+#include "errno.h"
+#include "stdint.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+
+#define LM_LEVEL 3
+#include "logger.h"
+
+/** Canonical grid specification format */
+#define GRID_FMT "%d, %.17g, %.17g, %.17g"
+/** Arguments of the canonical grid specification format */
+#define GRID_ARGS(g) (g)->n, (g)->m, (g)->M, (g)->w
+
+/** Entry path buffer size (see entry_path()) */
+#define ENTRY_PATH_SZ 64
+/** File name buffer size (see entry_file()) */
+#define ENTRY_FILE_SZ (RAD_PATH_BUFFER_SZ + 2 * ENTRY_PATH_SZ)
+
+/** Functional specification of an objective part (empty if it is unknown) */
+static const char *spec(objpart_t p) { return p.str ? p.str : ""; }
+
+/** Canonical text
+ * @param buf Output buffer (can be NULL)
+ * @param sz Size of the output buffer
+ * @param m Model
+ * @param s Solution
+ * @return The length of the text */
+static int canonical(char *buf, size_t sz, const model_t *m, const sol_t *s) {
+  return snprintf(buf, sz,
+                  "rad = %d.%d.%d\n"
+                  "alpha = %.17g\nbeta = %.17g\ndelta = %.17g\n"
+                  "gamma = %.17g\nR = %.17g\n"
+                  "util = %s\ncost = %s\nradt = %s\nwltt = %s\n"
+                  "xg = " GRID_FMT "\nrg = " GRID_FMT "\n"
+                  "qg = " GRID_FMT "\nsg = " GRID_FMT "\n"
+                  "qadp = %.17g\nsadp = %.17g\ntol = %.17g\n",
+                  RAD_VERSION_MAJOR, RAD_VERSION_MINOR, RAD_VERSION_PATCH,
+                  m->alpha, m->beta, m->delta, m->gamma, m->R,
+                  spec(m->util), spec(m->cost), spec(m->radt), spec(m->wltt),
+                  GRID_ARGS(s->xg), GRID_ARGS(s->rg), GRID_ARGS(s->qg),
+                  GRID_ARGS(s->sg), s->qadp, s->sadp, s->tol);
+}
+
+/** Entry path
+ * @details The path of a file of the entry relative to the cache directory,
+ * i.e. `<k0k1>/<key><ext><tag>`.
+ * @param h Cache
+ * @param ext Extension
+ * @param tag Unique tag of a file that is being written (can be empty)
+ * @param path Output buffer of ENTRY_PATH_SZ bytes */
+static void entry_path(const cache_t *h, const char *ext, const char *tag,
+                       char *path) {
+  snprintf(path, ENTRY_PATH_SZ, "%.2s" CCM_FILE_SYSTEM_SEP "%s%s%s", h->key,
+           h->key, ext, tag);
+}
+
+/** Entry file name
+ * @param h Cache
+ * @param path Entry path (see entry_path())
+ * @param ext Extension that is appended to the path
+ * @param filename Output buffer of ENTRY_FILE_SZ bytes */
+static void entry_file(const cache_t *h, const char *path, const char *ext,
+                       char *filename) {
+  snprintf(filename, ENTRY_FILE_SZ, "%s" CCM_FILE_SYSTEM_SEP "%s%s", h->dir,
+           path, ext);
+}
+
+/** Enter cache
+ * @details Makes a copy of the current context with the cache directory as
+ * output directory current, so that the files of the entries are accessed by
+ * the rad_file.h functions.
+ * @param h Cache
+ * @param x Output context
+ * @return The previous context */
+static const rad_ctx_t *enter(const cache_t *h, rad_ctx_t *x) {
+  const rad_ctx_t *prev = rad_ctx_get();
+  *x = *prev;
+  x->temp_dir = h->dir;
+  rad_ctx_set(x);
+  return prev;
+}
+
+/** @brief Initialize cache
+ * @details Creates the cache directory if it is missing.
+ * @param h Uninitialized cache
+ * @param dir Cache directory (leading and trailing white space is ignored,
+ * e.g. of a parameter file's value)
+ * @return Zero on success, non-zero if the directory cannot be created */
+int cache_init(cache_t *h, const char *dir) {
+  size_t n;
+
+  memset(h, 0, sizeof(*h));
+  while (isspace((unsigned char)*dir)) {
+    ++dir;
+  }
+  for (n = strlen(dir); n > 0 && isspace((unsigned char)dir[n - 1]); --n) {
+  }
+  if (n == 0) {
+    LOGE("Empty cache directory");
+    return -1;
+  }
+  // mkdirp() expects a separator in the path
+  bool sep = memchr(dir, CCM_FILE_SYSTEM_SEP[0], n) != NULL;
+  if (n + (sep ? 0 : 2) >= RAD_PATH_BUFFER_SZ) {
+    LOGE("Cache directory '%.*s' is too long", (int)n, dir);
+    return -1;
+  }
+  snprintf(h->dir, RAD_PATH_BUFFER_SZ, "%s%.*s",
+           sep ? "" : "." CCM_FILE_SYSTEM_SEP, (int)n, dir);
+  if (mkdirp(h->dir, 0755) != 0 && errno != EEXIST) {
+    LOGE("Failed to create cache directory '%s' with errno %d", h->dir, errno);
+    return -1;
+  }
+  return 0;
+}
+
+/** @brief Configuration key
+ * @details Sets the canonical text and the key of the configuration of a
+ * model and a solution that are initialized, but not solved, e.g. by
+ * model_init() and solution_init().
+ * @param h Cache
+ * @param m Model
+ * @param s Solution */
+void cache_key(cache_t *h, const model_t *m, const sol_t *s) {
+  int len = canonical(NULL, 0, m, s);
+  uint64_t hash = 0xCBF29CE484222325ULL;
+
+  free(h->text);
+  h->text = (char *)malloc(len + 1);
+  canonical(h->text, len + 1, m, s);
+  for (int i = 0; i < len; ++i) {
+    hash = (hash ^ (uint8_t)h->text[i]) * 0x100000001B3ULL;
+  }
+  snprintf(h->key, CACHE_KEY_SZ, "%016llx", (unsigned long long)hash);
+}
+
+/** Matching key file
+ * @return True if the entry's key file holds the configuration's text */
+static bool key_matches(const cache_t *h) {
+  char path[ENTRY_PATH_SZ], filename[ENTRY_FILE_SZ];
+  size_t len = strlen(h->text);
+  char *buf = (char *)malloc(len + 2);
+
+  entry_path(h, RAD_CACHE_KEY_EXT, "", path);
+  entry_file(h, path, "", filename);
+  FILE *fh = fopen(filename, "rb");
+  size_t n = fh ? fread(buf, 1, len + 1, fh) : 0;
+  if (fh) {
+    fclose(fh);
+  }
+  bool match = fh && n == len && memcmp(buf, h->text, len) == 0;
+  if (fh && !match) {
+    LOGW("Cache key %s belongs to another configuration", h->key);
+  }
+  free(buf);
+  return match;
+}
+
+/** @brief Load cached solution
+ * @details Loads the converged solution, or the last state of a halted solve,
+ * of the configuration (see rad_file_load()).
+ * @param h Cache with a configuration key (see cache_key())
+ * @param partial Load the state of a halted solve
+ * @param objparts Model's functional specification
+ * @param m Uninitialized model
+ * @param s Uninitialized solution
+ * @return Zero on success, non-zero if the entry is missing or invalid */
+int cache_load(const cache_t *h, bool partial, const objpart_t *objparts,
+               model_t *m, sol_t *s) {
+  char path[ENTRY_PATH_SZ], filename[ENTRY_FILE_SZ];
+  rad_ctx_t x;
+  FILE *fh;
+
+  if (!h->text) {
+    return -1;
+  }
+  entry_path(h, partial ? RAD_CACHE_PART_EXT : "", "", path);
+  entry_file(h, path, RAD_FILE_EXT, filename);
+  if (!(fh = fopen(filename, "rb"))) {
+    return -2;
+  }
+  fclose(fh);
+  if (!key_matches(h)) {
+    return -3;
+  }
+
+  const rad_ctx_t *prev = enter(h, &x);
+  int ec = rad_file_load(m, s, path, objparts);
+  rad_ctx_set(prev);
+  if (ec != 0) {
+    LOGW("Invalid cache entry '%s'", filename);
+    return -4;
+  }
+  return 0;
+}
+
+/** @brief Store solution
+ * @details Stores the converged solution, or the last state of a halted solve,
+ * of the configuration. A stored solution replaces the state of a halted
+ * solve.
+ * @param h Cache with a configuration key (see cache_key())
+ * @param partial Store the state of a halted solve
+ * @param m Model
+ * @param s Solution
+ * @return Zero on success, non-zero otherwise */
+int cache_store(const cache_t *h, bool partial, const model_t *m,
+                const sol_t *s) {
+  char path[ENTRY_PATH_SZ], part[ENTRY_PATH_SZ];
+  char from[ENTRY_FILE_SZ], to[ENTRY_FILE_SZ];
+  rad_ctx_t x;
+  int ec = 0;
+
+  if (!h->text) {
+    return -1;
+  }
+  // The files are written under a unique name and renamed, since other
+  // processes can store the same entry concurrently
+  unsigned long long tag = (unsigned long long)(rad_wall_time() * 1e9) ^
+                           (unsigned long long)(uintptr_t)s;
+  char unique[CACHE_KEY_SZ + 8];
+  snprintf(unique, sizeof(unique), ".%016llx", tag);
+
+  snprintf(to, sizeof(to), "%s" CCM_FILE_SYSTEM_SEP "%.2s", h->dir, h->key);
+  mkdirp(to, 0755);
+  entry_path(h, RAD_CACHE_KEY_EXT, "", path);
+  entry_file(h, path, "", to);
+  entry_file(h, path, unique, from);
+  FILE *fh = fopen(from, "wb");
+  if (!fh || fputs(h->text, fh) < 0) {
+    ec = -2;
+  }
+  if (fh && fclose(fh) != 0) {
+    ec = -2;
+  }
+  if (ec == 0 && (ec = rename_replace(from, to)) != 0) {
+    remove(from);
+  }
+
+  const rad_ctx_t *prev = enter(h, &x);
+  entry_path(h, partial ? RAD_CACHE_PART_EXT : "", "", path);
+  entry_path(h, partial ? RAD_CACHE_PART_EXT : "", unique, part);
+  if (ec == 0 && (ec = rad_file_save(m, s, part)) == 0) {
+    entry_file(h, part, RAD_FILE_EXT, from);
+    entry_file(h, path, RAD_FILE_EXT, to);
+    if ((ec = rename_replace(from, to)) != 0) {
+      remove(from);
+    }
+  }
+  if (ec == 0 && !partial) {
+    entry_path(h, RAD_CACHE_PART_EXT RAD_FILE_EXT, "", path);
+    entry_file(h, path, "", to);
+    remove(to);
+  }
+  rad_ctx_set(prev);
+
+  if (ec != 0) {
+    LOGW("Failed to store cache entry %s with errno %d", h->key, errno);
+    return -3;
+  }
+  LOGI("Stored the %s of cache entry %s", partial ? "halted solve" : "solution",
+       h->key);
+  return 0;
+}
+
+/** @brief Free cache
+ * @details The stored entries remain.
+ * @param h Cache */
+void cache_free(cache_t *h) {
+  free(h->text);
+  memset(h, 0, sizeof(*h));
+}
@@ -0,0 +1,221 @@
+#include "rad_ckpt.h"
+#include "rad_conf.h"
+
+#include "cross_comp.h"
+#include "rad_ctx.h"
+#include "rad_file.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+
+#define LM_LEVEL 3
+#include "logger.h"
+
+/** Number of saves per delta chain, i.e. a full save and the deltas that
+ * depend on it. Retention needs whole chains, thus they are bounded by the
+ * number of retained saves. */
+#define KEY_CYCLE (RAD_SAVE_KEEP > 0 ? RAD_SAVE_KEEP : 16)
+
+/** Retain save
+ * @details Records a published save and removes the saves that are no longer
+ * retained. The last RAD_SAVE_KEEP saves are retained, together with the
+ * saves their deltas depend on.
+ * @param k Checkpointer
+ * @param path Save path relative to the output directory
+ * @param key The save does not depend on previous saves */
+void retain(ckpt_t *k, const char *path, bool key) {
+  char filename[2 * RAD_PATH_BUFFER_SZ];
+
+  if (!k->kept) {
+    return;
+  }
+  snprintf(k->kept[k->nkept].path, RAD_PATH_BUFFER_SZ, "%s", path);
+  k->kept[k->nkept++].key = key;
+
+  // The oldest retained save is located and then the start of its chain
+  int o = k->nkept - RAD_SAVE_KEEP;
+  while (o > 0 && !k->kept[o].key) {
+    --o;
+  }
+  for (int i = 0; i < o; ++i) {
+    snprintf(filename, sizeof(filename),
+             "%s" CCM_FILE_SYSTEM_SEP "%s" RAD_FILE_EXT, rad_temp_dir(),
+             k->kept[i].path);
+    if (remove(filename) != 0) {
+      LOGW("Failed to remove save '%s'", filename);
+    }
+  }
+  if (o > 0) {
+    memmove(k->kept, k->kept + o, (k->nkept - o) * sizeof(*k->kept));
+    k->nkept -= o;
+  }
+}
+
+/** Publish save
+ * @details Saves the model and the solution in a container file (see
+ * rad_file_save_enc()) with the RAD_SAVE_ENCODING encoding. Delta saves are
+ * encoded against the previously published solution, except for the first save
+ * of every KEY_CYCLE saves. An existing save of the same path is replaced.
+ * @param k Checkpointer
+ * @param m Model
+ * @param s Solution
+ * @param path Save path relative to the output directory
+ * @param snap Snapshot of the solution that can become the next base (can be
+ * NULL) */
+void publish(ckpt_t *k, const model_t *m, const sol_t *s, const char *path,
+             sol_t *snap) {
+  bool delta = RAD_SAVE_ENCODING == RAD_FILE_DELTA;
+  bool key = !delta || !k->base.mem || k->chain >= KEY_CYCLE - 1;
+
+  if (rad_file_save_enc(m, s, path, RAD_SAVE_ENCODING, key ? NULL : &k->base,
+                        k->base_path) != 0) {
+    LOGE("Failed to publish save '%s'", path);
+    // The next save must not depend on the missing one
+    k->chain = KEY_CYCLE;
+    return;
+  }
+
+  if (delta) {
+    if (snap) {
+      // The previous base's memory is reused by the next snapshot
+      sol_t tmp = k->base;
+      k->base = *snap;
+      *snap = tmp;
+    } else {
+      solution_copy(&k->base, s);
+    }
+    snprintf(k->base_path, RAD_PATH_BUFFER_SZ, "%s", path);
+    k->chain = key ? 0 : k->chain + 1;
+  }
+  retain(k, path, key);
+}
+
+int io_main(void *vk) {
+  ckpt_t *k = (ckpt_t *)vk;
+  rad_ctx_set(k->x);
+
+  rad_mtx_lock(&k->mtx);
+  while (true) {
+    while (k->count == 0 && !k->stop) {
+      rad_cnd_wait(&k->pushed, &k->mtx);
+    }
+    if (k->count == 0) {
+      break;
+    }
+    struct snapshot_st *p = &k->snaps[k->head];
+    rad_mtx_unlock(&k->mtx);
+
+    publish(k, &p->m, &p->s, p->path, &p->s);
+    LOGD("Checkpoint '%s' written", p->path);
+
+    rad_mtx_lock(&k->mtx);
+    k->head = (k->head + 1) % k->n;
+    --k->count;
+    rad_cnd_broadcast(&k->written);
+  }
+  rad_mtx_unlock(&k->mtx);
+
+  return EXIT_SUCCESS;
+}
+
+/** @brief Initialize checkpointer
+ * @details Allocates the snapshot ring and starts the I/O thread. The
+ * snapshots' memory is allocated when they are first taken.
+ * @param k Checkpointer
+ * @param n Maximum number of outstanding snapshots (positive)
+ * @param x Execution context of the I/O thread (can be NULL) */
+void ckpt_init(ckpt_t *k, int n, const struct rad_ctx_st *x) {
+  k->x = x;
+  k->n = n;
+  k->snaps = (struct snapshot_st *)calloc(n, sizeof(struct snapshot_st));
+  k->head = 0;
+  k->count = 0;
+  k->stop = false;
+  memset(&k->base, 0, sizeof(k->base));
+  k->base_path[0] = '\0';
+  k->chain = 0;
+  k->kept = RAD_SAVE_KEEP > 0 ? (struct retained_st *)calloc(
+                                    2 * RAD_SAVE_KEEP, sizeof(*k->kept))
+                              : NULL;
+  k->nkept = 0;
+  rad_mtx_init(&k->mtx);
+  rad_cnd_init(&k->pushed);
+  rad_cnd_init(&k->written);
+  k->async = rad_thrd_create(&k->thread, io_main, k) == 0;
+  if (!k->async) {
+    LOGD("Checkpoints are written synchronously");
+  }
+}
+
+/** @brief Push checkpoint
+ * @details Takes a snapshot of the passed model and solution and queues it for
+ * writing to the passed path. If RAD_SAVE_QUEUE snapshots are outstanding, the
+ * function waits for the oldest one to be written.
+ * @param k Checkpointer
+ * @param m Model
+ * @param s Solution
+ * @param path Save path relative to the output directory */
+void ckpt_push(ckpt_t *k, const model_t *m, const sol_t *s, const char *path) {
+  if (!k->async) {
+    publish(k, m, s, path, NULL);
+    return;
+  }
+
+  rad_mtx_lock(&k->mtx);
+  while (k->count == k->n) {
+    rad_cnd_wait(&k->written, &k->mtx);
+  }
+  // Only the pushing thread fills free snapshots
+  struct snapshot_st *p = &k->snaps[(k->head + k->count) % k->n];
+  rad_mtx_unlock(&k->mtx);
+
+  p->m = *m;
+  solution_copy(&p->s, s);
+  snprintf(p->path, RAD_PATH_BUFFER_SZ, "%s", path);
+  LOGD("Checkpoint '%s' taken", path);
+
+  rad_mtx_lock(&k->mtx);
+  ++k->count;
+  rad_cnd_signal(&k->pushed);
+  rad_mtx_unlock(&k->mtx);
+}
+
+/** @brief Drain checkpoints
+ * @details Waits until all the outstanding snapshots are written.
+ * @param k Checkpointer */
+void ckpt_drain(ckpt_t *k) {
+  rad_mtx_lock(&k->mtx);
+  while (k->count > 0) {
+    rad_cnd_wait(&k->written, &k->mtx);
+  }
+  rad_mtx_unlock(&k->mtx);
+}
+
+/** @brief Free checkpointer
+ * @details Writes the outstanding snapshots, stops the I/O thread and frees
+ * the snapshots.
+ * @param k Checkpointer */
+void ckpt_free(ckpt_t *k) {
+  if (k->async) {
+    rad_mtx_lock(&k->mtx);
+    k->stop = true;
+    rad_cnd_signal(&k->pushed);
+    rad_mtx_unlock(&k->mtx);
+    rad_thrd_join(k->thread);
+  }
+  rad_cnd_destroy(&k->written);
+  rad_cnd_destroy(&k->pushed);
+  rad_mtx_destroy(&k->mtx);
+
+  for (int i = 0; i < k->n; ++i) {
+    if (k->snaps[i].s.mem) {
+      solution_free(&k->snaps[i].s);
+    }
+  }
+  free(k->snaps);
+  if (k->base.mem) {
+    solution_free(&k->base);
+  }
+  free(k->kept);
+}
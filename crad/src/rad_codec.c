@@ -0,0 +1,230 @@
+#include "rad_codec.h"
+
+#include "stdlib.h"
+#include "string.h"
+
+/** Hash table size of the LZ codec (in bits) */
+#define HASH_BITS 14
+/** Maximum match offset */
+#define MAX_OFFSET 65535
+/** Search step growth (in bits); incompressible data are skipped faster */
+#define SKIP_BITS 6
+
+/** @brief Byte shuffle
+ * @details Regroups the bytes of an array of doubles by significance. The k-th
+ * byte of every value is stored in the k-th block of n bytes of the
+ * destination.
+ * @param dest Destination buffer of 8n bytes
+ * @param source Source array of n doubles in byte representation
+ * @param n Number of values */
+void codec_shuffle(uint8_t *dest, const uint8_t *source, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t k = 0; k < sizeof(double); ++k) {
+      dest[k * n + i] = source[i * sizeof(double) + k];
+    }
+  }
+}
+
+/** @brief Byte unshuffle
+ * @details Inverts codec_shuffle().
+ * @param dest Destination array of n doubles in byte representation
+ * @param source Shuffled buffer of 8n bytes
+ * @param n Number of values */
+void codec_unshuffle(uint8_t *dest, const uint8_t *source, size_t n) {
+  for (size_t k = 0; k < sizeof(double); ++k) {
+    for (size_t i = 0; i < n; ++i) {
+      dest[i * sizeof(double) + k] = source[k * n + i];
+    }
+  }
+}
+
+/** @brief Combine with base
+ * @details Replaces the passed data by their exclusive disjunction with the
+ * base data. The operation is its own inverse. Equal values become zero and
+ * close values share their leading bytes, which then become zero.
+ * @param data Data
+ * @param base Base data
+ * @param size Size in bytes */
+void codec_xor(uint8_t *data, const uint8_t *base, size_t size) {
+  for (size_t i = 0; i < size; ++i) {
+    data[i] ^= base[i];
+  }
+}
+
+/** @brief CRC-32
+ * @details Updates the passed CRC-32 checksum (reflected polynomial
+ * 0xEDB88320) with the passed data, as zlib's crc32() does. The checksum of
+ * data in one piece is calculated from zero.
+ * @param crc Checksum of the previous data
+ * @param data Data
+ * @param n Size in bytes
+ * @return Checksum */
+uint32_t codec_crc32(uint32_t crc, const uint8_t *data, size_t n) {
+  uint32_t table[256], c;
+  for (uint32_t i = 0; i < 256; ++i) {
+    c = i;
+    for (int k = 0; k < 8; ++k) {
+      c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+    }
+    table[i] = c;
+  }
+  c = crc ^ 0xFFFFFFFFu;
+  for (size_t i = 0; i < n; ++i) {
+    c = table[(c ^ data[i]) & 0xFF] ^ (c >> 8);
+  }
+  return c ^ 0xFFFFFFFFu;
+}
+
+/** @brief Compression bound
+ * @param size Size of uncompressed data in bytes
+ * @return The maximum size of the compressed data */
+size_t codec_bound(size_t size) { return size + size / 255 + 16; }
+
+static uint32_t read32(const uint8_t *p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static uint32_t hash32(uint32_t v) {
+  return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+static size_t put_length(uint8_t *dest, size_t len) {
+  size_t op = 0;
+  for (; len >= 255; len -= 255) {
+    dest[op++] = 255;
+  }
+  dest[op++] = (uint8_t)len;
+  return op;
+}
+
+static size_t put_block(uint8_t *dest, const uint8_t *lit, size_t nlit,
+                        size_t offset, size_t mlen) {
+  size_t op = 1;
+  size_t ml = mlen ? mlen - CODEC_MIN_MATCH : 0;
+
+  dest[0] = (uint8_t)((nlit < 15 ? nlit : 15) << 4);
+  if (nlit >= 15) {
+    op += put_length(dest + op, nlit - 15);
+  }
+  memcpy(dest + op, lit, nlit);
+  op += nlit;
+  if (!mlen) {
+    return op;
+  }
+
+  dest[0] |= (uint8_t)(ml < 15 ? ml : 15);
+  dest[op++] = (uint8_t)offset;
+  dest[op++] = (uint8_t)(offset >> 8);
+  if (mlen - CODEC_MIN_MATCH >= 15) {
+    op += put_length(dest + op, mlen - CODEC_MIN_MATCH - 15);
+  }
+  return op;
+}
+
+/** @brief Compress
+ * @details Compresses the passed data with the LZ codec (see rad_codec.h).
+ * Matches are located with a hash table of the last positions of four-byte
+ * sequences. The search step grows with the number of pending literals.
+ * @param dest Destination buffer of at least codec_bound() bytes
+ * @param source Data
+ * @param size Size of the data in bytes
+ * @return The size of the compressed data */
+size_t codec_compress(uint8_t *dest, const uint8_t *source, size_t size) {
+  size_t *table = (size_t *)calloc((size_t)1 << HASH_BITS, sizeof(size_t));
+  size_t ip = 0, anchor = 0, op = 0;
+
+  while (table && ip + CODEC_MIN_MATCH <= size) {
+    uint32_t h = hash32(read32(source + ip));
+    // Positions are stored incremented, so that zero marks empty entries
+    size_t ref = table[h];
+    table[h] = ip + 1;
+    if (!ref || ip - (ref - 1) > MAX_OFFSET ||
+        read32(source + ref - 1) != read32(source + ip)) {
+      ip += 1 + ((ip - anchor) >> SKIP_BITS);
+      continue;
+    }
+
+    size_t len = CODEC_MIN_MATCH;
+    while (ip + len < size && source[ref - 1 + len] == source[ip + len]) {
+      ++len;
+    }
+    op += put_block(dest + op, source + anchor, ip - anchor, ip - (ref - 1),
+                    len);
+    ip += len;
+    anchor = ip;
+  }
+  free(table);
+
+  op += put_block(dest + op, source + anchor, size - anchor, 0, 0);
+  return op;
+}
+
+static int get_length(const uint8_t *source, size_t n, size_t *ip,
+                      size_t *len) {
+  uint8_t b;
+  do {
+    if (*ip >= n) {
+      return -1;
+    }
+    b = source[(*ip)++];
+    *len += b;
+  } while (b == 255);
+  return 0;
+}
+
+/** @brief Decompress
+ * @details Decompresses data created by codec_compress(). The stream is
+ * validated; corrupted streams never access memory out of the passed buffers.
+ * @param dest Destination buffer
+ * @param size Size of the uncompressed data in bytes
+ * @param source Compressed data
+ * @param n Size of the compressed data in bytes
+ * @return Zero if the stream decompresses to exactly size bytes, non-zero
+ * otherwise */
+int codec_decompress(uint8_t *dest, size_t size, const uint8_t *source,
+                     size_t n) {
+  size_t ip = 0, op = 0;
+
+  while (ip < n) {
+    uint8_t token = source[ip++];
+    size_t len = token >> 4;
+    if (len == 15 && get_length(source, n, &ip, &len)) {
+      return -1;
+    }
+    if (len > n - ip || len > size - op) {
+      return -2;
+    }
+    memcpy(dest + op, source + ip, len);
+    ip += len;
+    op += len;
+    if (ip == n) {
+      break;
+    }
+
+    if (n - ip < 2) {
+      return -3;
+    }
+    size_t offset = source[ip] | (size_t)source[ip + 1] << 8;
+    ip += 2;
+    len = (token & 15) + CODEC_MIN_MATCH;
+    if ((token & 15) == 15 && get_length(source, n, &ip, &len)) {
+      return -1;
+    }
+    if (!offset || offset > op || len > size - op) {
+      return -4;
+    }
+    if (offset >= len) {
+      memcpy(dest + op, dest + op - offset, len);
+    } else {
+      // Overlapping matches repeat the last offset bytes
+      for (size_t i = 0; i < len; ++i) {
+        dest[op + i] = dest[op + i - offset];
+      }
+    }
+    op += len;
+  }
+
+  return op == size ? 0 : -5;
+}
@@ -0,0 +1,121 @@
+#include "rad_ctx.h"
+#include "rad_conf.h"
+
+#include "cross_comp.h"
+
+#include "stdarg.h"
+#include "stdbool.h"
+#include "stdio.h"
+#include "stdlib.h"
+
+#define LM_LEVEL 3
+#include "logger.h"
+
+static void *default_alloc(void *arg, size_t size, size_t align) {
+  (void)arg;
+  return aligned_alloc(align, size);
+}
+
+static void default_free(void *arg, void *ptr) {
+  (void)arg;
+  aligned_free(ptr);
+}
+
+static const rad_ctx_t default_ctx = {.threads = -1,
+                                      .data_dir = RAD_DATA_DIR,
+                                      .temp_dir = RAD_TEMP_DIR,
+                                      .log = NULL,
+                                      .log_arg = NULL,
+                                      .alloc = default_alloc,
+                                      .free = default_free,
+                                      .alloc_arg = NULL};
+
+/** Current context of the thread */
+static CCM_THREAD_LOCAL const rad_ctx_t *current = NULL;
+
+/** @brief Initialize context
+ * @details Sets the default values, i.e. a negative thread budget, the
+ * configured directories, the standard streams and the standard allocator.
+ * @param x Context */
+void rad_ctx_init(rad_ctx_t *x) { *x = default_ctx; }
+
+/** Custom allocator
+ * @return True if the context sets both allocation functions */
+static bool custom_alloc(const rad_ctx_t *x) { return x->alloc && x->free; }
+
+/** @brief Set current context
+ * @details Makes the passed context current for the calling thread. A context
+ * that sets only one of the allocation functions uses the standard allocator.
+ * @param x Context (NULL resets to the default context) */
+void rad_ctx_set(const rad_ctx_t *x) {
+  current = x;
+  if (x && !custom_alloc(x) && (x->alloc || x->free)) {
+    LOGE("Context sets an allocation function without its counterpart, "
+         "using the standard allocator");
+  }
+}
+
+/** @brief Get current context
+ * @return The calling thread's current context or the default context */
+const rad_ctx_t *rad_ctx_get() { return current ? current : &default_ctx; }
+
+/** @brief Parameter file directory
+ * @return The current context's parameter file directory */
+const char *rad_data_dir() {
+  const rad_ctx_t *x = rad_ctx_get();
+  return x->data_dir ? x->data_dir : RAD_DATA_DIR;
+}
+
+/** @brief Output directory
+ * @return The current context's output directory */
+const char *rad_temp_dir() {
+  const rad_ctx_t *x = rad_ctx_get();
+  return x->temp_dir ? x->temp_dir : RAD_TEMP_DIR;
+}
+
+/** @brief Allocate
+ * @details Allocates memory for large arrays using the current context's
+ * allocator. The memory is aligned to cache lines.
+ * @param size Size in bytes
+ * @return Allocated memory or NULL on failure */
+void *rad_alloc(size_t size) {
+  const rad_ctx_t *x = rad_ctx_get();
+  size = (size + RAD_CACHE_LINE_SZ - 1) / RAD_CACHE_LINE_SZ * RAD_CACHE_LINE_SZ;
+  if (custom_alloc(x)) {
+    return x->alloc(x->alloc_arg, size, RAD_CACHE_LINE_SZ);
+  }
+  return default_alloc(NULL, size, RAD_CACHE_LINE_SZ);
+}
+
+/** @brief Free
+ * @details Frees memory allocated by rad_alloc() with the same context.
+ * @param ptr Memory to be freed (can be NULL) */
+void rad_free(void *ptr) {
+  const rad_ctx_t *x = rad_ctx_get();
+  if (custom_alloc(x)) {
+    x->free(x->alloc_arg, ptr);
+    return;
+  }
+  default_free(NULL, ptr);
+}
+
+/** @brief Log to sink
+ * @details Formats the message and passes it to the current context's log
+ * sink. It is called by the logging macros (see logger.h), which write the
+ * formatted message to their stream if there is no sink.
+ * @param level Log level
+ * @param msg Output buffer of RAD_LOG_BUFFER_SZ bytes for the message
+ * @param fmt Message format
+ * @return Non-zero if the message is passed to a sink, zero otherwise */
+int rad_log(int level, char *msg, const char *fmt, ...) {
+  const rad_ctx_t *x = rad_ctx_get();
+  va_list ap;
+  va_start(ap, fmt);
+  vsnprintf(msg, RAD_LOG_BUFFER_SZ, fmt, ap);
+  va_end(ap);
+  if (!x->log) {
+    return 0;
+  }
+  x->log(x->log_arg, level, msg);
+  return 1;
+}
@@ -0,0 +1,857 @@
+#include "rad_file.h"
+#include "rad_conf.h"
+
+#include "grid_t.h"
+#include "pmap_t.h"
+#include "rad_ctx.h"
+
+#include "cross_comp.h"
+#include "rad_codec.h"
+
+#include "errno.h"
+#include "limits.h"
+#include "stdarg.h"
+#include "stdbool.h"
+#include "stdint.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "time.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include "unistd.h"
+#if __APPLE__
+#define HOST_NAME_MAX 64
+#define LOGIN_NAME_MAX 256
+#endif /* __APPLE__ */
+#else
+#include "io.h"
+#include "winsock2.h"
+#endif /* __unix__ || __APPLE__ */
+
+#define LM_LEVEL 3
+#include "logger.h"
+
+/** Magic string */
+#define MAGIC "RADSAVE"
+/** Maximum number of sections */
+#define MAX_SECTIONS 16
+/** Maximum length of section names (including the terminating zero) */
+#define NAME_SZ 16
+/** Maximum length of data type names (including the terminating zero) */
+#define DTYPE_SZ 8
+/** Maximum length of meta data values */
+#define VALUE_SZ 1024
+/** Size of the header of encoded sections */
+#define ENC_HEAD_SZ 16
+/** Maximum length of delta chains */
+#define MAX_CHAIN 1024
+
+/** Section structure */
+typedef struct {
+  /** @brief Name */
+  char name[NAME_SZ];
+  /** @brief Data type */
+  char dtype[DTYPE_SZ];
+  /** @brief Number of dimensions */
+  uint32_t ndim;
+  /** @brief Encoding */
+  uint32_t enc;
+  /** @brief Checksum */
+  uint32_t crc;
+  /** @brief Shape */
+  uint64_t shape[2];
+  /** @brief Offset in bytes */
+  uint64_t offset;
+  /** @brief Size in bytes */
+  uint64_t size;
+} section_t;
+
+/** Meta data buffer */
+typedef struct {
+  char *s;
+  size_t len;
+  size_t cap;
+} meta_t;
+
+static void put_u16(uint8_t *p, uint16_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+  for (int i = 0; i < 4; ++i) {
+    p[i] = (uint8_t)(v >> (8 * i));
+  }
+}
+
+static void put_u64(uint8_t *p, uint64_t v) {
+  for (int i = 0; i < 8; ++i) {
+    p[i] = (uint8_t)(v >> (8 * i));
+  }
+}
+
+static uint16_t get_u16(const uint8_t *p) {
+  return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+  uint32_t v = 0;
+  for (int i = 0; i < 4; ++i) {
+    v |= (uint32_t)p[i] << (8 * i);
+  }
+  return v;
+}
+
+static uint64_t get_u64(const uint8_t *p) {
+  uint64_t v = 0;
+  for (int i = 0; i < 8; ++i) {
+    v |= (uint64_t)p[i] << (8 * i);
+  }
+  return v;
+}
+
+static bool little_endian() {
+  const uint16_t one = 1;
+  return *(const uint8_t *)&one == 1;
+}
+
+static void put_f64(uint8_t *p, const double *v, size_t n) {
+  if (little_endian()) {
+    memcpy(p, v, n * sizeof(double));
+    return;
+  }
+  uint64_t bits;
+  for (size_t i = 0; i < n; ++i) {
+    memcpy(&bits, v + i, sizeof(bits));
+    put_u64(p + i * sizeof(bits), bits);
+  }
+}
+
+static void get_f64(double *v, const uint8_t *p, size_t n) {
+  if (little_endian()) {
+    memcpy(v, p, n * sizeof(double));
+    return;
+  }
+  uint64_t bits;
+  for (size_t i = 0; i < n; ++i) {
+    bits = get_u64(p + i * sizeof(bits));
+    memcpy(v + i, &bits, sizeof(bits));
+  }
+}
+
+static uint64_t align_up(uint64_t n) {
+  return (n + RAD_FILE_ALIGN - 1) / RAD_FILE_ALIGN * RAD_FILE_ALIGN;
+}
+
+static void meta_add(meta_t *meta, const char *key, const char *fmt, ...) {
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(NULL, 0, fmt, ap);
+  va_end(ap);
+
+  size_t need = meta->len + strlen(key) + n + 5;
+  if (need > meta->cap) {
+    meta->cap = 2 * need;
+    meta->s = (char *)realloc(meta->s, meta->cap);
+  }
+  meta->len += sprintf(meta->s + meta->len, "%s = ", key);
+  va_start(ap, fmt);
+  meta->len += vsprintf(meta->s + meta->len, fmt, ap);
+  va_end(ap);
+  meta->s[meta->len++] = '\n';
+  meta->s[meta->len] = 0;
+}
+
+static void meta_grid(meta_t *meta, const char *key, const grid_t *g) {
+  meta_add(meta, key, "%d, %.17g, %.17g, %.17g", g->n, g->m, g->M, g->w);
+}
+
+static void meta_init(meta_t *meta, const model_t *m, const sol_t *s) {
+  meta->s = NULL;
+  meta->len = 0;
+  meta->cap = 0;
+
+#if defined(__unix__) || defined(__APPLE__)
+  char hostname[HOST_NAME_MAX] = {0};
+  char username[LOGIN_NAME_MAX] = {0};
+  gethostname(hostname, HOST_NAME_MAX);
+  getlogin_r(username, LOGIN_NAME_MAX);
+#else
+#define INFO_BUFFER_SIZE 32767
+  DWORD bufCharCount = INFO_BUFFER_SIZE;
+  TCHAR hostname[INFO_BUFFER_SIZE] = {0};
+  TCHAR username[INFO_BUFFER_SIZE] = {0};
+
+  GetComputerName(hostname, &bufCharCount);
+  bufCharCount = INFO_BUFFER_SIZE;
+  GetUserName(username, &bufCharCount);
+#undef INFO_BUFFER_SIZE
+#endif
+
+  time_t rawtime;
+  struct tm timeinfo;
+  time(&rawtime);
+  localtime_r(&rawtime, &timeinfo);
+#define ASCTIME_BUFFER_SIZE 26
+  char timestamp[ASCTIME_BUFFER_SIZE];
+  asctime_r(&timeinfo, timestamp);
+  timestamp[strcspn(timestamp, "\n")] = 0;
+#undef ASCTIME_BUFFER_SIZE
+
+  meta_add(meta, "version", "%d.%d.%d", RAD_VERSION_MAJOR, RAD_VERSION_MINOR,
+           RAD_VERSION_PATCH);
+  meta_add(meta, "created", "%s", timestamp);
+  meta_add(meta, "host", "%s", hostname);
+  meta_add(meta, "user", "%s", username);
+
+  meta_add(meta, "alpha", "%.17g", m->alpha);
+  meta_add(meta, "beta", "%.17g", m->beta);
+  meta_add(meta, "delta", "%.17g", m->delta);
+  meta_add(meta, "gamma", "%.17g", m->gamma);
+  meta_add(meta, "R", "%.17g", m->R);
+  meta_add(meta, "util", "%s", m->util.str);
+  meta_add(meta, "cost", "%s", m->cost.str);
+  meta_add(meta, "radt", "%s", m->radt.str);
+  meta_add(meta, "wltt", "%s", m->wltt.str);
+
+  meta_grid(meta, "xg", s->xg);
+  meta_grid(meta, "rg", s->rg);
+  meta_grid(meta, "qg", s->qg);
+  meta_grid(meta, "sg", s->sg);
+  meta_add(meta, "qadp", "%.17g", s->qadp);
+  meta_add(meta, "sadp", "%.17g", s->sadp);
+  meta_add(meta, "maxit", "%d", s->maxit);
+  meta_add(meta, "tol", "%.17g", s->tol);
+  meta_add(meta, "acc", "%.17g", s->acc);
+  meta_add(meta, "it", "%d", s->it);
+  meta_add(meta, "xbeg", "%.17g", s->xbeg);
+  meta_add(meta, "xend", "%.17g", s->xend);
+}
+
+/** Find meta data value
+ * @details Copies the value of the passed key from the meta data text to the
+ * passed buffer. Leading white spaces are removed.
+ * @param meta Meta data text (zero terminated)
+ * @param key Key
+ * @param val Output value buffer of VALUE_SZ bytes
+ * @return Zero on success, non-zero if the key is not found */
+static int meta_find(const char *meta, const char *key, char *val) {
+  size_t kn = strlen(key);
+  for (const char *line = meta; line && *line;
+       line = strchr(line, '\n') ? strchr(line, '\n') + 1 : NULL) {
+    if (strncmp(line, key, kn) != 0) {
+      continue;
+    }
+    const char *p = line + kn;
+    while (*p == ' ' || *p == '\t') {
+      ++p;
+    }
+    if (*p++ != '=') {
+      continue;
+    }
+    while (*p == ' ' || *p == '\t') {
+      ++p;
+    }
+    size_t n = strcspn(p, "\r\n");
+    if (n >= VALUE_SZ) {
+      n = VALUE_SZ - 1;
+    }
+    memcpy(val, p, n);
+    val[n] = 0;
+    return 0;
+  }
+  return -1;
+}
+
+static void set_section(section_t *sec, const char *name, const char *dtype,
+                        int ndim, uint64_t d1, uint64_t d2, uint64_t size) {
+  memset(sec, 0, sizeof(*sec));
+  strncpy(sec->name, name, NAME_SZ - 1);
+  strncpy(sec->dtype, dtype, DTYPE_SZ - 1);
+  sec->ndim = ndim;
+  sec->shape[0] = d1;
+  sec->shape[1] = d2;
+  sec->size = size;
+}
+
+static void put_variable(uint8_t *p, double **const var, short d1, short d2) {
+  for (int i = 0; i < d1; ++i) {
+    put_f64(p + (size_t)i * d2 * sizeof(double), var[i], d2);
+  }
+}
+
+static void get_variable(double **var, const uint8_t *p, short d1, short d2) {
+  for (int i = 0; i < d1; ++i) {
+    get_f64(var[i], p + (size_t)i * d2 * sizeof(double), d2);
+  }
+}
+
+static int write_all(const char *filename, const uint8_t *buf, size_t size) {
+  FILE *fh = fopen(filename, "wb");
+  if (!fh) {
+    LOGE("Failed to open '%s' with errno %d", filename, errno);
+    return -1;
+  }
+  int ec = fwrite(buf, 1, size, fh) != size;
+  ec |= sync_file(fh);
+  ec |= fclose(fh) != 0;
+  if (ec) {
+    LOGE("Failed to write data to file '%s' with errno %d", filename, errno);
+    remove(filename);
+    return -2;
+  }
+  return 0;
+}
+
+/** Encode variable
+ * @details Encodes a variable section (see rad_file.h). The variable's data
+ * are optionally combined with the base variable (see codec_xor()), shuffled
+ * and compressed.
+ * @param var Variable
+ * @param bvar Base variable (NULL for no delta)
+ * @param d1 Number of rows
+ * @param d2 Number of columns
+ * @param size Output size of the encoded section
+ * @return The encoded section (freed by the caller), or NULL if the encoding
+ * does not reduce the section's size */
+static uint8_t *encode_variable(double **const var, double **const bvar,
+                                short d1, short d2, uint64_t *size) {
+  size_t n = (size_t)d1 * d2, sz = n * sizeof(double);
+  uint8_t *raw = (uint8_t *)malloc(sz);
+  uint8_t *tmp = (uint8_t *)malloc(sz);
+  uint8_t *enc = (uint8_t *)malloc(ENC_HEAD_SZ + codec_bound(sz));
+
+  if (!raw || !tmp || !enc) {
+    free(raw);
+    free(tmp);
+    free(enc);
+    return NULL;
+  }
+
+  put_variable(raw, var, d1, d2);
+  put_u64(enc, sz);
+  put_u32(enc + 8, codec_crc32(0, raw, sz));
+  put_u32(enc + 12, 0);
+  if (bvar) {
+    put_variable(tmp, bvar, d1, d2);
+    codec_xor(raw, tmp, sz);
+  }
+  codec_shuffle(tmp, raw, n);
+  *size = ENC_HEAD_SZ + codec_compress(enc + ENC_HEAD_SZ, tmp, sz);
+  free(raw);
+  free(tmp);
+
+  if (*size >= sz) {
+    free(enc);
+    return NULL;
+  }
+  return enc;
+}
+
+/** @brief Save setup file
+ * @details Saves the passed model and solution in a container file (see
+ * rad_file.h) without encoding.
+ * @param m Model
+ * @param s Solution
+ * @param path Save path without extension (e.g. `save/it00100`)
+ * @return Zero on success, non-zero otherwise
+ * @see rad_file_save_enc(), rad_file_load() */
+int rad_file_save(const model_t *m, const sol_t *s, const char *path) {
+  return rad_file_save_enc(m, s, path, RAD_FILE_RAW, NULL, NULL);
+}
+
+/** @brief Save encoded setup file
+ * @details Saves the passed model and solution in a container file (see
+ * rad_file.h). The file is created at the passed path of the current
+ * context's output directory with the RAD_FILE_EXT extension. Missing
+ * directories of the path are created. The file is first written in a hidden
+ * file of the same directory and then it is renamed, replacing any previous
+ * file of the same path.
+ *
+ * The variable sections are encoded with the passed encoding. Delta sections
+ * are encoded against the variables of the passed base solution, which must
+ * have been saved at the passed base path; the base file is needed to load the
+ * file. Sections whose size the encoding does not reduce are stored raw.
+ * @param m Model
+ * @param s Solution
+ * @param path Save path without extension (e.g. `save/it00100`)
+ * @param enc Encoding (RAD_FILE_RAW, RAD_FILE_LZ or RAD_FILE_DELTA)
+ * @param base Base solution of delta sections (can be NULL)
+ * @param base_path Save path of the base solution without extension
+ * @return Zero on success, non-zero otherwise
+ * @see rad_file_load() */
+int rad_file_save_enc(const model_t *m, const sol_t *s, const char *path,
+                      int enc, const sol_t *base, const char *base_path) {
+  char filename[2 * RAD_PATH_BUFFER_SZ], part[2 * RAD_PATH_BUFFER_SZ];
+  const char *sep = strrchr(path, CCM_FILE_SYSTEM_SEP[0]);
+  int dn = sep ? (int)(sep - path) : 0;
+
+  if (sep) {
+    snprintf(filename, sizeof(filename), "%s" CCM_FILE_SYSTEM_SEP "%.*s",
+             rad_temp_dir(), dn, path);
+    mkdirp(filename, 0755);
+    ++dn;
+  }
+  snprintf(filename, sizeof(filename),
+           "%s" CCM_FILE_SYSTEM_SEP "%s" RAD_FILE_EXT, rad_temp_dir(), path);
+  snprintf(part, sizeof(part), "%s" CCM_FILE_SYSTEM_SEP "%.*s.%s" RAD_FILE_EXT,
+           rad_temp_dir(), dn, path, path + dn);
+
+  const short xn = s->xg->n, rn = s->rg->n;
+  bool delta = enc == RAD_FILE_DELTA && base && base->xg->n == xn &&
+               base->rg->n == rn;
+
+  meta_t meta;
+  meta_init(&meta, m, s);
+  if (delta) {
+    meta_add(&meta, "base", "%s", base_path);
+  }
+
+  const grid_t *grids[4] = {s->xg, s->rg, s->qg, s->sg};
+  const char *gnames[4] = {"xg", "rg", "qg", "sg"};
+  double **const vars[4] = {s->v0, s->v1, s->qpol, s->spol};
+  double **const bvars[4] = {delta ? base->v0 : NULL, delta ? base->v1 : NULL,
+                             delta ? base->qpol : NULL,
+                             delta ? base->spol : NULL};
+  const char *vnames[4] = {"v0", "v1", "qpol", "spol"};
+  uint8_t *encoded[4] = {NULL};
+  section_t secs[MAX_SECTIONS];
+  int nsec = 0;
+
+  set_section(&secs[nsec++], "meta", "|u1", 1, meta.len, 0, meta.len);
+  for (int i = 0; i < 4; ++i) {
+    set_section(&secs[nsec++], gnames[i], "<f8", 1, grids[i]->n, 0,
+                grids[i]->n * sizeof(double));
+  }
+  for (int i = 0; i < 4; ++i) {
+    section_t *sec = &secs[nsec++];
+    set_section(sec, vnames[i], "<f8", 2, xn, rn,
+                (uint64_t)xn * rn * sizeof(double));
+    if (enc != RAD_FILE_RAW &&
+        (encoded[i] = encode_variable(vars[i], bvars[i], xn, rn,
+                                      &sec->size)) != NULL) {
+      sec->enc = bvars[i] ? RAD_FILE_DELTA : RAD_FILE_LZ;
+    }
+  }
+
+  uint64_t size = align_up((uint64_t)(1 + nsec) * RAD_FILE_ALIGN);
+  for (int i = 0; i < nsec; ++i) {
+    secs[i].offset = size;
+    size = align_up(size + secs[i].size);
+  }
+
+  uint8_t *buf = (uint8_t *)calloc(size, 1);
+  if (!buf) {
+    LOGE("Failed to allocate %zu bytes for file '%s'", (size_t)size, filename);
+    for (int i = 0; i < 4; ++i) {
+      free(encoded[i]);
+    }
+    free(meta.s);
+    return -1;
+  }
+
+  memcpy(buf + secs[0].offset, meta.s, meta.len);
+  for (int i = 0; i < 4; ++i) {
+    put_f64(buf + secs[1 + i].offset, grids[i]->d, grids[i]->n);
+    if (encoded[i]) {
+      memcpy(buf + secs[5 + i].offset, encoded[i], secs[5 + i].size);
+      free(encoded[i]);
+    } else {
+      put_variable(buf + secs[5 + i].offset, vars[i], xn, rn);
+    }
+  }
+  free(meta.s);
+
+  uint8_t *entry = buf + RAD_FILE_ALIGN;
+  for (int i = 0; i < nsec; ++i, entry += RAD_FILE_ALIGN) {
+    secs[i].crc = codec_crc32(0, buf + secs[i].offset, secs[i].size);
+    memcpy(entry, secs[i].name, NAME_SZ);
+    memcpy(entry + 16, secs[i].dtype, DTYPE_SZ);
+    put_u16(entry + 24, secs[i].ndim);
+    put_u16(entry + 26, secs[i].enc);
+    put_u32(entry + 28, secs[i].crc);
+    put_u64(entry + 32, secs[i].shape[0]);
+    put_u64(entry + 40, secs[i].shape[1]);
+    put_u64(entry + 48, secs[i].offset);
+    put_u64(entry + 56, secs[i].size);
+  }
+
+  memcpy(buf, MAGIC, sizeof(MAGIC));
+  put_u32(buf + 8, RAD_FILE_VERSION);
+  put_u32(buf + 12, nsec);
+  put_u64(buf + 16, size);
+  put_u32(buf + 24,
+          codec_crc32(0, buf + RAD_FILE_ALIGN, (size_t)nsec * RAD_FILE_ALIGN));
+
+  int ec = write_all(part, buf, size);
+  free(buf);
+  if (ec == 0 && (ec = rename_replace(part, filename)) != 0) {
+    LOGE("Failed to rename '%s' with errno %d", part, errno);
+    remove(part);
+  }
+
+  return ec;
+}
+
+/** Find section
+ * @details Locates a section by name and checks its type. If requested, the
+ * section's checksum is verified.
+ * @param buf File data
+ * @param secs Section table
+ * @param nsec Number of sections
+ * @param name Section name
+ * @param dtype Expected data type
+ * @param ndim Expected number of dimensions
+ * @param verify Verify the section's checksum
+ * @return The section on success, NULL otherwise */
+static const section_t *find_section(const uint8_t *buf, const section_t *secs,
+                                     int nsec, const char *name,
+                                     const char *dtype, int ndim, bool verify) {
+  for (int i = 0; i < nsec; ++i) {
+    if (!strcmp(secs[i].name, name)) {
+      if (strcmp(secs[i].dtype, dtype) || (int)secs[i].ndim != ndim) {
+        LOGE("Unexpected type of section '%s'", name);
+        return NULL;
+      }
+      if (verify && codec_crc32(0, buf + secs[i].offset, secs[i].size) !=
+                        secs[i].crc) {
+        LOGE("Corrupted section '%s'", name);
+        return NULL;
+      }
+      return &secs[i];
+    }
+  }
+  LOGE("Missing section '%s'", name);
+  return NULL;
+}
+
+/** Map container
+ * @details Maps the whole file (see map_file()) and validates its header and
+ * section table. The sections' checksums are verified by find_section(), so
+ * that only the accessed pages of the file are read.
+ * @param filename File name
+ * @param pbuf Output file mapping (released by the caller with unmap_file())
+ * @param psize Output file size
+ * @param secs Output section table of MAX_SECTIONS elements
+ * @return The number of sections on success, a negative number otherwise */
+static int map_container(const char *filename, uint8_t **pbuf, size_t *psize,
+                         section_t *secs) {
+  size_t size = 0;
+  uint8_t *buf = (uint8_t *)map_file(filename, &size);
+  if (!buf) {
+    LOGE("Failed to map '%s' with errno %d", filename, errno);
+    return -1;
+  }
+  if (size < RAD_FILE_ALIGN) {
+    LOGE("Truncated file '%s'", filename);
+    unmap_file(buf, size);
+    return -2;
+  }
+
+  int nsec = get_u32(buf + 12);
+  if (memcmp(buf, MAGIC, sizeof(MAGIC)) != 0) {
+    LOGE("File '%s' is not a setup file", filename);
+    nsec = -4;
+  } else if (get_u32(buf + 8) < 1 || get_u32(buf + 8) > RAD_FILE_VERSION) {
+    LOGE("Unsupported version %u of file '%s'", get_u32(buf + 8), filename);
+    nsec = -5;
+  } else if (get_u64(buf + 16) != (uint64_t)size || nsec > MAX_SECTIONS ||
+             (uint64_t)(1 + nsec) * RAD_FILE_ALIGN > (uint64_t)size ||
+             get_u32(buf + 24) != codec_crc32(0, buf + RAD_FILE_ALIGN,
+                                              (size_t)nsec * RAD_FILE_ALIGN)) {
+    LOGE("Corrupted header in file '%s'", filename);
+    nsec = -6;
+  }
+
+  const uint8_t *entry = buf + RAD_FILE_ALIGN;
+  for (int i = 0; i < nsec; ++i, entry += RAD_FILE_ALIGN) {
+    memcpy(secs[i].name, entry, NAME_SZ);
+    secs[i].name[NAME_SZ - 1] = 0;
+    memcpy(secs[i].dtype, entry + 16, DTYPE_SZ);
+    secs[i].dtype[DTYPE_SZ - 1] = 0;
+    secs[i].ndim = get_u16(entry + 24);
+    secs[i].enc = get_u16(entry + 26);
+    secs[i].crc = get_u32(entry + 28);
+    secs[i].shape[0] = get_u64(entry + 32);
+    secs[i].shape[1] = get_u64(entry + 40);
+    secs[i].offset = get_u64(entry + 48);
+    secs[i].size = get_u64(entry + 56);
+    if (secs[i].offset % RAD_FILE_ALIGN || secs[i].offset > (uint64_t)size ||
+        secs[i].size > (uint64_t)size - secs[i].offset ||
+        secs[i].enc > RAD_FILE_DELTA) {
+      LOGE("Corrupted section '%s' in file '%s'", secs[i].name, filename);
+      nsec = -7;
+    }
+  }
+
+  if (nsec < 0) {
+    unmap_file(buf, size);
+    return nsec;
+  }
+  *pbuf = buf;
+  *psize = size;
+  return nsec;
+}
+
+/** Read meta data
+ * @param buf File data
+ * @param secs Section table
+ * @param nsec Number of sections
+ * @return The zero-terminated meta data text (freed by the caller), or NULL if
+ * the meta data section is missing or corrupted */
+static char *read_meta(const uint8_t *buf, const section_t *secs, int nsec) {
+  const section_t *sec = find_section(buf, secs, nsec, "meta", "|u1", 1, true);
+  char *meta = sec ? (char *)malloc(sec->size + 1) : NULL;
+  if (meta) {
+    memcpy(meta, buf + sec->offset, sec->size);
+    meta[sec->size] = 0;
+  }
+  return meta;
+}
+
+static int load_section(const char *path, const char *name, uint8_t *out,
+                        uint64_t size, int depth);
+
+/** Decode section
+ * @details Decodes a variable section to its raw, little-endian data. Delta
+ * sections are combined with the same section of the base file, which is
+ * decoded recursively. The checksum of the decoded data is verified.
+ * @param buf File data
+ * @param sec Section
+ * @param meta File's meta data
+ * @param out Output buffer of the section's raw size
+ * @param depth Length of the delta chain so far
+ * @return Zero on success, non-zero otherwise */
+static int decode_section(const uint8_t *buf, const section_t *sec,
+                          const char *meta, uint8_t *out, int depth) {
+  const uint8_t *p = buf + sec->offset;
+  uint64_t size = sec->shape[0] * sec->shape[1] * sizeof(double);
+  char val[VALUE_SZ];
+
+  if (sec->enc == RAD_FILE_RAW) {
+    if (sec->size != size) {
+      return -1;
+    }
+    memcpy(out, p, size);
+    return 0;
+  }
+  if (sec->size < ENC_HEAD_SZ || get_u64(p) != size) {
+    return -1;
+  }
+
+  uint8_t *tmp = (uint8_t *)malloc(size);
+  int ec = !tmp || codec_decompress(tmp, size, p + ENC_HEAD_SZ,
+                                    sec->size - ENC_HEAD_SZ) != 0;
+  if (!ec) {
+    codec_unshuffle(out, tmp, size / sizeof(double));
+  }
+  if (!ec && sec->enc == RAD_FILE_DELTA) {
+    ec = meta_find(meta, "base", val) ||
+         load_section(val, sec->name, tmp, size, depth + 1);
+    if (!ec) {
+      codec_xor(out, tmp, size);
+    }
+  }
+  free(tmp);
+
+  if (!ec && codec_crc32(0, out, size) != get_u32(p + 8)) {
+    ec = -2;
+  }
+  return ec ? -1 : 0;
+}
+
+/** Load section
+ * @details Loads and decodes a variable section of another container file.
+ * It is used to resolve the bases of delta sections.
+ * @param path Save path without extension
+ * @param name Section name
+ * @param out Output buffer
+ * @param size Expected raw size of the section
+ * @param depth Length of the delta chain so far
+ * @return Zero on success, non-zero otherwise */
+static int load_section(const char *path, const char *name, uint8_t *out,
+                        uint64_t size, int depth) {
+  char filename[2 * RAD_PATH_BUFFER_SZ];
+  uint8_t *buf = NULL;
+  size_t bsize = 0;
+  section_t secs[MAX_SECTIONS];
+
+  if (depth > MAX_CHAIN) {
+    LOGE("Delta chain of '%s' is too long", path);
+    return -1;
+  }
+  int len = snprintf(filename, sizeof(filename),
+                     "%s" CCM_FILE_SYSTEM_SEP "%s" RAD_FILE_EXT, rad_temp_dir(),
+                     path);
+  if (len < 0 || (size_t)len >= sizeof(filename)) {
+    LOGE("Base path '%s' is too long", path);
+    return -1;
+  }
+  int nsec = map_container(filename, &buf, &bsize, secs);
+  if (nsec < 0) {
+    return nsec;
+  }
+
+  char *meta = read_meta(buf, secs, nsec);
+  const section_t *sec =
+      find_section(buf, secs, nsec, name, "<f8", 2, RAD_FILE_VERIFY);
+  int ec = -1;
+  if (meta && sec && sec->shape[0] * sec->shape[1] * sizeof(double) == size) {
+    ec = decode_section(buf, sec, meta, out, depth);
+  }
+  free(meta);
+  unmap_file(buf, bsize);
+
+  return ec;
+}
+
+/** @brief Load setup file
+ * @details Loads a model and a solution from a container file created by
+ * rad_file_save(). The model and the solution are initialized from the file's
+ * meta data, as if they were initialized by model_init() and solution_init(),
+ * and then the saved grids and solver state are restored. The file's header,
+ * meta data and grids are verified before they are used.
+ *
+ * The file is mapped into memory and raw approximation variables are not read.
+ * On little-endian hosts, the solution's variable rows point directly into a
+ * private, copy-on-write mapping of the file; pages are read when they are
+ * first accessed and copied when they are first written. Thus, the loading
+ * time does not depend on the grid sizes. The mapping is released by
+ * solution_reset() and solution_free(). The checksums of the variables are
+ * verified only if RAD_FILE_VERIFY is true, since the verification reads the
+ * whole file. Encoded variables (see rad_file_save_enc()) are decoded into the
+ * solution's memory arena; the base files of delta sections are loaded as
+ * needed and the decoded data are always verified.
+ *
+ * The model's functional specification is given by the passed objective
+ * parts. A warning is logged if it differs from the saved one. On failure, the
+ * solution is left uninitialized.
+ * @param m Uninitialized model
+ * @param s Uninitialized solution
+ * @param path Save path without extension, relative to the current context's
+ * output directory
+ * @param objparts Model's functional specification
+ * @return Zero on success, non-zero otherwise
+ * @see rad_file_save() */
+int rad_file_load(model_t *m, sol_t *s, const char *path,
+                  const objpart_t *objparts) {
+  char filename[2 * RAD_PATH_BUFFER_SZ];
+  char val[VALUE_SZ];
+  uint8_t *buf = NULL;
+  size_t size = 0;
+  section_t secs[MAX_SECTIONS];
+
+  snprintf(filename, sizeof(filename),
+           "%s" CCM_FILE_SYSTEM_SEP "%s" RAD_FILE_EXT, rad_temp_dir(), path);
+  int nsec = map_container(filename, &buf, &size, secs);
+  if (nsec < 0) {
+    return nsec;
+  }
+
+  char *meta = read_meta(buf, secs, nsec);
+  if (!meta) {
+    unmap_file(buf, size);
+    return -8;
+  }
+
+  const char *keys[] = {"alpha", "beta", "delta", "gamma", "R",
+                        "xg",    "rg",   "qg",    "sg",    "qadp",
+                        "sadp",  "maxit", "tol"};
+  pmap_t pmap = {.p = NULL, .n = 0};
+  for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); ++i) {
+    if (meta_find(meta, keys[i], val) != 0) {
+      LOGE("Missing key '%s' in file '%s'", keys[i], filename);
+      pmap_free(&pmap);
+      free(meta);
+      unmap_file(buf, size);
+      return -8;
+    }
+    pmap_add(&pmap, keys[i], val);
+  }
+  model_init(m, &pmap, objparts);
+  solution_init(s, &pmap);
+  pmap_free(&pmap);
+
+  const char *parts[4] = {"util", "cost", "radt", "wltt"};
+  for (int i = 0; i < 4; ++i) {
+    if (meta_find(meta, parts[i], val) == 0 && strcmp(val, objparts[i].str)) {
+      LOGW("Saved %s specification differs in file '%s'", parts[i], filename);
+    }
+  }
+#define ifmeta(v, c)                                                           \
+  if (meta_find(meta, #v, val) == 0) {                                         \
+    s->v = c(val);                                                             \
+  }
+  ifmeta(acc, atof);
+  ifmeta(it, atoi);
+  ifmeta(xbeg, atof);
+  ifmeta(xend, atof);
+#undef ifmeta
+
+  int ec = 0;
+  grid_t *grids[4] = {s->xg, s->rg, s->qg, s->sg};
+  const char *gnames[4] = {"xg", "rg", "qg", "sg"};
+  for (int i = 0; i < 4 && ec == 0; ++i) {
+    const section_t *sec =
+        find_section(buf, secs, nsec, gnames[i], "<f8", 1, true);
+    if (!sec || sec->shape[0] != (uint64_t)grids[i]->n ||
+        sec->size != grids[i]->n * sizeof(double)) {
+      ec = -9;
+    } else {
+      get_f64(grids[i]->d, buf + sec->offset, grids[i]->n);
+    }
+  }
+
+  const short xn = s->xg->n, rn = s->rg->n;
+  const uint64_t vsz = (uint64_t)xn * rn * sizeof(double);
+  double **vars[4] = {s->v0, s->v1, s->qpol, s->spol};
+  const char *vnames[4] = {"v0", "v1", "qpol", "spol"};
+  const section_t *vsecs[4] = {NULL};
+  bool mappable = little_endian();
+  for (int i = 0; i < 4 && ec == 0; ++i) {
+    vsecs[i] =
+        find_section(buf, secs, nsec, vnames[i], "<f8", 2, RAD_FILE_VERIFY);
+    if (!vsecs[i] || vsecs[i]->shape[0] != (uint64_t)xn ||
+        vsecs[i]->shape[1] != (uint64_t)rn ||
+        (vsecs[i]->enc == RAD_FILE_RAW && vsecs[i]->size != vsz)) {
+      ec = -10;
+    } else if (vsecs[i]->enc != RAD_FILE_RAW) {
+      mappable = false;
+    }
+  }
+
+  if (mappable && ec == 0) {
+    // The rows of each variable remain contiguous, as in the memory arena
+    for (int i = 0; i < 4; ++i) {
+      double *data = (double *)(buf + vsecs[i]->offset);
+      for (int j = 0; j < xn; ++j) {
+        vars[i][j] = data + (size_t)j * rn;
+      }
+    }
+    s->map = buf;
+    s->map_sz = size;
+    free(meta);
+    return 0;
+  }
+
+  // Encoded sections are decoded into the memory arena
+  uint8_t *raw = ec == 0 ? (uint8_t *)malloc(vsz) : NULL;
+  for (int i = 0; i < 4 && ec == 0; ++i) {
+    if (!raw || decode_section(buf, vsecs[i], meta, raw, 0) != 0) {
+      LOGE("Failed to decode section '%s'", vnames[i]);
+      ec = -11;
+    } else {
+      get_variable(vars[i], raw, xn, rn);
+    }
+  }
+  free(raw);
+  free(meta);
+  unmap_file(buf, size);
+
+  if (ec) {
+    LOGE("Invalid grid or variable sections in file '%s'", filename);
+    solution_free(s);
+  }
+  return ec;
+}
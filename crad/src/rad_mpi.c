@@ -0,0 +1,92 @@
+#include "rad_mpi.h"
+#include "rad_conf.h"
+
+#include "stdlib.h"
+
+#if RAD_MPI
+#include "mpi.h"
+
+/** Finalize communication at process exit */
+static void finalize(void) { MPI_Finalize(); }
+
+/** @brief Initialize communication
+ * @details Initializes MPI once per process, unless it is already initialized
+ * by the caller. MPI initialized here is finalized at process exit, so that
+ * the setups of a process, e.g. the sweep points of rad_pardep, share it.
+ * Only the main thread of a rank communicates.
+ * @param rank Output rank of the process
+ * @param size Output number of ranks
+ * @return Zero on success, non-zero otherwise */
+int rad_mpi_init(int *rank, int *size) {
+  int flag = 0, provided = 0;
+  MPI_Finalized(&flag);
+  if (flag) {
+    return -1;
+  }
+  MPI_Initialized(&flag);
+  if (!flag) {
+    if (MPI_Init_thread(NULL, NULL, MPI_THREAD_FUNNELED, &provided) !=
+        MPI_SUCCESS) {
+      return -1;
+    }
+    atexit(finalize);
+  }
+  MPI_Comm_rank(MPI_COMM_WORLD, rank);
+  MPI_Comm_size(MPI_COMM_WORLD, size);
+  return 0;
+}
+
+/** @brief Global maxima
+ * @details Replaces the passed values with their maxima over all ranks.
+ * @param vals Values
+ * @param n Number of values */
+void rad_mpi_max(double *vals, int n) {
+  MPI_Allreduce(MPI_IN_PLACE, vals, n, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+}
+
+/** @brief Exchange parts
+ * @details Every rank sends its part of the array to all other ranks.
+ * @param data Array (in place)
+ * @param counts Part sizes of the ranks
+ * @param displs Part offsets of the ranks */
+void rad_mpi_allgather(double *data, const int *counts, const int *displs) {
+  MPI_Allgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, data, counts, displs,
+                 MPI_DOUBLE, MPI_COMM_WORLD);
+}
+
+/** @brief Collect parts
+ * @details Every rank sends its part of the array to rank zero.
+ * @param data Array (in place)
+ * @param counts Part sizes of the ranks
+ * @param displs Part offsets of the ranks */
+void rad_mpi_gather(double *data, const int *counts, const int *displs) {
+  int rank = 0;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  if (rank == 0) {
+    MPI_Gatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, data, counts, displs,
+                MPI_DOUBLE, 0, MPI_COMM_WORLD);
+  } else {
+    MPI_Gatherv(data + displs[rank], counts[rank], MPI_DOUBLE, NULL, NULL,
+                NULL, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+  }
+}
+
+#else
+
+int rad_mpi_init(int *rank, int *size) {
+  *rank = 0;
+  *size = 1;
+  return 0;
+}
+
+void rad_mpi_max(double *vals, int n) { (void)vals, (void)n; }
+
+void rad_mpi_allgather(double *data, const int *counts, const int *displs) {
+  (void)data, (void)counts, (void)displs;
+}
+
+void rad_mpi_gather(double *data, const int *counts, const int *displs) {
+  (void)data, (void)counts, (void)displs;
+}
+
+#endif /* RAD_MPI */
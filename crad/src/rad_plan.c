@@ -0,0 +1,756 @@
+#include "rad_plan.h"
+
+#include "cross_comp.h"
+#include "grid_t.h"
+#include "pmap_t.h"
+#include "rad_codec.h"
+#include "rad_ctx.h"
+
+#include "ctype.h"
+#include "errno.h"
+#include "math.h"
+#include "stdlib.h"
+#include "string.h"
+
+#define LM_LEVEL 3
+#include "logger.h"
+
+/** Manifest format version */
+#define MANIFEST_VERSION 1
+/** Manifest line buffer size */
+#define LINE_SZ (PLAN_MAX_DIMS * PLAN_VALUE_SZ + 64)
+
+/** Names of the designs */
+static const char *designs[3] = {"product", "lhs", "list"};
+/** Names of the point events */
+static const char *events[5] = {"pending", "start", "halted", "failed",
+                                "done"};
+
+/** Dimension structure */
+typedef struct {
+  /** @brief Values of a list or a grid (NULL for a Latin hypercube) */
+  char (*vals)[PLAN_VALUE_SZ];
+  /** @brief Number of values */
+  int n;
+  /** @brief Lower bound of a Latin hypercube */
+  double m;
+  /** @brief Upper bound of a Latin hypercube */
+  double M;
+  /** @brief Weighting exponent of a Latin hypercube */
+  double w;
+} dim_t;
+
+/** Trim
+ * @details Copies the passed string without leading and trailing white space.
+ * @param dest Output buffer
+ * @param src String
+ * @param n Number of characters of the string to copy
+ * @param sz Size of the output buffer
+ * @return Zero on success, non-zero if the string is truncated */
+static int trim(char *dest, const char *src, size_t n, size_t sz) {
+  while (n > 0 && isspace((unsigned char)*src)) {
+    ++src, --n;
+  }
+  while (n > 0 && isspace((unsigned char)src[n - 1])) {
+    --n;
+  }
+  snprintf(dest, sz, "%.*s", (int)n, src);
+  return n >= sz;
+}
+
+/** Parse number
+ * @return Non-zero if the whole string is a number */
+static int parse_number(const char *s, double *v) {
+  char *end;
+  *v = strtod(s, &end);
+  return end != s && *end == 0;
+}
+
+/** Parse dimension
+ * @details Splits a list at the semicolons, evaluates a grid specification or
+ * parses the bounds of a Latin hypercube dimension.
+ * @param d Output dimension
+ * @param spec Trimmed specification
+ * @param design Design of the plan
+ * @return Zero on success, non-zero otherwise */
+static int parse_dim(dim_t *d, const char *spec, int design) {
+  memset(d, 0, sizeof(*d));
+  if (strchr(spec, ';')) {
+    d->vals = (char(*)[PLAN_VALUE_SZ])malloc(
+        (strlen(spec) / 2 + 1) * sizeof(*d->vals));
+    for (const char *s = spec, *e; s; s = e ? e + 1 : NULL) {
+      e = strchr(s, ';');
+      trim(d->vals[d->n], s, e ? (size_t)(e - s) : strlen(s), PLAN_VALUE_SZ);
+      d->n += d->vals[d->n][0] != 0;
+    }
+    return design == PLAN_LHS || d->n == 0;
+  }
+  if (design == PLAN_LHS) {
+    d->w = 1;
+    return sscanf(spec, "%lf , %lf , %lf", &d->m, &d->M, &d->w) < 2 ||
+           !(d->M > d->m) || !(d->w > 0);
+  }
+
+  int n = 0;
+  grid_t g;
+  if (sscanf(spec, "%d", &n) != 1 || n < 1) {
+    return -1;
+  }
+  if (n == 1) {
+    // A single point is the grid's lower bound
+    double m = 0;
+    sscanf(spec, "%*d , %lf", &m);
+    grid_init(&g, 2, m, m + 1, 1);
+  } else {
+    grid_init_str(&g, spec);
+  }
+  d->n = n;
+  d->vals = (char(*)[PLAN_VALUE_SZ])malloc(n * sizeof(*d->vals));
+  for (int i = 0; i < n; ++i) {
+    snprintf(d->vals[i], PLAN_VALUE_SZ, "%.17g", g.d[i]);
+  }
+  grid_free(&g);
+  return 0;
+}
+
+/** Next random number
+ * @details The splitmix64 generator, so that Latin hypercube samples are
+ * reproducible on all platforms.
+ * @param x Generator state
+ * @return A uniform random number in [0, 1) */
+static double next_uniform(uint64_t *x) {
+  uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return (double)((z ^ (z >> 31)) >> 11) * 0x1.0p-53;
+}
+
+/** Generate points
+ * @param p Plan with the keys and the design
+ * @param dims Dimensions
+ * @param samples Number of Latin hypercube points
+ * @param seed Latin hypercube seed
+ * @return Zero on success, non-zero otherwise */
+static int generate(plan_t *p, const dim_t *dims, int samples, uint64_t seed) {
+  long n = p->design == PLAN_LHS ? samples : 1;
+
+  for (int d = 0; d < p->nd; ++d) {
+    if (p->design == PLAN_PRODUCT) {
+      n *= dims[d].n;
+    } else if (p->design == PLAN_LIST && dims[d].n != dims[0].n) {
+      LOGE("Lists of sweep '%s' differ in length", p->name);
+      return -1;
+    } else if (p->design == PLAN_LIST) {
+      n = dims[0].n;
+    }
+    if (n > PLAN_MAX_POINTS) {
+      break;
+    }
+  }
+  if (n > PLAN_MAX_POINTS) {
+    LOGE("Sweep '%s' exceeds %d points", p->name, PLAN_MAX_POINTS);
+    return -2;
+  }
+  if (n < 1) {
+    LOGE("Sweep '%s' has no points", p->name);
+    return -3;
+  }
+
+  p->n = (int)n;
+  p->vals = (char *)calloc((size_t)p->n * p->nd, PLAN_VALUE_SZ);
+  p->coords = (double *)malloc((size_t)p->n * p->nd * sizeof(double));
+  p->status = (int *)calloc(p->n, sizeof(int));
+  int *perm = (int *)malloc(p->n * sizeof(int));
+  for (int d = p->nd - 1, stride = 1; d >= 0; --d) {
+    const dim_t *dim = &dims[d];
+    if (p->design == PLAN_LHS) {
+      // Every stratum of every dimension holds one point
+      for (int i = 0; i < p->n; ++i) {
+        perm[i] = i;
+      }
+      for (int i = p->n - 1; i > 0; --i) {
+        int k = (int)(next_uniform(&seed) * (i + 1)), t = perm[i];
+        perm[i] = perm[k];
+        perm[k] = t;
+      }
+    }
+    p->numeric[d] = true;
+    for (int i = 0; i < p->n; ++i) {
+      char *val = p->vals + ((size_t)i * p->nd + d) * PLAN_VALUE_SZ;
+      double *c = &p->coords[(size_t)i * p->nd + d];
+      int k = p->design == PLAN_PRODUCT ? i / stride % dim->n : i;
+      if (p->design == PLAN_LHS) {
+        double u = (perm[i] + next_uniform(&seed)) / p->n;
+        snprintf(val, PLAN_VALUE_SZ, "%.17g",
+                 dim->m + (dim->M - dim->m) * pow(u, dim->w));
+      } else {
+        snprintf(val, PLAN_VALUE_SZ, "%s", dim->vals[k]);
+      }
+      if (!parse_number(val, c)) {
+        p->numeric[d] = false;
+      }
+    }
+    for (int i = 0; i < p->n && !p->numeric[d]; ++i) {
+      // Values that are not numbers are located by their list index
+      p->coords[(size_t)i * p->nd + d] =
+          p->design == PLAN_PRODUCT ? i / stride % dim->n : i;
+    }
+    double lo = INFINITY, hi = -INFINITY;
+    for (int i = 0; i < p->n; ++i) {
+      lo = fmin(lo, p->coords[(size_t)i * p->nd + d]);
+      hi = fmax(hi, p->coords[(size_t)i * p->nd + d]);
+    }
+    p->span[d] = hi > lo ? hi - lo : 1;
+    stride *= p->design == PLAN_PRODUCT ? dim->n : 1;
+  }
+  free(perm);
+  return 0;
+}
+
+/** Add point
+ * @details Appends a point to a one-dimensional plan.
+ * @param p Plan
+ * @param val Value
+ * @param c Coordinate */
+static void add_point(plan_t *p, const char *val, double c) {
+  p->vals = (char *)realloc(p->vals, (size_t)(p->n + 1) * PLAN_VALUE_SZ);
+  p->coords = (double *)realloc(p->coords, (p->n + 1) * sizeof(double));
+  p->status = (int *)realloc(p->status, (p->n + 1) * sizeof(int));
+  snprintf(p->vals + (size_t)p->n * PLAN_VALUE_SZ, PLAN_VALUE_SZ, "%s", val);
+  p->coords[p->n] = c;
+  p->status[p->n++] = PLAN_PENDING;
+}
+
+/** Manifest file name */
+static void manifest_name(const plan_t *p, char *filename, size_t sz) {
+  snprintf(filename, sz, "%s" CCM_FILE_SYSTEM_SEP "%s" RAD_MANIFEST_EXT,
+           rad_temp_dir(), p->name);
+}
+
+/** Read manifest
+ * @details Reads the point states of a manifest that matches the plan's
+ * specification. The plan is fresh if the manifest does not exist or does not
+ * match.
+ * @param p Plan */
+static void read_manifest(plan_t *p) {
+  char filename[2 * RAD_PATH_BUFFER_SZ];
+  char *line = (char *)malloc(LINE_SZ), val[PLAN_VALUE_SZ];
+  unsigned spec = 0;
+  int n = -1, i, it, pos;
+  double c;
+
+  p->fresh = true;
+  manifest_name(p, filename, sizeof(filename));
+  FILE *fh = fopen(filename, "r");
+  if (!fh) {
+    free(line);
+    return;
+  }
+  while (fgets(line, LINE_SZ, fh)) {
+    size_t len = strlen(line);
+    if (len == 0 || line[len - 1] != '\n') {
+      // A torn last line is ignored
+      continue;
+    }
+    if (sscanf(line, "spec = %x", &spec) == 1 ||
+        sscanf(line, "points = %d", &n) == 1) {
+      p->fresh = spec != p->spec || (n >= 0 && n != p->n);
+      continue;
+    }
+    if (p->fresh) {
+      continue;
+    }
+    for (int s = PLAN_STARTED; s < PLAN_DONE; ++s) {
+      size_t el = strlen(events[s]);
+      if (strncmp(line, events[s], el) == 0 && line[el] == ' ' &&
+          sscanf(line + el, "%d %d", &i, &it) >= 1 && i >= 0 && i < p->n) {
+        p->status[i] = s;
+      }
+    }
+    pos = 0;
+    if (p->nd == 1 && p->numeric[0] && p->n < PLAN_MAX_POINTS &&
+        sscanf(line, "point %d =%n", &i, &pos) == 1 && pos > 0 && i == p->n) {
+      // A point that is inserted by the refinement (see plan_refine())
+      trim(val, line + pos, strlen(line + pos), PLAN_VALUE_SZ);
+      if (parse_number(val, &c)) {
+        add_point(p, val, c);
+      }
+    }
+  }
+  fclose(fh);
+  free(line);
+  if (p->fresh) {
+    LOGI("Sweep '%s' does not match its manifest, starting over", p->name);
+  }
+}
+
+/** Mark stored points
+ * @details Marks the points of the plan's sweep store as done. */
+static void read_store(plan_t *p) {
+  double *values = NULL;
+  int *its = NULL, done = 0;
+  int count = sweep_index(p->name, &values, &its);
+
+  for (int k = 0; k < count; ++k) {
+    int i = plan_find(p, values[k]);
+    if (i >= 0 && p->status[i] != PLAN_DONE) {
+      p->status[i] = PLAN_DONE;
+      ++done;
+    }
+  }
+  free(values);
+  free(its);
+  LOGI("Sweep '%s' has %d of %d points done", p->name, done, p->n);
+}
+
+/** @brief Initialize plan
+ * @details Reads the specification of the named sweep from the passed
+ * parameter map (see rad_plan.h), generates its points and, if the manifest in
+ * the output directory matches the specification, the states of the points.
+ * @param p Uninitialized plan
+ * @param pmap Parameter map
+ * @param name Sweep name
+ * @return Zero on success, non-zero if the specification is invalid */
+int plan_init(plan_t *p, const pmap_t *pmap, const char *name) {
+  char key[PLAN_KEY_SZ], spec[PLAN_VALUE_SZ];
+  dim_t dims[PLAN_MAX_DIMS];
+  size_t nl = strlen(name);
+  int samples = 0, ec = 0;
+  uint64_t seed = 0;
+  const char *val;
+
+  memset(p, 0, sizeof(*p));
+  snprintf(p->name, SWEEP_NAME_SZ, "%s", name);
+  snprintf(key, PLAN_KEY_SZ, "%s.design", name);
+  if ((val = pmap_find(pmap, key))) {
+    trim(spec, val, strlen(val), PLAN_VALUE_SZ);
+    for (p->design = 0; p->design < 3; ++p->design) {
+      if (!strcmp(spec, designs[p->design])) {
+        break;
+      }
+    }
+    if (p->design == 3) {
+      LOGE("Unknown design '%s' of sweep '%s'", spec, name);
+      return -1;
+    }
+  }
+  snprintf(key, PLAN_KEY_SZ, "%s.samples", name);
+  samples = (val = pmap_find(pmap, key)) ? atoi(val) : 0;
+  snprintf(key, PLAN_KEY_SZ, "%s.seed", name);
+  seed = (val = pmap_find(pmap, key)) ? strtoull(val, NULL, 10) : 0;
+  // The refinement settings do not invalidate the solved points
+  snprintf(key, PLAN_KEY_SZ, "%s.refine", name);
+  p->refine = (val = pmap_find(pmap, key)) ? atof(val) : 0;
+  snprintf(key, PLAN_KEY_SZ, "%s.budget", name);
+  p->budget = (val = pmap_find(pmap, key)) ? atoi(val) : 0;
+
+  // The specification's checksum covers the design and the dimensions
+  p->spec = codec_crc32(0, (const uint8_t *)designs[p->design],
+                        strlen(designs[p->design]));
+  if (p->design == PLAN_LHS) {
+    uint8_t lhs[16];
+    memcpy(lhs, &seed, 8);
+    memcpy(lhs + 8, &samples, sizeof(samples));
+    p->spec = codec_crc32(p->spec, lhs, 8 + sizeof(samples));
+  }
+  for (int i = 0; i < pmap->n && ec == 0; ++i) {
+    const char *k = pmap_gkey(pmap, i);
+    if (strncmp(k, name, nl) || k[nl] != '.' || !strcmp(k + nl, ".design") ||
+        !strcmp(k + nl, ".samples") || !strcmp(k + nl, ".seed") ||
+        !strcmp(k + nl, ".refine") || !strcmp(k + nl, ".budget")) {
+      continue;
+    }
+    if (p->nd == PLAN_MAX_DIMS) {
+      LOGE("Sweep '%s' exceeds %d dimensions", name, PLAN_MAX_DIMS);
+      ec = -2;
+      break;
+    }
+    snprintf(p->keys[p->nd], PLAN_KEY_SZ, "%s", k + nl + 1);
+    val = pmap_gvalue(pmap, i);
+    trim(spec, val, strlen(val), PLAN_VALUE_SZ);
+    ec = parse_dim(&dims[p->nd++], spec, p->design);
+    if (ec) {
+      LOGE("Invalid dimension '%s' of sweep '%s'", k, name);
+    }
+    p->spec = codec_crc32(p->spec, (const uint8_t *)k, strlen(k));
+    p->spec = codec_crc32(p->spec, (const uint8_t *)spec, strlen(spec));
+  }
+  snprintf(key, PLAN_KEY_SZ, "%sg", name);
+  if (ec == 0 && p->nd == 0 && p->design == PLAN_PRODUCT &&
+      (val = pmap_find(pmap, key))) {
+    // One-dimensional sweep of a grid specification
+    snprintf(p->keys[0], PLAN_KEY_SZ, "%s", name);
+    trim(spec, val, strlen(val), PLAN_VALUE_SZ);
+    if ((ec = parse_dim(&dims[p->nd++], spec, p->design))) {
+      LOGE("Invalid grid specification '%s'", key);
+    }
+    p->spec = codec_crc32(p->spec, (const uint8_t *)key, strlen(key));
+    p->spec = codec_crc32(p->spec, (const uint8_t *)spec, strlen(spec));
+  }
+  for (int d = 0; d < p->nd && ec == 0; ++d) {
+    if (!strcmp(p->keys[d], "xg") || !strcmp(p->keys[d], "rg")) {
+      LOGE("The grids of sweep '%s' are stored and cannot be swept", name);
+      ec = -3;
+    }
+  }
+  if (ec == 0 && p->nd == 0) {
+    LOGE("Sweep '%s' has no dimensions", name);
+    ec = -4;
+  }
+  if (ec == 0) {
+    ec = generate(p, dims, samples, seed);
+  }
+  for (int d = 0; d < p->nd; ++d) {
+    free(dims[d].vals);
+  }
+  if (ec) {
+    plan_free(p);
+    return ec;
+  }
+  if (p->refine > 0 && !(p->nd == 1 && p->numeric[0])) {
+    LOGW("Sweep '%s' is not refined, since it has several dimensions or "
+         "values that are not numbers",
+         name);
+    p->refine = 0;
+  }
+  if (p->budget <= 0) {
+    p->budget = p->n < PLAN_MAX_POINTS / PLAN_BUDGET ? PLAN_BUDGET * p->n
+                                                     : PLAN_MAX_POINTS;
+  }
+  p->budget = p->budget < PLAN_MAX_POINTS ? p->budget : PLAN_MAX_POINTS;
+
+  read_manifest(p);
+  if (!p->fresh) {
+    read_store(p);
+  }
+  return 0;
+}
+
+/** @brief Parameter name of the store
+ * @param p Plan
+ * @return The swept key of a one-dimensional numeric sweep, `point`
+ * otherwise */
+const char *plan_param(const plan_t *p) {
+  return p->nd == 1 && p->numeric[0] ? p->keys[0] : "point";
+}
+
+/** @brief Stored parameter value
+ * @param p Plan
+ * @param i Point index
+ * @return The swept value of a one-dimensional numeric sweep, the point index
+ * otherwise (see plan_param()) */
+double plan_value(const plan_t *p, int i) {
+  return p->nd == 1 && p->numeric[0] ? p->coords[i] : i;
+}
+
+/** @brief Point distance
+ * @param p Plan
+ * @param i Point index
+ * @param k Point index
+ * @return The Euclidean distance of the points' coordinates, each one relative
+ * to its dimension's range */
+double plan_distance(const plan_t *p, int i, int k) {
+  double s = 0;
+  for (int d = 0; d < p->nd; ++d) {
+    double t = (p->coords[(size_t)i * p->nd + d] -
+                p->coords[(size_t)k * p->nd + d]) /
+               p->span[d];
+    s += t * t;
+  }
+  return sqrt(s);
+}
+
+/** @brief Stored value distance
+ * @details Similar to plan_distance(), but the second point is given by its
+ * stored parameter value, which may be one of a previous plan.
+ * @param p Plan
+ * @param i Point index
+ * @param value Stored parameter value (see plan_value())
+ * @return The distance, or infinity if the value is not a point of the plan */
+double plan_gap(const plan_t *p, int i, double value) {
+  if (p->nd == 1 && p->numeric[0]) {
+    return fabs(p->coords[i] - value) / p->span[0];
+  }
+  int k = plan_find(p, value);
+  return k < 0 ? INFINITY : plan_distance(p, i, k);
+}
+
+/** @brief Find point
+ * @param p Plan
+ * @param value Stored parameter value (see plan_value())
+ * @return The index of the point, or -1 if there is no such point */
+int plan_find(const plan_t *p, double value) {
+  if (p->nd == 1 && p->numeric[0]) {
+    for (int i = 0; i < p->n; ++i) {
+      if (p->coords[i] == value) {
+        return i;
+      }
+    }
+    return -1;
+  }
+  return value >= 0 && value < p->n && value == floor(value) ? (int)value : -1;
+}
+
+/** @brief Apply point
+ * @details Sets the values of the point's keys in the passed parameter map.
+ * @param p Plan
+ * @param i Point index
+ * @param pmap Parameter map */
+void plan_apply(const plan_t *p, int i, pmap_t *pmap) {
+  for (int d = 0; d < p->nd; ++d) {
+    pmap_set(pmap, p->keys[d],
+             p->vals + ((size_t)i * p->nd + d) * PLAN_VALUE_SZ);
+  }
+}
+
+/** @brief Point directory
+ * @details The directory of the point's periodic saves relative to the output
+ * directory, i.e. `<name>.points/pN`.
+ * @param p Plan
+ * @param i Point index
+ * @param dir Output buffer of RAD_PATH_BUFFER_SZ bytes */
+void plan_dir(const plan_t *p, int i, char *dir) {
+  snprintf(dir, RAD_PATH_BUFFER_SZ, "%s.points" CCM_FILE_SYSTEM_SEP "p%05d",
+           p->name, i);
+}
+
+/** Create manifest
+ * @details Writes the header and the points of a fresh plan's manifest.
+ * @return Zero on success, non-zero otherwise */
+static int create_manifest(plan_t *p) {
+  char filename[2 * RAD_PATH_BUFFER_SZ];
+
+  manifest_name(p, filename, sizeof(filename));
+  if (!(p->fh = fopen(filename, "w"))) {
+    LOGE("Failed to open '%s' with errno %d", filename, errno);
+    return -1;
+  }
+  fprintf(p->fh, "# RAD sweep manifest\nversion = %d\nsweep = %s\n",
+          MANIFEST_VERSION, p->name);
+  fprintf(p->fh, "design = %s\nspec = %08x\npoints = %d\ndims =",
+          designs[p->design], (unsigned)p->spec, p->n);
+  for (int d = 0; d < p->nd; ++d) {
+    fprintf(p->fh, "%s %s", d ? ";" : "", p->keys[d]);
+  }
+  for (int i = 0; i < p->n; ++i) {
+    fprintf(p->fh, "\npoint %d =", i);
+    for (int d = 0; d < p->nd; ++d) {
+      fprintf(p->fh, "%s %s", d ? ";" : "",
+              p->vals + ((size_t)i * p->nd + d) * PLAN_VALUE_SZ);
+    }
+  }
+  fputc('\n', p->fh);
+  p->fresh = false;
+  return 0;
+}
+
+/** Open manifest
+ * @details Creates the manifest of a fresh plan, or else opens it for
+ * appending.
+ * @return Zero on success, non-zero otherwise */
+static int open_manifest(plan_t *p) {
+  char filename[2 * RAD_PATH_BUFFER_SZ];
+
+  if (p->fh) {
+    return 0;
+  }
+  if (p->fresh) {
+    return create_manifest(p);
+  }
+  manifest_name(p, filename, sizeof(filename));
+  if (!(p->fh = fopen(filename, "a"))) {
+    LOGE("Failed to open '%s' with errno %d", filename, errno);
+    return -1;
+  }
+  return 0;
+}
+
+/** @brief Mark point
+ * @details Sets the point's state and appends the event to the manifest,
+ * which is created by the first event of a fresh plan. The manifest is
+ * synchronized, so that a point is never recorded later than it happened.
+ * Marks must be serialized by the caller.
+ * @param p Plan
+ * @param i Point index
+ * @param status New state (e.g. PLAN_DONE)
+ * @param it Iteration count, or the error code of a failed point
+ * @param acc Achieved accuracy
+ * @return Zero on success, non-zero otherwise */
+int plan_mark(plan_t *p, int i, int status, int it, double acc) {
+  p->status[i] = status;
+  if (open_manifest(p) != 0) {
+    return -1;
+  }
+  if (status == PLAN_STARTED) {
+    fprintf(p->fh, "%s %d\n", events[status], i);
+  } else if (status == PLAN_DONE) {
+    fprintf(p->fh, "%s %d %d %.6e\n", events[status], i, it, acc);
+  } else {
+    fprintf(p->fh, "%s %d %d\n", events[status], i, it);
+  }
+  return fflush(p->fh) != 0 || sync_file(p->fh) != 0;
+}
+
+/** Refinement node
+ * @details A solved point or an interval between neighbouring solved points */
+typedef struct {
+  /** @brief Coordinate of a point, negative deviation of an interval */
+  double c;
+  /** @brief Store entry of a point, index of an interval */
+  int k;
+} node_t;
+
+static int node_cmp(const void *a, const void *b) {
+  const node_t *x = (const node_t *)a, *y = (const node_t *)b;
+  return x->c != y->c ? (x->c > y->c) - (x->c < y->c) : x->k - y->k;
+}
+
+/** @brief Refine plan
+ * @details Estimates from the solved points of a refined sweep where its
+ * responses change fastest, and inserts new points there. The deviation of a
+ * point is the greatest difference, over the stored wealth and radius indices,
+ * between its stored policies (`qpol` and `spol`, see rad_sweep.h) and the
+ * linear interpolation of its solved neighbours, relative to the range of the
+ * policy over the sweep. The midpoint of every interval between neighbouring
+ * solved points with an end point that deviates by more than the tolerance is
+ * inserted, in order of decreasing deviation and within the point budget. The
+ * new points are pending, and they are appended to the manifest.
+ * @param p Plan
+ * @return The number of inserted points (zero if the sweep is within its
+ * tolerance or budget, or is not refined), or a negative value on failure */
+int plan_refine(plan_t *p) {
+  static const char *vars[2] = {"qpol", "spol"};
+  char val[PLAN_VALUE_SZ];
+  double *values[2] = {NULL, NULL}, *data[2] = {NULL, NULL};
+  double scale[2] = {0, 0}, worst = 0;
+  int count[2], ls[2] = {0, 0}, m = 0, ng = 0, added = 0;
+
+  if (!(p->refine > 0)) {
+    return 0;
+  }
+  for (int v = 0; v < 2; ++v) {
+    count[v] = sweep_read(p->name, vars[v], &values[v], &data[v], &ls[v]);
+  }
+  if (count[0] < 0 || count[1] != count[0]) {
+    LOGE("Failed to read the sweep store of '%s'", p->name);
+    for (int v = 0; v < 2; ++v) {
+      free(values[v]);
+      free(data[v]);
+    }
+    return -1;
+  }
+
+  // The solved points in the order of their coordinates, with their last
+  // stored solutions
+  int *at = (int *)malloc(p->n * sizeof(int));
+  node_t *nodes = (node_t *)malloc(p->n * sizeof(node_t));
+  for (int i = 0; i < p->n; ++i) {
+    at[i] = -1;
+  }
+  for (int k = 0; k < count[0]; ++k) {
+    int i = plan_find(p, values[0][k]);
+    if (i >= 0 && p->status[i] == PLAN_DONE) {
+      at[i] = k;
+    }
+  }
+  for (int i = 0; i < p->n; ++i) {
+    if (at[i] >= 0) {
+      nodes[m++] = (node_t){p->coords[i], at[i]};
+    }
+  }
+  qsort(nodes, m, sizeof(node_t), node_cmp);
+  if (m < 3) {
+    LOGW("Sweep '%s' needs three solved points to be refined", p->name);
+  }
+
+  for (int v = 0; v < 2; ++v) {
+    double lo = INFINITY, hi = -INFINITY;
+    for (int j = 0; j < m; ++j) {
+      const double *f = data[v] + (size_t)nodes[j].k * ls[v];
+      for (int e = 0; e < ls[v]; ++e) {
+        lo = fmin(lo, f[e]);
+        hi = fmax(hi, f[e]);
+      }
+    }
+    scale[v] = hi > lo ? 1 / (hi - lo) : 0;
+  }
+  double *dev = (double *)calloc(m + 1, sizeof(double));
+  for (int j = 1; j + 1 < m; ++j) {
+    double t =
+        (nodes[j].c - nodes[j - 1].c) / (nodes[j + 1].c - nodes[j - 1].c);
+    for (int v = 0; v < 2; ++v) {
+      const double *a = data[v] + (size_t)nodes[j - 1].k * ls[v];
+      const double *f = data[v] + (size_t)nodes[j].k * ls[v];
+      const double *b = data[v] + (size_t)nodes[j + 1].k * ls[v];
+      for (int e = 0; e < ls[v]; ++e) {
+        double d = fabs(f[e] - (a[e] + t * (b[e] - a[e])));
+        dev[j] = fmax(dev[j], d * scale[v]);
+      }
+    }
+  }
+
+  // The intervals beyond the tolerance, the greatest deviation first
+  node_t *gaps = (node_t *)malloc((m + 1) * sizeof(node_t));
+  for (int j = 0; j + 1 < m; ++j) {
+    double e = fmax(dev[j], dev[j + 1]);
+    worst = fmax(worst, e);
+    if (e > p->refine) {
+      gaps[ng++] = (node_t){-e, j};
+    }
+  }
+  qsort(gaps, ng, sizeof(node_t), node_cmp);
+  for (int g = 0; g < ng && p->n < p->budget && added >= 0; ++g) {
+    double lo = nodes[gaps[g].k].c, hi = nodes[gaps[g].k + 1].c;
+    double c = 0.5 * (lo + hi);
+    if (!(c > lo && c < hi) || plan_find(p, c) >= 0) {
+      // The interval cannot be split any further
+      continue;
+    }
+    if (open_manifest(p) != 0) {
+      added = -2;
+      break;
+    }
+    // The value is printed with all its digits, so that it is parsed as c
+    snprintf(val, PLAN_VALUE_SZ, "%.17g", c);
+    fprintf(p->fh, "point %d = %s\n", p->n, val);
+    add_point(p, val, c);
+    ++added;
+  }
+  if (added > 0 && (fflush(p->fh) != 0 || sync_file(p->fh) != 0)) {
+    LOGE("Failed to append the points of sweep '%s'", p->name);
+    added = -3;
+  }
+
+  if (added > 0) {
+    LOGI("Sweep '%s' deviates by %.3g, inserting %d points", p->name, worst,
+         added);
+  } else if (added == 0 && ng > 0) {
+    LOGW("Sweep '%s' deviates by %.3g at its budget of %d points", p->name,
+         worst, p->n);
+  } else if (added == 0) {
+    LOGI("Sweep '%s' is refined with %d points to a deviation of %.3g",
+         p->name, p->n, worst);
+  }
+  for (int v = 0; v < 2; ++v) {
+    free(values[v]);
+    free(data[v]);
+  }
+  free(at);
+  free(nodes);
+  free(dev);
+  free(gaps);
+  return added;
+}
+
+/** @brief Free plan
+ * @details Closes the manifest. The recorded events remain.
+ * @param p Plan */
+void plan_free(plan_t *p) {
+  if (p->fh) {
+    fclose(p->fh);
+  }
+  free(p->vals);
+  free(p->coords);
+  free(p->status);
+  memset(p, 0, sizeof(*p));
+}
@@ -0,0 +1,807 @@
+#include "rad_sched.h"
+#include "rad_conf.h"
+
+#include "cross_comp.h"
+#include "pmap_t.h"
+#include "rad_ctx.h"
+#include "rad_setup.h"
+#include "rad_threads.h"
+
+#include "math.h"
+#include "stdbool.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+
+#define LM_LEVEL 3
+#include "logger.h"
+
+/** Size of the point descriptions of the log in bytes */
+#define POINT_DESC_SZ 256
+
+struct sched_st;
+
+/** Lane structure */
+typedef struct {
+  /** @brief Scheduler */
+  struct sched_st *h;
+  /** @brief Lane identifier */
+  int id;
+  /** @brief Model of the lane's setup */
+  model_t m;
+  /** @brief Solution of the lane's setup */
+  sol_t s;
+  /** @brief Setup */
+  setup_t u;
+  /** @brief Execution context of the setup */
+  rad_ctx_t x;
+  /** @brief Output directory of the current job's periodic saves */
+  char dir[2 * RAD_PATH_BUFFER_SZ];
+  /** @brief Copy of the last solution that is handed over */
+  sol_t snap;
+  /** @brief Job of the copy (negative if the copy is stored) */
+  int job;
+  /** @brief Job of the current solve */
+  int cur;
+  /** @brief Wall-clock time of the current solve's start */
+  double tbeg;
+  /** @brief Lane thread */
+  rad_thrd_t thread;
+  /** @brief The lane thread is created */
+  bool started;
+} lane_t;
+
+/** Scheduler structure */
+typedef struct sched_st {
+  /** @brief Jobs */
+  sched_job_t *jobs;
+  /** @brief Number of jobs */
+  int n;
+  /** @brief Number of solved jobs */
+  int done;
+  /** @brief Lanes */
+  lane_t *lanes;
+  /** @brief Number of lanes */
+  int nl;
+  /** @brief Number of lanes of a lane thread (see setup_batch()) */
+  int width;
+  /** @brief Number of running lane threads */
+  int active;
+  /** @brief The lanes store their solutions themselves */
+  bool sync;
+  /** @brief First non-zero status of a lane (stops the lanes) */
+  int rc;
+  /** @brief Continuation mode (e.g. SCHED_NEAREST) */
+  int cont;
+  /** @brief Continuation warm starts include the policies */
+  int policies;
+  /** @brief Solutions of the solved jobs (continuation modes only) */
+  sol_t *sols;
+  /** @brief Parameter map of the setups */
+  pmap_t pmap;
+  /** @brief Parameter file of the setups */
+  const char *parameter_filename;
+  /** @brief Functional specification */
+  const objpart_t *objparts;
+  /** @brief Context of the calling thread (holds the sweep stores) */
+  const rad_ctx_t *x;
+  /** @brief The process records the events of the points (rank zero) */
+  bool recorder;
+  /** @brief Guards the jobs, the hand-over and the manifests */
+  rad_mtx_t mtx;
+  /** @brief Signals hand-overs, stored copies and lane exits */
+  rad_cnd_t cnd;
+} sched_t;
+
+/** Describe point
+ * @details Lists the keys and the values of the job's point for the log.
+ * @param job Job
+ * @param desc Output buffer of POINT_DESC_SZ bytes */
+void describe_point(const sched_job_t *job, char *desc) {
+  const plan_t *p = job->plan;
+  int len = 0;
+
+  desc[0] = 0;
+  for (int d = 0; d < p->nd && len < POINT_DESC_SZ; ++d) {
+    len += snprintf(desc + len, POINT_DESC_SZ - len, "%s%s = %s",
+                    d ? ", " : "", p->keys[d],
+                    p->vals + ((size_t)job->point * p->nd + d) * PLAN_VALUE_SZ);
+  }
+}
+
+/** Mark job
+ * @details Records an event of the job's point in the manifest of its plan
+ * (see plan_mark()), which is in the calling thread's directory. The
+ * scheduler's mutex must be held.
+ * @param h Scheduler
+ * @param j Job index
+ * @param status New state of the point (e.g. PLAN_DONE)
+ * @param it Iteration count or error code
+ * @param acc Achieved accuracy */
+void mark_job(sched_t *h, int j, int status, int it, double acc) {
+  const sched_job_t *job = &h->jobs[j];
+  const rad_ctx_t *x = rad_ctx_get();
+
+  rad_ctx_set(h->x);
+  if (h->recorder && plan_mark(job->plan, job->point, status, it, acc) != 0) {
+    LOGW("Failed to record point %d of sweep '%s'", job->point,
+         job->plan->name);
+  }
+  rad_ctx_set(x);
+}
+
+/** Expected cost
+ * @details The job's cost estimate of a previous sweep or else the iteration
+ * count of the nearest solved job of the same plan.
+ * @param h Scheduler
+ * @param j Job index
+ * @return The expected cost, or infinity if there is no estimate */
+double expected_cost(const sched_t *h, int j) {
+  const sched_job_t *job = &h->jobs[j];
+  double cost = INFINITY, dist = INFINITY;
+
+  if (job->cost >= 0) {
+    return job->cost;
+  }
+  for (int i = 0; i < h->n; ++i) {
+    const sched_job_t *o = &h->jobs[i];
+    if (o->state == SCHED_DONE && o->plan == job->plan &&
+        plan_distance(job->plan, o->point, job->point) < dist) {
+      dist = plan_distance(job->plan, o->point, job->point);
+      cost = o->it;
+    }
+  }
+  return cost;
+}
+
+/** Pick job
+ * @details Marks the pending job of the greatest expected cost as running.
+ * The scheduler's mutex must be held.
+ * @param h Scheduler
+ * @return The job's index, or -1 if no job is pending or the lanes stop */
+int pick_job(sched_t *h) {
+  int best = -1;
+  double cost, best_cost = -INFINITY;
+
+  for (int j = 0; j < h->n && h->rc == 0; ++j) {
+    if (h->jobs[j].state == SCHED_PENDING &&
+        (cost = expected_cost(h, j)) > best_cost) {
+      best = j;
+      best_cost = cost;
+    }
+  }
+  if (best >= 0) {
+    h->jobs[best].state = SCHED_RUNNING;
+    mark_job(h, best, PLAN_STARTED, 0, 0);
+  }
+  return best;
+}
+
+/** Prior costs
+ * @details Sets the expected costs of the jobs to the iteration counts of the
+ * nearest points of the previous sweeps in their stores.
+ * @param jobs Jobs
+ * @param n Number of jobs */
+void prior_costs(sched_job_t *jobs, int n) {
+  for (int j = 0; j < n; ++j) {
+    double *values = NULL;
+    int *its = NULL;
+    sweep_t *store = jobs[j].store;
+    bool seen = false;
+    for (int i = 0; i < j && !seen; ++i) {
+      seen = jobs[i].store == store;
+    }
+    if (seen) {
+      continue;
+    }
+
+    int count = sweep_index(store->path, &values, &its);
+    for (int i = j; i < n && count > 0; ++i) {
+      sched_job_t *job = &jobs[i];
+      double dist = INFINITY;
+      for (int k = 0; k < count && job->store == store; ++k) {
+        double d = plan_gap(job->plan, job->point, values[k]);
+        if (d < dist) {
+          dist = d;
+          job->cost = its[k];
+        }
+      }
+    }
+    free(values);
+    free(its);
+  }
+}
+
+/** Extrapolation factor
+ * @details The factor t of the linear extrapolation a + t (a - b) to the job's
+ * point (see setup_continue()), where the coordinates of the points are
+ * normalized by the spans of the plan's dimensions.
+ * @param h Scheduler
+ * @param j Job index
+ * @param a Job index of the nearest solved point
+ * @param b Job index of the second nearest solved point
+ * @return The factor, or infinity if the points are not on a line */
+double extrapolation(const sched_t *h, int j, int a, int b) {
+  const plan_t *p = h->jobs[j].plan;
+  const double *cj = &p->coords[(size_t)h->jobs[j].point * p->nd];
+  const double *ca = &p->coords[(size_t)h->jobs[a].point * p->nd];
+  const double *cb = &p->coords[(size_t)h->jobs[b].point * p->nd];
+  double ed = 0, ee = 0, dd = 0;
+
+  for (int d = 0; d < p->nd; ++d) {
+    double e = (cj[d] - ca[d]) / p->span[d];
+    double f = (ca[d] - cb[d]) / p->span[d];
+    ed += e * f;
+    ee += e * e;
+    dd += f * f;
+  }
+  // Collinear up to rounding
+  if (!(dd > 0) || fabs(ed * ed - ee * dd) > 1e-9 * ee * dd) {
+    return INFINITY;
+  }
+  return ed / dd;
+}
+
+/** Seed job
+ * @details Warm starts the lane's setup from the solution of the nearest
+ * solved job of the same plan (see setup_continue()). In the
+ * SCHED_EXTRAPOLATE mode, the solution of the second nearest solved job is
+ * used for a linear extrapolation or interpolation, unless the three points
+ * are not on a line or the second nearest job is closer to the nearest job
+ * than the nearest job is to the seeded one.
+ * @param l Lane
+ * @param j Job index */
+void seed_job(lane_t *l, int j) {
+  sched_t *h = l->h;
+  const sched_job_t *job = &h->jobs[j];
+  int a = -1, b = -1;
+  double da = INFINITY, db = INFINITY;
+
+  rad_mtx_lock(&h->mtx);
+  for (int i = 0; i < h->n; ++i) {
+    const sched_job_t *o = &h->jobs[i];
+    if (o->state != SCHED_DONE || o->plan != job->plan || !h->sols[i].mem) {
+      continue;
+    }
+    double d = plan_distance(job->plan, o->point, job->point);
+    if (d < da) {
+      b = a, db = da;
+      a = i, da = d;
+    } else if (d < db) {
+      b = i, db = d;
+    }
+  }
+  rad_mtx_unlock(&h->mtx);
+  if (a < 0) {
+    return;
+  }
+
+  double t = 0;
+  if (h->cont == SCHED_EXTRAPOLATE && b >= 0) {
+    t = extrapolation(h, j, a, b);
+    // Evenly spaced grids give one up to rounding
+    b = fabs(t) < 1 + 1e-9 ? b : -1;
+  } else {
+    b = -1;
+  }
+  if (setup_continue(&l->u, &h->sols[a], b >= 0 ? &h->sols[b] : NULL,
+                     b >= 0 ? t : 0, h->policies) == 0) {
+    LOGI("Continuing from point %d%s", h->jobs[a].point,
+         b >= 0 ? " (extrapolated)" : "");
+  }
+}
+
+/** Store solution
+ * @details Appends the solution to the job's store and records the point as
+ * done.
+ * @param l Lane
+ * @param s Solution
+ * @param j Job index
+ * @return Zero on success, non-zero otherwise */
+int store_solution(lane_t *l, const sol_t *s, int j) {
+  sched_t *h = l->h;
+  sched_job_t *job = &h->jobs[j];
+  double value = plan_value(job->plan, job->point);
+  int rc;
+
+  if (s == &l->s) {
+    // Only rank zero stores the setup's own solution
+    rc = setup_sweep(&l->u, job->store, value);
+  } else {
+    rad_ctx_set(h->x);
+    rc = sweep_append(job->store, s, value);
+  }
+  if (rc == 0) {
+    rad_mtx_lock(&h->mtx);
+    mark_job(h, j, PLAN_DONE, s->it, s->acc);
+    rad_mtx_unlock(&h->mtx);
+  }
+  return rc;
+}
+
+/** Resume job
+ * @details Replaces the lane's setup with the last periodic save in the
+ * current job's directory, if there is one. The output directory of the lane
+ * must be the job's directory.
+ * @param l Lane
+ * @return One if the setup is loaded from a save, zero if there is no save
+ * or it cannot be loaded and negative if the setup cannot be initialized
+ * again */
+int resume_job(lane_t *l) {
+  sched_t *h = l->h;
+  char save_point[RAD_PATH_BUFFER_SZ];
+
+  rad_ctx_set(&l->x);
+  if (setup_find_last_saved(save_point) != 0) {
+    return 0;
+  }
+  setup_free(&l->u);
+  if (setup_load(&l->u, save_point, h->objparts) == 0) {
+    LOGI("Resuming from %s" CCM_FILE_SYSTEM_SEP "%s", l->dir, save_point);
+    return 1;
+  }
+  LOGW("Failed to load %s, solving from the start", save_point);
+  // The setup reads the warm start of the parameter file again
+  l->x.temp_dir = h->x->temp_dir;
+  int rc = setup_init(&l->u, h->parameter_filename, h->objparts);
+  l->x.temp_dir = l->dir;
+  return rc != 0 ? -1 : 0;
+}
+
+/** Start job
+ * @details Prepares the lane's setup for the job's point, whose periodic saves
+ * are written to the point's directory (see plan_dir()).
+ * @param l Lane
+ * @param j Job index
+ * @return SETUP_BATCH_SOLVE, SETUP_BATCH_RESUME if the setup continues from a
+ * periodic save, or negative if the setup cannot be initialized */
+int start_job(lane_t *l, int j) {
+  sched_t *h = l->h;
+  sched_job_t *job = &h->jobs[j];
+  char desc[POINT_DESC_SZ], dir[RAD_PATH_BUFFER_SZ];
+  pmap_t pmap;
+  int rc = 0;
+
+  plan_dir(job->plan, job->point, dir);
+  snprintf(l->dir, sizeof(l->dir), "%s" CCM_FILE_SYSTEM_SEP "%s",
+           h->x->temp_dir ? h->x->temp_dir : RAD_TEMP_DIR, dir);
+  l->x.temp_dir = l->dir;
+  rad_ctx_set(&l->x);
+  describe_point(job, desc);
+  LOGI("Solving point %d of sweep '%s' (%s) on lane %d...", job->point,
+       job->plan->name, desc, l->id);
+
+  l->cur = j;
+  l->tbeg = rad_wall_time();
+  if (job->resume && (rc = resume_job(l)) < 0) {
+    LOGE("Failed to initialize lane %d", l->id);
+    return rc;
+  } else if (rc > 0) {
+    return SETUP_BATCH_RESUME;
+  }
+  pmap_copy(&pmap, &h->pmap);
+  plan_apply(job->plan, job->point, &pmap);
+  setup_reset(&l->u, &pmap, h->objparts);
+  pmap_free(&pmap);
+  if (setup_rank(&l->u) == 0 && setup_clear_saved() != 0) {
+    LOGW("Failed to remove the previous saves of %s", l->dir);
+  }
+  if (h->cont != SCHED_COLD) {
+    seed_job(l, j);
+  }
+  return SETUP_BATCH_SOLVE;
+}
+
+/** End job
+ * @details Logs the result of the lane's current solve and records a halted
+ * or failed point.
+ * @param l Lane
+ * @param rc Return value of the solve (see setup_solve())
+ * @return The passed return value */
+int end_job(lane_t *l, int rc) {
+  sched_t *h = l->h;
+  int j = l->cur;
+
+  // The setup's own solution is stored in the calling thread's directory
+  l->x.temp_dir = h->x->temp_dir;
+
+  if (rc == SETUP_HALTED) {
+    LOGW("Numerical solver halted (%d iter), sweep stopped", l->s.it);
+  } else if (rc != 0) {
+    LOGE("Numerical solver failed with code %d", rc);
+  } else {
+    LOGI("Numerical solver completed (%d iter, %f sec)", l->s.it,
+         rad_wall_time() - l->tbeg);
+  }
+  if (rc != 0) {
+    rad_mtx_lock(&h->mtx);
+    mark_job(h, j, rc == SETUP_HALTED ? PLAN_HALTED : PLAN_FAILED,
+             rc == SETUP_HALTED ? l->s.it : rc, l->s.acc);
+    rad_mtx_unlock(&h->mtx);
+  }
+  return rc;
+}
+
+/** Solve job
+ * @details Solves the job's point with the lane's setup (see start_job()).
+ * @param l Lane
+ * @param j Job index
+ * @return Zero on convergence, non-zero otherwise (see setup_solve()) */
+int solve_job(lane_t *l, int j) {
+  int rc = start_job(l, j);
+
+  if (rc == SETUP_BATCH_RESUME) {
+    rc = setup_resume(&l->u);
+  } else if (rc == SETUP_BATCH_SOLVE) {
+    rc = setup_solve(&l->u);
+  }
+  return end_job(l, rc);
+}
+
+/** Finish job
+ * @details Records the lane's solved job and stores its solution, or hands a
+ * copy of it over to the calling thread.
+ * @param l Lane
+ * @param j Job index
+ * @return Zero on success, non-zero otherwise */
+int finish_job(lane_t *l, int j) {
+  sched_t *h = l->h;
+
+  if (h->cont != SCHED_COLD) {
+    // The copy is complete before the job is seen as solved
+    solution_copy(&h->sols[j], &l->s);
+  }
+
+  rad_mtx_lock(&h->mtx);
+  h->jobs[j].it = l->s.it;
+  h->jobs[j].state = SCHED_DONE;
+  LOGI("Sweep point %d of %d solved", ++h->done, h->n);
+  // The previous copy must be stored before it is replaced
+  while (!h->sync && l->job >= 0) {
+    rad_cnd_wait(&h->cnd, &h->mtx);
+  }
+  rad_mtx_unlock(&h->mtx);
+
+  if (h->sync) {
+    return store_solution(l, &l->s, j);
+  }
+  solution_copy(&l->snap, &l->s);
+  rad_mtx_lock(&h->mtx);
+  l->job = j;
+  rad_cnd_broadcast(&h->cnd);
+  rad_mtx_unlock(&h->mtx);
+  return 0;
+}
+
+/** Stop lanes
+ * @details Records the first non-zero status, which stops the lanes after
+ * their current jobs.
+ * @param h Scheduler
+ * @param rc Status */
+void stop_lanes(sched_t *h, int rc) {
+  rad_mtx_lock(&h->mtx);
+  if (rc != 0 && h->rc == 0) {
+    h->rc = rc;
+  }
+  rad_mtx_unlock(&h->mtx);
+}
+
+/** Next batch job
+ * @details Starts the next job of a lane of a batch (see setup_batch()).
+ * @param arg First lane of the batch
+ * @param k Lane index in the batch
+ * @return SETUP_BATCH_SOLVE, SETUP_BATCH_RESUME or SETUP_BATCH_RETIRE */
+int next_job(void *arg, int k) {
+  lane_t *l = (lane_t *)arg + k;
+  sched_t *h = l->h;
+
+  rad_mtx_lock(&h->mtx);
+  int j = pick_job(h);
+  rad_mtx_unlock(&h->mtx);
+  if (j < 0) {
+    return SETUP_BATCH_RETIRE;
+  }
+  int rc = start_job(l, j);
+  if (rc < 0) {
+    stop_lanes(h, end_job(l, rc));
+    return SETUP_BATCH_RETIRE;
+  }
+  return rc;
+}
+
+/** Batch job done
+ * @details Ends the current job of a lane of a batch (see setup_batch()).
+ * @param arg First lane of the batch
+ * @param k Lane index in the batch
+ * @param ec Return value of the solve (see setup_solve()) */
+void job_done(void *arg, int k, int ec) {
+  lane_t *l = (lane_t *)arg + k;
+  int rc = end_job(l, ec);
+
+  if (rc == 0) {
+    rc = finish_job(l, l->cur);
+  }
+  stop_lanes(l->h, rc);
+}
+
+/** Lane thread
+ * @details Solves jobs on the passed lane, or on the batch of the next width
+ * lanes that starts with it, until no job is pending or the lanes stop.
+ * @param vl Lane
+ * @return Zero on success, non-zero otherwise */
+int lane_main(void *vl) {
+  lane_t *l = (lane_t *)vl;
+  sched_t *h = l->h;
+  int j, rc = 0;
+
+  if (h->width > 1) {
+    int n = h->nl - l->id < h->width ? h->nl - l->id : h->width;
+    setup_t **us = (setup_t **)malloc(n * sizeof(setup_t *));
+    for (int k = 0; k < n; ++k) {
+      us[k] = &l[k].u;
+    }
+    setup_batch(us, n, next_job, job_done, l);
+    free(us);
+  }
+  while (h->width == 1) {
+    rad_mtx_lock(&h->mtx);
+    j = pick_job(h);
+    rad_mtx_unlock(&h->mtx);
+    if (j < 0 || (rc = solve_job(l, j)) != 0 ||
+        (rc = finish_job(l, j)) != 0) {
+      break;
+    }
+  }
+
+  rad_mtx_lock(&h->mtx);
+  if (rc != 0 && h->rc == 0) {
+    h->rc = rc;
+  }
+  --h->active;
+  rad_cnd_broadcast(&h->cnd);
+  rad_mtx_unlock(&h->mtx);
+  return rc;
+}
+
+/** Store hand-overs
+ * @details Stores the solution copies of the lanes until all the lanes exit.
+ * @param h Scheduler */
+void store_handovers(sched_t *h) {
+  rad_mtx_lock(&h->mtx);
+  while (true) {
+    lane_t *l = NULL;
+    for (int i = 0; i < h->nl && !l; ++i) {
+      l = h->lanes[i].job >= 0 ? &h->lanes[i] : NULL;
+    }
+    if (!l && h->active == 0) {
+      break;
+    }
+    if (!l) {
+      rad_cnd_wait(&h->cnd, &h->mtx);
+      continue;
+    }
+    rad_mtx_unlock(&h->mtx);
+    int rc = store_solution(l, &l->snap, l->job);
+    rad_mtx_lock(&h->mtx);
+    if (rc != 0 && h->rc == 0) {
+      h->rc = rc;
+    }
+    l->job = -1;
+    rad_cnd_broadcast(&h->cnd);
+  }
+  rad_mtx_unlock(&h->mtx);
+}
+
+/** Job cost structure */
+typedef struct {
+  /** @brief Expected cost */
+  double cost;
+  /** @brief Job index */
+  int job;
+} job_cost_t;
+
+/** Compare job costs
+ * @details Orders the costs descending and the job indices ascending. */
+int compare_costs(const void *va, const void *vb) {
+  const job_cost_t *a = (const job_cost_t *)va, *b = (const job_cost_t *)vb;
+  if (a->cost != b->cost) {
+    return a->cost < b->cost ? 1 : -1;
+  }
+  return (a->job > b->job) - (a->job < b->job);
+}
+
+/** @brief Shard jobs
+ * @details Keeps the jobs of one of several shards of a sweep (see
+ * rad_sched.h). The expected costs of the jobs are the iteration counts of
+ * the nearest points in their stores, or else the mean of the known costs.
+ * The jobs are assigned in descending order of their costs to the shard of
+ * the least assigned cost (the lowest one on ties), so that every shard of
+ * the same jobs and stores keeps a disjoint share of a similar cost. The kept
+ * jobs retain their order and their costs from the stores.
+ * @param jobs Jobs with unknown costs
+ * @param n Number of jobs
+ * @param shard Shard index
+ * @param shards Number of shards
+ * @return The number of kept jobs */
+int sched_shard(sched_job_t *jobs, int n, int shard, int shards) {
+  job_cost_t *order = (job_cost_t *)malloc((n > 0 ? n : 1) * sizeof(*order));
+  double *load = (double *)calloc(shards, sizeof(double));
+  int *owner = (int *)malloc((n > 0 ? n : 1) * sizeof(int));
+  double mean = 0, total = 0;
+  int known = 0, kept = 0;
+
+  prior_costs(jobs, n);
+  for (int j = 0; j < n; ++j) {
+    if (jobs[j].cost >= 0) {
+      mean += jobs[j].cost;
+      ++known;
+    }
+  }
+  mean = known > 0 ? mean / known : 1;
+  for (int j = 0; j < n; ++j) {
+    order[j] = (job_cost_t){jobs[j].cost >= 0 ? jobs[j].cost : mean, j};
+  }
+  qsort(order, n, sizeof(*order), compare_costs);
+  for (int k = 0; k < n; ++k) {
+    int s = 0;
+    for (int i = 1; i < shards; ++i) {
+      s = load[i] < load[s] ? i : s;
+    }
+    load[s] += order[k].cost;
+    total += order[k].cost;
+    owner[order[k].job] = s;
+  }
+
+  for (int j = 0; j < n; ++j) {
+    if (owner[j] == shard) {
+      jobs[kept++] = jobs[j];
+    }
+  }
+  LOGI("Shard %d of %d takes %d of %d sweep points (expected cost %g of %g)",
+       shard, shards, kept, n, load[shard], total);
+  free(order);
+  free(load);
+  free(owner);
+  return kept;
+}
+
+/** @brief Run sweep jobs
+ * @details Solves the passed jobs on the passed number of concurrent lanes
+ * and appends the solutions to the jobs' sweep stores (see rad_sched.h). The
+ * setups of the lanes are initialized from the passed parameter file and they
+ * are reset to the jobs' points before every job (see plan_apply()). Every job
+ * writes its periodic saves to its point's directory (see plan_dir()), from
+ * which a job that is marked for resuming continues. The starts, completions,
+ * halts and failures of the jobs are recorded in the manifests of their plans
+ * (see plan_mark()). If the threads of the lanes cannot be created (e.g. with
+ * the OpenMP backend) or the solver runs on several ranks, the jobs are solved
+ * one after another by the calling thread. A lane whose solve halts or fails
+ * stops the lanes after their current jobs. In the continuation modes, the
+ * solutions of the solved jobs are kept in memory until the function returns
+ * and every job is warm started from its solved neighbours (see seed_job()).
+ * @param jobs Pending jobs with unknown costs
+ * @param n Number of jobs
+ * @param lanes Number of lane threads
+ * @param batch Number of lanes of a lane thread (see setup_batch())
+ * @param cont Continuation mode (e.g. SCHED_COLD)
+ * @param policies Continuation warm starts include the policies
+ * @param parameter_filename Parameter file of the setups
+ * @param objparts Functional specification
+ * @return Zero if all the jobs are solved and stored, SETUP_HALTED if a solve
+ * is halted, non-zero otherwise */
+int sched_run(sched_job_t *jobs, int n, int lanes, int batch, int cont,
+              int policies, const char *parameter_filename,
+              const objpart_t *objparts) {
+  char path[RAD_PATH_BUFFER_SZ];
+  sched_t h = {.jobs = jobs,
+               .n = n,
+               .width = batch > 1 ? batch : 1,
+               .cont = cont,
+               .policies = policies,
+               .parameter_filename = parameter_filename,
+               .objparts = objparts};
+  int ncpus = cpus_available(NULL, 0);
+
+  h.x = rad_ctx_get();
+#if RAD_MPI
+  if (lanes > 1) {
+    LOGW("Concurrent sweep points are not supported with MPI");
+  }
+  if (h.width > 1) {
+    LOGW("Batched sweep points are not supported with MPI");
+  }
+  lanes = 1;
+  h.width = 1;
+#endif /* RAD_MPI */
+  lanes = lanes > 0 ? lanes : 1;
+  h.nl = lanes * h.width < n ? lanes * h.width : n;
+  h.nl = h.nl > 0 ? h.nl : 1;
+  // Number of lane threads
+  int nthrd = (h.nl + h.width - 1) / h.width;
+  h.sync = nthrd == 1;
+  snprintf(path, RAD_PATH_BUFFER_SZ, "%s" CCM_FILE_SYSTEM_SEP "%s",
+           rad_data_dir(), parameter_filename);
+  if (pmap_init(&h.pmap, path) != 0) {
+    return -1;
+  }
+  prior_costs(jobs, n);
+  if (h.cont != SCHED_COLD) {
+    h.sols = (sol_t *)calloc(n, sizeof(sol_t));
+  }
+
+  h.lanes = (lane_t *)calloc(h.nl, sizeof(lane_t));
+  for (int i = 0; i < h.nl; ++i) {
+    lane_t *l = &h.lanes[i];
+    l->h = &h;
+    l->id = i;
+    l->job = -1;
+    l->x = *h.x;
+    if (h.width > 1) {
+      // Batches are solved by their lane threads alone
+      l->x.threads = 0;
+    } else if (h.nl > 1) {
+      // The lane's thread participates in the solve
+      l->x.threads = ncpus / h.nl > 1 ? ncpus / h.nl - 1 : 0;
+    }
+    l->u = (setup_t){.m = &l->m, .s = &l->s, .x = &l->x};
+    if (setup_init(&l->u, parameter_filename, objparts) != 0) {
+      h.nl = i;
+      h.rc = -2;
+      break;
+    }
+  }
+  h.recorder = h.nl > 0 && setup_rank(&h.lanes[0].u) == 0;
+
+  rad_mtx_init(&h.mtx);
+  rad_cnd_init(&h.cnd);
+  if (h.width > 1) {
+    LOGI("Solving sweep points in batches of %d lanes", h.width);
+  }
+  if (h.rc == 0 && !h.sync) {
+    LOGI("Solving %d sweep points on %d lanes", n, h.nl);
+    // The lanes exit only after they are all counted
+    rad_mtx_lock(&h.mtx);
+    for (int i = 0; i < h.nl; i += h.width) {
+      lane_t *l = &h.lanes[i];
+      l->started = rad_thrd_create(&l->thread, lane_main, l) == 0;
+      h.active += l->started;
+    }
+    rad_mtx_unlock(&h.mtx);
+    if (h.active == 0) {
+      LOGW("Sweep points are solved one after another");
+      h.sync = true;
+    }
+  }
+  if (h.rc == 0 && h.sync) {
+    h.active = 1;
+    lane_main(&h.lanes[0]);
+  } else if (h.rc == 0) {
+    store_handovers(&h);
+    for (int i = 0; i < h.nl; ++i) {
+      if (h.lanes[i].started) {
+        rad_thrd_join(h.lanes[i].thread);
+      }
+    }
+  }
+  rad_cnd_destroy(&h.cnd);
+  rad_mtx_destroy(&h.mtx);
+
+  for (int i = 0; i < h.nl; ++i) {
+    rad_ctx_set(&h.lanes[i].x);
+    if (h.lanes[i].snap.mem) {
+      solution_free(&h.lanes[i].snap);
+    }
+    setup_free(&h.lanes[i].u);
+  }
+  rad_ctx_set(h.x);
+  for (int j = 0; j < n && h.sols; ++j) {
+    if (h.sols[j].mem) {
+      solution_free(&h.sols[j]);
+    }
+  }
+  free(h.sols);
+  free(h.lanes);
+  pmap_free(&h.pmap);
+
+  return h.rc;
+}
@@ -6,18 +6,28 @@
 #include "pmap_t.h"
 
 #include "cross_comp.h"
+#include "rad_cache.h"
+#include "rad_ckpt.h"
+#include "rad_ctx.h"
+#include "rad_file.h"
+#include "rad_mpi.h"
+#include "rad_specs.h"
+#include "rad_stream.h"
+#include "rad_sweep.h"
+#include "rad_threads.h"
 
 #include "assert.h"
+#include "ctype.h"
 #include "math.h"
+#include "signal.h"
 #include "stdbool.h"
 #include "stdio.h"
 #include "stdlib.h"
 #include "string.h"
 
-#if RAD_NUM_THREADS > 0
-#include "threads.h"
-#else
-typedef int (*thrd_start_t)(void*);
+#if RAD_MULTITHREADING
+#include "stdatomic.h"
+#include "stdint.h"
 #endif
 
 #if defined(__unix__) || defined(__APPLE__)
@@ -31,6 +41,30 @@ typedef int (*thrd_start_t)(void*);
 
 #define __min__(X, Y) (((X) < (Y)) ? (X) : (Y))
 
+/** Number of logical states that fit in a cache line of the shared arrays */
+#define STATES_PER_LINE ((int)(RAD_CACHE_LINE_SZ / sizeof(double)))
+#if RAD_CHUNK_SIZE > 0
+/** Chunk size rounded up to whole cache lines */
+#define CHUNK_SZ                                                               \
+  (((RAD_CHUNK_SIZE + STATES_PER_LINE - 1) / STATES_PER_LINE) * STATES_PER_LINE)
+#endif /* RAD_CHUNK_SIZE */
+/** Number of barrier polls before a waiting thread parks */
+#define BARRIER_SPIN_COUNT 4096
+/** Minimum number of states of a worker before the effort loop is split */
+#define MIN_PART_STATES (8 * STATES_PER_LINE)
+
+/** The solve continues */
+#define HALT_NONE 0
+/** The maximum number of iterations is reached */
+#define HALT_MAXIT 1
+/** The wall-clock budget is exhausted */
+#define HALT_BUDGET 2
+/** A halt signal is caught */
+#define HALT_SIGNAL 3
+
+/** Caught halt signal (zero if none, see setup_catch_signals()) */
+static volatile sig_atomic_t halt_signal = 0;
+
 struct range_st {
   /** @brief Offset */
   int o;
@@ -41,6 +75,21 @@ struct range_st {
 };
 typedef struct range_st range_t;
 
+#if RAD_MULTITHREADING && RAD_CHUNK_SIZE > 0
+/** Chunk deque
+ * @details The chunks of a worker form a contiguous range of chunk indices.
+ * The head (low 32 bits) and the tail (high 32 bits) of the range are packed
+ * in a single atomic so that the owner can pop from the head and thieves can
+ * steal from the tail without locking. */
+struct deque_st {
+  /** @brief Packed head and tail chunk indices */
+  atomic_uint_least64_t ht;
+  /** @brief Padding to avoid false sharing between deques */
+  char pad[RAD_CACHE_LINE_SZ - sizeof(atomic_uint_least64_t)];
+};
+typedef struct deque_st deque_t;
+#endif /* RAD_MULTITHREADING && RAD_CHUNK_SIZE */
+
 struct worker_st {
   /** @brief Logical range */
   range_t l;
@@ -48,17 +97,138 @@ struct worker_st {
   range_t x;
   /** @brief Radius grid range */
   range_t r;
+  /** @brief Effort grid range */
+  range_t e;
+  /** @brief Effort part index */
+  int ei;
 
-#if RAD_NUM_THREADS > 0
+#if RAD_MULTITHREADING
   /** @brief System thread*/
-  thrd_t thread;
-#endif /* RAD_NUM_THREADS */
+  rad_thrd_t thread;
+
+#if RAD_CHUNK_SIZE > 0
+  /** @brief Chunk range of the static partition */
+  range_t k;
+  /** @brief Chunk deque */
+  deque_t q;
+  /** @brief Stolen chunk count */
+  long steals;
+#endif /* RAD_CHUNK_SIZE */
+
+  /** @brief Processed state count */
+  long states;
+  /** @brief Last iteration's busy time */
+  double tit;
+  /** @brief Total busy time */
+  double tbusy;
+#endif /* RAD_MULTITHREADING */
 };
 typedef struct worker_st worker_t;
 
+/** Reduction slot
+ * @details Holds a worker's local maxima of an iteration. Slots are padded so
+ * that workers never write to the same cache line. */
+struct slot_st {
+  /** @brief Local accuracy */
+  double acc;
+  /** @brief Local maximum quantity policy */
+  double qM;
+  /** @brief Local maximum effort policy */
+  double sM;
+  /** @brief Local maximum value function */
+  double vM;
+  /** @brief Padding */
+  char pad[RAD_CACHE_LINE_SZ - 4 * sizeof(double)];
+};
+typedef struct slot_st slot_t;
+
 struct concurrency_st {
-  /** @brief Workers */
-  worker_t w[RAD_NUM_THREADS + 1];
+  /** @brief Rank of the process */
+  int rank;
+  /** @brief Number of ranks */
+  int nranks;
+  /** @brief Logical part sizes of the ranks */
+  int *counts;
+  /** @brief Logical part offsets of the ranks */
+  int *displs;
+  /** @brief Total logical size */
+  int ls;
+  /** @brief Rank's logical range */
+  range_t g;
+
+  /** @brief Number of worker threads
+   * @details The main thread is not included */
+  int nt;
+  /** @brief Workers
+   * @details Contains nt + 1 elements. The last one is the main thread's. */
+  worker_t *w;
+  /** @brief Number of effort parts
+   * @details Workers are grouped in teams of ne workers. The workers of a team
+   * share a logical range and split the effort loop (see init_pipeline()). */
+  int ne;
+
+  /** @brief Worker data
+   * @details Contains nt elements that persist across solves */
+  struct thread_init_st **tds;
+  /** @brief Worker threads are started */
+  bool pool;
+  /** @brief Job generation
+   * @details Incremented by the main thread to hand a job to the workers */
+  int job;
+  /** @brief Job's worker start function (NULL stops the workers) */
+  rad_thrd_start_t job_main;
+
+  /** @brief Pin threads to processors */
+  bool pin;
+  /** @brief Available processors */
+  int *cpus;
+  /** @brief Number of available processors */
+  int ncpus;
+
+  /** @brief Background checkpointer
+   * @details Created by the first periodic save (see checkpoint()) */
+  ckpt_t *k;
+
+  /** @brief Wall-clock budget in seconds (non-positive values do not limit) */
+  double budget;
+  /** @brief Wall-clock time of the budget's start */
+  double tbeg;
+  /** @brief Wall-clock time of the last iteration's end */
+  double tsync;
+  /** @brief Halt reason of the running solve (see halt_reason()) */
+  int halt;
+
+  /** @brief Live stream writer (NULL if the solve is not streamed)
+   * @details The segment is created by the first publication (see
+   * publish_live()) */
+  stream_t *live;
+  /** @brief Number of iterations between live stream publications */
+  int livecycle;
+
+  /** @brief Solution cache (NULL if the solves are not cached)
+   * @details Holds the key of the setup's configuration (see
+   * cached_solve()) */
+  cache_t *cache;
+
+  /** @brief Warm start variables (NULL for a cold start)
+   * @details Holds the initial value function, quantity policy and effort
+   * policy of the next solve, each one indexed by logical state index (see
+   * setup_warm()) */
+  double *warm;
+  /** @brief The warm start includes the policies */
+  bool warmpol;
+  /** @brief The grid bounds of a continuation warm start are kept (see
+   * setup_continue()) */
+  bool warmfix;
+
+  /** @brief Worker buffer arena
+   * @details Holds the value function and policy buffers of all workers
+   * (unless RAD_ZERO_COPY is set) followed by the data of their local quantity
+   * grids and, if the effort loop is split, the partial results of the
+   * effort parts. */
+  double *buf;
+  /** @brief Worker buffer arena size in number of elements */
+  size_t bufsz;
 
   /** @brief Global upper bound for quantity grid */
   double qM;
@@ -72,19 +242,40 @@ struct concurrency_st {
   /** @brief Global accuracy buffer */
   double accbuf;
 
-#if RAD_NUM_THREADS > 0
-  /** @brief Mutex */
-  mtx_t mtx;
+  /** @brief Worker reduction slots
+   * @details Contains nt + 1 elements */
+  slot_t *r;
+
+#if RAD_MULTITHREADING
+  /** @brief Iteration done count
+   * @details Number of workers that arrived at the barrier */
+  atomic_int it_done_count;
+  /** @brief Padding */
+  char pad1[RAD_CACHE_LINE_SZ - sizeof(atomic_int)];
+  /** @brief Barrier sense
+   * @details Flipped by the main thread to release the workers */
+  atomic_bool sense;
+  /** @brief Padding */
+  char pad2[RAD_CACHE_LINE_SZ - sizeof(atomic_bool)];
+  /** @brief Parked main thread flag */
+  atomic_bool it_done_parked;
+  /** @brief Parked worker count */
+  atomic_int next_ready_parked;
+
+  /** @brief Parking mutex */
+  rad_mtx_t mtx;
   /** @brief Iteration done condition */
-  cnd_t it_done;
+  rad_cnd_t it_done;
   /** @brief Next iteration ready condition */
-  cnd_t next_ready;
-
-  /** @brief Iteration done count */
-  short it_done_count;
-  /** @brief Next iteration ready flag */
-  bool is_next_ready;
-#endif /* RAD_NUM_THREADS */
+  rad_cnd_t next_ready;
+  /** @brief Job ready condition */
+  rad_cnd_t job_ready;
+
+  /** @brief Sum of iteration imbalances */
+  double imbsum;
+  /** @brief Number of measured iterations */
+  int imbn;
+#endif /* RAD_MULTITHREADING */
 };
 typedef struct concurrency_st concurrency_t;
 
@@ -99,16 +290,22 @@ struct thread_init_st {
    * @details Mutable. Workers copy their respective parts here */
   double **pv0;
 
+  /** @brief Worker data */
+  worker_t *w;
+
   /** @brief Local quantity grid */
   grid_t qg;
   /** @brief Local objective variables */
   objvar_t ovar;
 
-  /** @brief Local current value function array buffer */
+  /** @brief Current value function array buffer
+   * @details Indexed by logical state index */
   double *v0buf;
-  /** @brief Local average quantity policy */
+  /** @brief Average quantity policy buffer
+   * @details Indexed by logical state index */
   double *qpolbuf;
-  /** @brief Local effort policy */
+  /** @brief Effort policy buffer
+   * @details Indexed by logical state index */
   double *spolbuf;
 
   /** @brief Worker's wealth state index */
@@ -118,6 +315,11 @@ struct thread_init_st {
   /** @brief Worker's logical state index */
   int li;
 
+  /** @brief Worker's barrier sense */
+  bool sense;
+  /** @brief Buffers are bound to the partial results of the effort part */
+  bool partial;
+
   /** @brief Local maximum quantity policy */
   double qM;
   /** @brief Local maximum effort policy */
@@ -163,20 +365,34 @@ double linterpV12d(const sol_t *s, short x1, short r1, double xp, double rp,
 }
 
 void calc_indices(thread_init_t *td) {
-  td->xi = (td->u->c->w[td->wid].l.o + td->li) / td->u->s->rg->n;
-  td->ri = (td->u->c->w[td->wid].l.o + td->li) % td->u->s->rg->n;
+  td->xi = td->li / td->u->s->rg->n;
+  td->ri = td->li % td->u->s->rg->n;
 }
 
 void init_sovle(thread_init_t *td) {
+  const double *warm = td->u->c->warm;
+  size_t ls = td->u->c->ls;
+
   td->ovar.s = 0;
-  for (td->li = 0; td->li < td->u->c->w[td->wid].l.s; ++td->li) {
-    calc_indices(td);
+  for (td->li = td->w->l.o; td->li < td->w->l.e; ++td->li) {
+    if (warm) {
+      // Warm starts begin from the interpolated saved solution
+      td->v0buf[td->li] = warm[td->li];
+      if (td->u->c->warmpol) {
+        td->qpolbuf[td->li] = warm[ls + td->li];
+        td->spolbuf[td->li] = warm[2 * ls + td->li];
+        td->qM = fmax(td->qM, td->qpolbuf[td->li]);
+        td->sM = fmax(td->sM, td->spolbuf[td->li]);
+      }
+    } else {
+      calc_indices(td);
 
-    td->ovar.x = td->u->s->xg->d[td->xi];
-    td->ovar.r = td->u->s->rg->d[td->ri];
-    td->ovar.q = td->ovar.x / td->ovar.r;
-    td->v0buf[td->li] =
-        td->u->m->util.fnc(&td->ovar) - td->u->m->cost.fnc(&td->ovar);
+      td->ovar.x = td->u->s->xg->d[td->xi];
+      td->ovar.r = td->u->s->rg->d[td->ri];
+      td->ovar.q = td->ovar.x / td->ovar.r;
+      td->v0buf[td->li] =
+          td->u->m->util.fnc(&td->ovar) - td->u->m->cost.fnc(&td->ovar);
+    }
 #ifdef RAD_DEBUG
     if (td->vM < td->v0buf[td->li])
       td->vM = td->v0buf[td->li];
@@ -184,20 +400,17 @@ void init_sovle(thread_init_t *td) {
   }
 }
 
-void step_sovle(thread_init_t *td) {
+void solve_range(thread_init_t *td, int lbeg, int lend) {
   double rp = 0, xp = 0, vp = 0, v = 0, diff = 0, u = 0, c = 0;
+  double vopt = 0, qopt = 0, sopt = 0;
   short rpli = 0, xpli = 0;
 
-  td->acc = 0;
-  td->qM = 0;
-  td->sM = 0;
-  td->vM = 0;
-  for (td->li = 0; td->li < td->u->c->w[td->wid].l.s; ++td->li) {
+  for (td->li = lbeg; td->li < lend; ++td->li) {
     calc_indices(td);
 
     td->ovar.x = td->u->s->xg->d[td->xi];
     td->ovar.r = td->u->s->rg->d[td->ri];
-    for (int si = 0; si < td->u->s->sg->n; ++si) {
+    for (int si = td->w->e.o; si < td->w->e.e; ++si) {
       td->ovar.s = td->u->s->sg->d[si];
       rp = td->u->m->radt.fnc(&td->ovar);
       rpli = grid_liei(td->u->s->rg, rp);
@@ -212,13 +425,17 @@ void step_sovle(thread_init_t *td) {
         c = td->u->m->cost.fnc(&td->ovar);
         v = u - c + td->u->m->beta * vp;
         // Find maximum
-        if ((qi == 0 && si == 0) || td->v0buf[td->li] < v) {
-          td->v0buf[td->li] = v;
-          td->qpolbuf[td->li] = td->qg.d[qi];
-          td->spolbuf[td->li] = td->u->s->sg->d[si];
+        if ((qi == 0 && si == td->w->e.o) || vopt < v) {
+          vopt = v;
+          qopt = td->qg.d[qi];
+          sopt = td->u->s->sg->d[si];
         }
       }
     }
+    // Single write per state to the (possibly shared) output arrays
+    td->v0buf[td->li] = vopt;
+    td->qpolbuf[td->li] = qopt;
+    td->spolbuf[td->li] = sopt;
     diff = fabs(td->v0buf[td->li] - td->u->s->v1[td->xi][td->ri]);
     if (td->acc < diff)
       td->acc = diff;
@@ -231,132 +448,433 @@ void step_sovle(thread_init_t *td) {
   }
 }
 
-void copybufs(thread_init_t *td) {
-  for (td->li = 0; td->li < td->u->c->w[td->wid].l.s; ++td->li) {
+void copy_range(thread_init_t *td, int lbeg, int lend) {
+  for (td->li = lbeg; td->li < lend; ++td->li) {
     calc_indices(td);
     td->u->s->v0[td->xi][td->ri] = td->v0buf[td->li];
     td->u->s->spol[td->xi][td->ri] = td->spolbuf[td->li];
     td->u->s->qpol[td->xi][td->ri] = td->qpolbuf[td->li];
   }
+}
+
+#if RAD_MULTITHREADING && RAD_CHUNK_SIZE > 0
+#define DEQUE_HEAD(ht) ((uint_least32_t)((ht)&0xFFFFFFFF))
+#define DEQUE_TAIL(ht) ((uint_least32_t)((ht) >> 32))
+#define DEQUE_PACK(h, t) (((uint_least64_t)(t) << 32) | (uint_least64_t)(h))
+
+void fill_deque(worker_t *w) {
+  atomic_store_explicit(&w->q.ht, DEQUE_PACK(w->k.o, w->k.e),
+                        memory_order_relaxed);
+}
 
+bool pop_chunk(deque_t *q, int *k) {
+  uint_least64_t ht = atomic_load_explicit(&q->ht, memory_order_relaxed);
+  do {
+    if (DEQUE_HEAD(ht) >= DEQUE_TAIL(ht)) {
+      return false;
+    }
+  } while (!atomic_compare_exchange_weak(&q->ht, &ht, ht + 1));
+  *k = DEQUE_HEAD(ht);
+  return true;
+}
+
+bool steal_chunk(deque_t *q, int *k) {
+  uint_least64_t ht = atomic_load_explicit(&q->ht, memory_order_relaxed);
+  do {
+    if (DEQUE_HEAD(ht) >= DEQUE_TAIL(ht)) {
+      return false;
+    }
+  } while (!atomic_compare_exchange_weak(&q->ht, &ht,
+                                         ht - ((uint_least64_t)1 << 32)));
+  *k = DEQUE_TAIL(ht) - 1;
+  return true;
+}
+
+/** Acquire next chunk
+ * @details Pops a chunk from the worker's own deque. If the deque is empty,
+ * it tries to steal a chunk from the tails of the other workers' deques.
+ * Chunks are not added during an iteration, thus the iteration's work is
+ * exhausted when all deques are found empty. */
+bool next_chunk(thread_init_t *td, int *k) {
+  if (pop_chunk(&td->w->q, k)) {
+    return true;
+  }
+  for (int i = 1; i <= td->u->c->nt; ++i) {
+    int v = (td->wid + i) % (td->u->c->nt + 1);
+    if (steal_chunk(&td->u->c->w[v].q, k)) {
+      ++td->w->steals;
+      return true;
+    }
+  }
+  return false;
+}
+#endif /* RAD_MULTITHREADING && RAD_CHUNK_SIZE */
+
+/** Bind output buffers
+ * @details In zero-copy mode, the output buffers are the shared value function
+ * and policy arrays. Their rows are contiguous in the solution's memory arena,
+ * so they can be indexed by logical state index. The current value function
+ * array changes with every swap and is re-bound before every iteration.
+ * Otherwise, the buffers are slices of the concurrency arena and are copied to
+ * the shared arrays after they are calculated. */
+void bind_buffers(thread_init_t *td) {
+#if RAD_ZERO_COPY
+  td->v0buf = td->u->s->v0[0];
+  td->qpolbuf = td->u->s->qpol[0];
+  td->spolbuf = td->u->s->spol[0];
+#else
+  size_t ls = td->u->c->ls;
+  td->v0buf = td->u->c->buf;
+  td->qpolbuf = td->u->c->buf + ls;
+  td->spolbuf = td->u->c->buf + 2 * ls;
+#endif /* RAD_ZERO_COPY */
+}
+
+/** First touch
+ * @details Zeroes the worker's static range of the value function and policy
+ * arrays. The arrays are allocated but not initialized by the main thread, thus
+ * their memory pages are placed on the NUMA node of the worker that touches
+ * them first. Together with thread pinning, each worker then mostly accesses
+ * node-local memory. */
+void first_touch(thread_init_t *td) {
+  size_t sz = (size_t)td->w->l.s * sizeof(double);
+  memset(td->u->s->v0[0] + td->w->l.o, 0, sz);
+  memset(td->u->s->v1[0] + td->w->l.o, 0, sz);
+  memset(td->u->s->qpol[0] + td->w->l.o, 0, sz);
+  memset(td->u->s->spol[0] + td->w->l.o, 0, sz);
+}
+
+size_t buffers_size(const setup_t *u);
+
+/** Bind partial buffers
+ * @details If the effort loop is split, the workers of a team calculate the
+ * maximum over their effort part for the same states. The partial results are
+ * stored in per-part slices of the concurrency arena that are indexed by
+ * logical state index. They are combined by the main thread (see
+ * reduce_parts()). */
+void bind_partial(thread_init_t *td) {
+  size_t ls = td->u->c->ls;
+  double *part = td->u->c->buf + buffers_size(td->u) +
+                 (size_t)(td->u->c->nt + 1) * td->u->s->qg->n;
+  td->v0buf = part + 3 * ls * td->w->ei;
+  td->qpolbuf = td->v0buf + ls;
+  td->spolbuf = td->v0buf + 2 * ls;
+  td->partial = true;
+}
+
+void init_step(thread_init_t *td) {
+  td->partial = false;
+  bind_buffers(td);
+  // The initial values do not depend on effort. They are calculated by the
+  // first part of a team.
+  if (td->w->ei) {
+    return;
+  }
+  first_touch(td);
+  init_sovle(td);
+#if !RAD_ZERO_COPY && RAD_MULTITHREADING && RAD_CHUNK_SIZE > 0
+  // The initialization uses the static ranges
+  copy_range(td, td->w->l.o, td->w->l.e);
+#endif /* RAD_ZERO_COPY, RAD_MULTITHREADING && RAD_CHUNK_SIZE */
+}
+
+void step_sovle(thread_init_t *td) {
+#if RAD_MULTITHREADING
+  double tbeg = rad_wall_time();
+#endif /* RAD_MULTITHREADING */
+
+  td->acc = 0;
+  td->qM = 0;
+  td->sM = 0;
+  td->vM = 0;
+#if RAD_MULTITHREADING
+  if (td->u->c->ne > 1) {
+    // Teams use static ranges
+    bind_partial(td);
+    solve_range(td, td->w->l.o, td->w->l.e);
+    td->w->states += td->w->l.s;
+    td->w->tit = rad_wall_time() - tbeg;
+    td->w->tbusy += td->w->tit;
+    return;
+  }
+#endif /* RAD_MULTITHREADING */
+  bind_buffers(td);
+#if RAD_MULTITHREADING && RAD_CHUNK_SIZE > 0
+  int k = 0, lbeg = 0, lend = 0;
+  while (next_chunk(td, &k)) {
+    lbeg = td->u->c->g.o + k * CHUNK_SZ;
+    lend = __min__(lbeg + CHUNK_SZ, td->u->c->g.e);
+    solve_range(td, lbeg, lend);
+#if !RAD_ZERO_COPY
+    // Chunks are disjoint, thus they can be copied without locking
+    copy_range(td, lbeg, lend);
+#endif /* RAD_ZERO_COPY */
+    td->w->states += lend - lbeg;
+  }
+#else
+  solve_range(td, td->w->l.o, td->w->l.e);
+#if RAD_MULTITHREADING
+  td->w->states += td->w->l.s;
+#endif /* RAD_MULTITHREADING */
+#endif /* RAD_MULTITHREADING && RAD_CHUNK_SIZE */
+
+#if RAD_MULTITHREADING
+  td->w->tit = rad_wall_time() - tbeg;
+  td->w->tbusy += td->w->tit;
+#endif /* RAD_MULTITHREADING */
+}
+
+void copybufs(thread_init_t *td) {
+#if !RAD_ZERO_COPY && (!RAD_MULTITHREADING || RAD_CHUNK_SIZE == 0)
+  // With dynamic scheduling, chunks are copied on completion. Partial results
+  // are combined by the main thread. Only the first part of a team calculates
+  // the initial values.
+  if (!td->partial && !td->w->ei) {
+    copy_range(td, td->w->l.o, td->w->l.e);
+  }
+#endif /* RAD_ZERO_COPY, RAD_MULTITHREADING && RAD_CHUNK_SIZE */
+
+  // Publish the local maxima. They are combined after the barrier by the
+  // main thread (see reduce_slots()).
+  td->u->c->r[td->wid].acc = td->acc;
+  td->u->c->r[td->wid].qM = td->qM;
+  td->u->c->r[td->wid].sM = td->sM;
+  td->u->c->r[td->wid].vM = td->vM;
+}
+
+void reduce_slots(const setup_t *u) {
   // if local maximum policy and accuracy values are greater than the
   // values of the global buffers, copy them.
-  if (td->u->c->accbuf < td->acc)
-    td->u->c->accbuf = td->acc;
-  if (td->u->c->sMbuf < td->sM)
-    td->u->c->sMbuf = td->sM;
-  if (td->u->c->qMbuf < td->qM)
-    td->u->c->qMbuf = td->qM;
-  if (td->u->c->vMbuf < td->vM)
-    td->u->c->vMbuf = td->vM;
+  for (int i = 0; i <= u->c->nt; ++i) {
+    if (u->c->accbuf < u->c->r[i].acc)
+      u->c->accbuf = u->c->r[i].acc;
+    if (u->c->sMbuf < u->c->r[i].sM)
+      u->c->sMbuf = u->c->r[i].sM;
+    if (u->c->qMbuf < u->c->r[i].qM)
+      u->c->qMbuf = u->c->r[i].qM;
+    if (u->c->vMbuf < u->c->r[i].vM)
+      u->c->vMbuf = u->c->r[i].vM;
+  }
 }
 
+/** Reduce partial results
+ * @details Combines the partial results of the effort parts. For every state,
+ * the part with the greatest value is selected. Parts cover consecutive effort
+ * ranges and they are visited in order, so that ties are resolved as in the
+ * unsplit effort loop. The selected values are written to the shared arrays and
+ * the global buffers are updated.
+ * @param u Execution setup */
+void reduce_parts(const setup_t *u) {
+  size_t ls = u->c->ls;
+  const double *part =
+      u->c->buf + buffers_size(u) + (size_t)(u->c->nt + 1) * u->s->qg->n;
+  double *v0 = u->s->v0[0], *qpol = u->s->qpol[0], *spol = u->s->spol[0];
+  const double *v1 = u->s->v1[0];
+
+  for (size_t li = u->c->g.o; li < (size_t)u->c->g.e; ++li) {
+    size_t best = li;
+    for (int ei = 1; ei < u->c->ne; ++ei) {
+      if (part[best] < part[3 * ls * ei + li]) {
+        best = 3 * ls * ei + li;
+      }
+    }
+    v0[li] = part[best];
+    qpol[li] = part[best + ls];
+    spol[li] = part[best + 2 * ls];
+
+    double diff = fabs(v0[li] - v1[li]);
+    if (u->c->accbuf < diff)
+      u->c->accbuf = diff;
+    if (u->c->qMbuf < qpol[li])
+      u->c->qMbuf = qpol[li];
+    if (u->c->sMbuf < spol[li])
+      u->c->sMbuf = spol[li];
+    if (u->c->vMbuf < v0[li])
+      u->c->vMbuf = v0[li];
+  }
+}
+
+/* The iteration barrier is sense-reversing. Workers increment the done count
+ * on arrival and wait until the global sense matches their local sense. The
+ * main thread waits until all workers have arrived, performs the serial part
+ * of the iteration and then flips the global sense. Waiting threads spin for
+ * BARRIER_SPIN_COUNT polls and then park on a condition variable. Wakers only
+ * take the mutex if some thread is parked. */
+
 void lock_mutex(thread_init_t *td) {
-#if RAD_NUM_THREADS > 0
-  mtx_lock(&td->u->c->mtx);
+#if RAD_MULTITHREADING
+  rad_mtx_lock(&td->u->c->mtx);
 #endif
 }
 
+void unlock_mutex(thread_init_t *td) {
+#if RAD_MULTITHREADING
+  rad_mtx_unlock(&td->u->c->mtx);
+#endif
+}
+
+#if RAD_MULTITHREADING
+// Sequentially consistent loads, so that the parked flags and the barrier
+// state cannot be observed out of order by the waker and the parker.
+bool is_next_ready(thread_init_t *td) {
+  return atomic_load(&td->u->c->sense) == td->sense;
+}
+
+bool is_it_done(thread_init_t *td) {
+  return atomic_load(&td->u->c->it_done_count) == td->u->c->nt;
+}
+#endif /* RAD_MULTITHREADING */
+
 void wait_next_ready(thread_init_t *td) {
-#if RAD_NUM_THREADS > 0
-  cnd_wait(&td->u->c->next_ready, &td->u->c->mtx);
+#if RAD_MULTITHREADING
+  for (int i = 0; i < BARRIER_SPIN_COUNT; ++i) {
+    if (is_next_ready(td)) {
+      return;
+    }
+  }
+  atomic_fetch_add(&td->u->c->next_ready_parked, 1);
+  lock_mutex(td);
+  while (!is_next_ready(td)) {
+    rad_cnd_wait(&td->u->c->next_ready, &td->u->c->mtx);
+  }
+  unlock_mutex(td);
+  atomic_fetch_sub(&td->u->c->next_ready_parked, 1);
 #endif
 }
 
 void wait_it_done(thread_init_t *td) {
-#if RAD_NUM_THREADS > 0
-  cnd_wait(&td->u->c->it_done, &td->u->c->mtx);
+#if RAD_MULTITHREADING
+  for (int i = 0; i < BARRIER_SPIN_COUNT; ++i) {
+    if (is_it_done(td)) {
+      return;
+    }
+  }
+  atomic_store(&td->u->c->it_done_parked, true);
+  lock_mutex(td);
+  while (!is_it_done(td)) {
+    rad_cnd_wait(&td->u->c->it_done, &td->u->c->mtx);
+  }
+  unlock_mutex(td);
+  atomic_store(&td->u->c->it_done_parked, false);
 #endif
 }
 
 void signal_done(thread_init_t *td) {
-#if RAD_NUM_THREADS > 0
-  cnd_signal(&td->u->c->it_done);
+#if RAD_MULTITHREADING
+  atomic_fetch_add(&td->u->c->it_done_count, 1);
+  if (atomic_load(&td->u->c->it_done_parked)) {
+    lock_mutex(td);
+    rad_cnd_signal(&td->u->c->it_done);
+    unlock_mutex(td);
+  }
 #endif
 }
 
 void broadcast_ready(thread_init_t *td) {
-#if RAD_NUM_THREADS > 0
-  cnd_broadcast(&td->u->c->next_ready);
-#endif
-}
-
-void unlock_mutex(thread_init_t *td) {
-#if RAD_NUM_THREADS > 0
-  mtx_unlock(&td->u->c->mtx);
+#if RAD_MULTITHREADING
+  // The done count is reset before the release, so that workers can arrive
+  // at the next barrier as soon as they observe the flipped sense.
+  atomic_store_explicit(&td->u->c->it_done_count, 0, memory_order_relaxed);
+  atomic_store(&td->u->c->sense, td->sense);
+  if (atomic_load(&td->u->c->next_ready_parked)) {
+    lock_mutex(td);
+    rad_cnd_broadcast(&td->u->c->next_ready);
+    unlock_mutex(td);
+  }
 #endif
 }
 
 void worker_sync(thread_init_t *td) {
-#if RAD_NUM_THREADS > 0
-  lock_mutex(td);
-
-  // copy to global memory
+#if RAD_MULTITHREADING
+  // copy to global memory (ranges are disjoint)
   copybufs(td);
 
-  // signal done
-  ++td->u->c->it_done_count;
+  // signal done and wait until ready for next iteration
+  td->sense = !td->sense;
   signal_done(td);
+  wait_next_ready(td);
+#endif /* RAD_MULTITHREADING */
+}
 
-  // wait until ready for next iteration
-  if (!td->u->c->is_next_ready) {
-    wait_next_ready(td);
-  }
+size_t partials_size(const setup_t *u) {
+  return u->c->ne > 1 ? 3 * (size_t)u->c->ne * u->c->ls : 0;
+}
 
-  unlock_mutex(td);
-#endif /* RAD_NUM_THREADS */
+size_t buffers_size(const setup_t *u) {
+#if RAD_ZERO_COPY
+  return 0;
+#else
+  return 3 * (size_t)u->c->ls;
+#endif /* RAD_ZERO_COPY */
 }
 
 void alloc_thread_init(thread_init_t *td) {
+  const concurrency_t *c = td->u->c;
+
+  // The buffers are slices of the concurrency arena (see alloc_buffers())
   td->ovar.m = td->u->m;
-  td->v0buf = (double *)calloc(td->u->c->w[td->wid].l.s, sizeof(double));
-  td->qpolbuf = (double *)calloc(td->u->c->w[td->wid].l.s, sizeof(double));
-  td->spolbuf = (double *)calloc(td->u->c->w[td->wid].l.s, sizeof(double));
-  grid_copy(&td->qg, td->u->s->qg);
+  td->w = &td->u->c->w[td->wid];
+  bind_buffers(td);
+  td->qg = *td->u->s->qg;
+  td->qg.d = c->buf + buffers_size(td->u) + (size_t)td->wid * td->qg.n;
+  memcpy(td->qg.d, td->u->s->qg->d, td->qg.n * sizeof(double));
 }
 
 void free_thread_init(thread_init_t *td) {
-  grid_free(&td->qg);
-  free(td->spolbuf);
-  free(td->qpolbuf);
-  free(td->v0buf);
+  // Buffers are owned by the concurrency arena
+  td->v0buf = td->qpolbuf = td->spolbuf = td->qg.d = NULL;
+}
+
+void pin_worker(const thread_init_t *td) {
+  const concurrency_t *c = td->u->c;
+  if (c->pin && pin_thread(c->cpus[td->wid % c->ncpus]) != 0) {
+    LOGW("Failed to pin worker %d to processor %d", td->wid,
+         c->cpus[td->wid % c->ncpus]);
+  }
+}
+
+/** Iteration condition
+ * @param u Execution setup
+ * @return True if the solve is neither converged nor halted */
+bool iterating(const setup_t *u) {
+  return u->s->acc >= u->s->tol && u->c->halt == HALT_NONE;
 }
 
 int thread_start(void *vtd) {
-#if RAD_NUM_THREADS > 0
+#if RAD_MULTITHREADING
   thread_init_t *td = (thread_init_t *)vtd;
+  rad_ctx_set(td->u->x);
 
   LOGT("Worker %d starting", td->wid);
+  pin_worker(td);
   alloc_thread_init(td);
 
-  init_sovle(td);
+  init_step(td);
   worker_sync(td);
 
-  while (td->u->s->acc >= td->u->s->tol) {
+  while (iterating(td->u)) {
     step_sovle(td);
     worker_sync(td);
   }
 
   LOGT("Worker %d exiting", td->wid);
 
+  // The worker's data are owned by the concurrency data (see run_team())
   free_thread_init(td);
-  // The worker's data are dynamically allocated. Main's data is not,
-  // thus this cannot be part of free_thread_init()
-  free(td);
-  thrd_exit(EXIT_SUCCESS);
-#else
+#endif /* RAD_MULTITHREADING */
   return EXIT_SUCCESS;
-#endif /* RAD_NUM_THREADS */  
 }
 
 int thread_resume(void *vtd) {
-#if RAD_NUM_THREADS > 0
+#if RAD_MULTITHREADING
   thread_init_t *td = (thread_init_t *)vtd;
+  rad_ctx_set(td->u->x);
 
   LOGT("Worker %d resuming", td->wid);
+  pin_worker(td);
   alloc_thread_init(td);
 
-  while (td->u->s->acc >= td->u->s->tol) {
+  while (iterating(td->u)) {
     LOGT("Thread %d starts iteration", td->wid);
     step_sovle(td);
     worker_sync(td);
@@ -365,81 +883,175 @@ int thread_resume(void *vtd) {
 
   LOGT("Worker %d exiting", td->wid);
 
+  // The worker's data are owned by the concurrency data (see run_team())
   free_thread_init(td);
-  // The worrke's data are dynamically allocated. Main's data is not,
-  // thus this cannot be part of free_thread_init()
-  free(td);
-
-  thrd_exit(EXIT_SUCCESS);
-#else
+#endif /* RAD_MULTITHREADING */
   return EXIT_SUCCESS;
-#endif /* RAD_NUM_THREADS */
+}
 
+#if RAD_MULTITHREADING && RAD_CHUNK_SIZE > 0
+/** Initialize chunks
+ * @details Cuts the rank's logical range into chunks of RAD_CHUNK_SIZE states
+ * (rounded up to whole cache lines)
+ * and assigns contiguous chunk ranges to the workers in the same way as
+ * init_pipeline() assigns state ranges. The chunk ranges are the initial
+ * contents of the worker deques of every iteration.
+ * @param u Execution setup */
+void init_chunks(setup_t *u) {
+  int kn = (u->c->g.s + CHUNK_SZ - 1) / CHUNK_SZ;
+  int ks = kn / (u->c->nt + 1);
+  int rem = kn % (u->c->nt + 1);
+
+  for (int i = 0; i <= u->c->nt; ++i) {
+    u->c->w[i].k.o = (i == 0) ? 0 : u->c->w[i - 1].k.e;
+    u->c->w[i].k.s = (i < rem) ? ks + 1 : ks;
+    u->c->w[i].k.e = u->c->w[i].k.o + u->c->w[i].k.s;
+    fill_deque(&u->c->w[i]);
+  }
+}
+#endif /* RAD_MULTITHREADING && RAD_CHUNK_SIZE */
+
+/** Split effort loop
+ * @details Chooses the number of effort parts. State-level parallelism is
+ * preferred. The effort loop is split only if the states of a worker would be
+ * less than MIN_PART_STATES, which is typical for small grids on many cores.
+ * The number of parts is then increased to the next divisor of the thread
+ * count until every team has enough states or the effort grid cannot be split
+ * further.
+ * @param u Execution setup
+ * @return Number of effort parts */
+int split_effort(const setup_t *u) {
+  int nt = u->c->nt + 1;
+  int ne = 1;
+
+  while (u->c->g.s / (nt / ne) < MIN_PART_STATES) {
+    int d = ne + 1;
+    while (d <= nt && nt % d) {
+      ++d;
+    }
+    if (d > nt || d > u->s->sg->n) {
+      break;
+    }
+    ne = d;
+  }
+  return ne;
+}
+
+/** Split in lines
+ * @details Splits a logical range in whole cache lines of the shared arrays.
+ * The first parts get an extra line if the lines cannot be split evenly.
+ * @param r Output range of the part
+ * @param o Offset of the logical range (at a line boundary)
+ * @param e End of the logical range
+ * @param i Part index
+ * @param n Number of parts */
+void split_lines(range_t *r, int o, int e, int i, int n) {
+  int lines = (e - o + STATES_PER_LINE - 1) / STATES_PER_LINE;
+  int qs = lines / n;
+  int rem = lines % n;
+  r->o = __min__(o + (i * qs + __min__(i, rem)) * STATES_PER_LINE, e);
+  r->e = __min__(o + ((i + 1) * qs + __min__(i + 1, rem)) * STATES_PER_LINE, e);
+  r->s = r->e - r->o;
 }
 
 /** Initialize pipeline
  * @details Expects that the worker array is already allocated
- * with RAD_NUM_THREADS (workers) + 1 (main thread) elements.
+ * with nt (workers) + 1 (main thread) elements (see alloc_workers()).
  * The worker threads should be lunched after this function call.
- * By convention, the first RAD_NUM_THREADS worker
+ * By convention, the first nt worker
  * objects correspond to the slave system threads and the last
- * object to the main thread.
+ * object to the main thread. The logical index space is first split among
+ * the ranks (see rad_mpi.h). Workers are grouped in teams of ne consecutive
+ * workers (see split_effort()). The rank's logical range is split among the
+ * teams, and the effort grid among the workers of a team. Work is split in
+ * whole cache lines of the shared arrays, so that neighbouring teams never
+ * write to the same line.
  * @param u Execution setup */
 void init_pipeline(setup_t *u) {
   // Total logical size
-  u->c->w[RAD_NUM_THREADS].l.e = u->s->xg->n * u->s->rg->n;
-  // Quotient work size
-  u->c->w[RAD_NUM_THREADS].l.s =
-      u->c->w[RAD_NUM_THREADS].l.e / (RAD_NUM_THREADS + 1);
-  // Remainder work size
-  int rem = u->c->w[RAD_NUM_THREADS].l.e % (RAD_NUM_THREADS + 1);
-
-  u->c->w[RAD_NUM_THREADS].x.e = u->s->xg->n;
-  u->c->w[RAD_NUM_THREADS].r.e = u->s->rg->n;
-
-  u->c->w[0].x.o = u->c->w[0].r.o = u->c->w[0].l.o = 0;
-  for (int i = 1; i <= RAD_NUM_THREADS; ++i) {
-    // Previous worker's logical size
-    u->c->w[i - 1].l.s = (i < rem) ? u->c->w[RAD_NUM_THREADS].l.s + 1
-                                   : u->c->w[RAD_NUM_THREADS].l.s;
-    // Current worker's logical offset = previous worker's logical end
-    u->c->w[i].l.o = u->c->w[i - 1].l.e =
-        u->c->w[i - 1].l.o + u->c->w[i - 1].l.s;
-    // Current worker's wealth offset = previous worker's wealth end
-    u->c->w[i].x.o = u->c->w[i - 1].x.e = u->c->w[i].l.o / u->s->rg->n;
-    // Previous worker's wealth size
-    u->c->w[i - 1].x.s = u->c->w[i - 1].x.e - u->c->w[i - 1].x.o;
-    // Current worker's radius offset = previous worker's radius end
-    u->c->w[i].r.o = u->c->w[i - 1].r.e = u->c->w[i].l.o % u->s->rg->n;
-    // Previous worker's radius size
-    u->c->w[i - 1].r.s = u->c->w[i - 1].r.e - u->c->w[i - 1].r.o;
-  }
-  u->c->w[RAD_NUM_THREADS].x.s =
-      u->c->w[RAD_NUM_THREADS].x.e - u->c->w[RAD_NUM_THREADS].x.o;
-  u->c->w[RAD_NUM_THREADS].r.s =
-      u->c->w[RAD_NUM_THREADS].r.e - u->c->w[RAD_NUM_THREADS].r.o;
+  u->c->ls = u->s->xg->n * u->s->rg->n;
+  // Rank's logical range
+  for (int i = 0; i < u->c->nranks; ++i) {
+    range_t g;
+    split_lines(&g, 0, u->c->ls, i, u->c->nranks);
+    u->c->counts[i] = g.s;
+    u->c->displs[i] = g.o;
+    if (i == u->c->rank) {
+      u->c->g = g;
+    }
+  }
+
+  u->c->ne = split_effort(u);
+  if (u->c->ne > 1) {
+    LOGI("Splitting effort loop in %d parts", u->c->ne);
+  }
+
+  int sn = u->s->sg->n;
+  int teams = (u->c->nt + 1) / u->c->ne;
+
+  for (int i = 0; i <= u->c->nt; ++i) {
+    worker_t *w = &u->c->w[i];
+    w->ei = i % u->c->ne;
+
+    // Team's logical range
+    split_lines(&w->l, u->c->g.o, u->c->g.e, i / u->c->ne, teams);
+    // Wealth and radius ranges
+    w->x.o = w->l.o / u->s->rg->n;
+    w->r.o = w->l.o % u->s->rg->n;
+    w->x.e = w->l.e / u->s->rg->n;
+    w->r.e = w->l.e % u->s->rg->n;
+    w->x.s = w->x.e - w->x.o;
+    w->r.s = w->r.e - w->r.o;
+    // Effort range
+    w->e.o = w->ei * sn / u->c->ne;
+    w->e.e = (w->ei + 1) * sn / u->c->ne;
+    w->e.s = w->e.e - w->e.o;
+  }
+  // The last worker ends at the end of the state space
+  u->c->w[u->c->nt].x.e = u->s->xg->n;
+  u->c->w[u->c->nt].r.e = u->s->rg->n;
+  u->c->w[u->c->nt].x.s =
+      u->c->w[u->c->nt].x.e - u->c->w[u->c->nt].x.o;
+  u->c->w[u->c->nt].r.s =
+      u->c->w[u->c->nt].r.e - u->c->w[u->c->nt].r.o;
+
+#if RAD_MULTITHREADING && RAD_CHUNK_SIZE > 0
+  init_chunks(u);
+#endif /* RAD_MULTITHREADING && RAD_CHUNK_SIZE */
 }
 
 int join_thread(const setup_t *u, int i) {
-#if RAD_NUM_THREADS > 0
-  return thrd_join(u->c->w[i].thread, NULL);
+#if RAD_MULTITHREADING
+  return rad_thrd_join(u->c->w[i].thread);
 #else
   return EXIT_SUCCESS;
 #endif
 }
 
+void alloc_buffers(setup_t *u) {
+  size_t sz = buffers_size(u) + (u->c->nt + 1) * (size_t)u->s->qg->n +
+              partials_size(u);
+  // Grow only, so that repeated solves of the same shapes reuse the arena
+  if (sz > u->c->bufsz) {
+    rad_free(u->c->buf);
+    u->c->buf = (double *)rad_alloc(sz * sizeof(double));
+    u->c->bufsz = sz;
+  }
+}
+
 void free_sync_resources(setup_t *u) {
-#if RAD_NUM_THREADS > 0
-  cnd_destroy(&u->c->next_ready);
-  cnd_destroy(&u->c->it_done);
-  mtx_destroy(&u->c->mtx);
+#if RAD_MULTITHREADING
+  rad_cnd_destroy(&u->c->job_ready);
+  rad_cnd_destroy(&u->c->next_ready);
+  rad_cnd_destroy(&u->c->it_done);
+  rad_mtx_destroy(&u->c->mtx);
 #endif
 }
 
 void join_all_threads(const setup_t *u) {
-#if RAD_NUM_THREADS > 0
+#if RAD_MULTITHREADING
   int ec = 0;
-  for (int i = 0; i < RAD_NUM_THREADS; ++i) {
+  for (int i = 0; i < u->c->nt; ++i) {
     ec = join_thread(u, i);
     if (ec != 0) {
       LOGE("Failed to join thread with code %d", ec);
@@ -448,42 +1060,92 @@ void join_all_threads(const setup_t *u) {
 #endif
 }
 
+void stop_pool(setup_t *u);
+
 /** @brief Setup disallocation
- * @details Frees setup's dynamically allocated memory.
+ * @details Stops the setup's worker threads and frees its dynamically
+ * allocated memory.
  * @param u Setup object to be destroyed. */
 void setup_free(setup_t *u) {
+  rad_ctx_set(u->x);
+  stop_pool(u);
+  if (u->c->k) {
+    ckpt_free(u->c->k);
+    free(u->c->k);
+  }
   free_sync_resources(u);
   solution_free(u->s);
+  free(u->c->warm);
+  if (u->c->live) {
+    stream_free(u->c->live);
+    free(u->c->live);
+  }
+  if (u->c->cache) {
+    cache_free(u->c->cache);
+    free(u->c->cache);
+  }
+  rad_free(u->c->buf);
+  rad_free(u->c->w);
+  rad_free(u->c->r);
+  free(u->c->cpus);
+  for (int i = 0; i < u->c->nt; ++i) {
+    rad_free(u->c->tds[i]);
+  }
+  free(u->c->tds);
+  free(u->c->counts);
+  free(u->c->displs);
   free(u->c);
 }
 
 /** @brief Save setup
- * @details Consolidates model and solution saving functionality. The format and
- * naming conventions of the saved binary data are set in the model_save() and
- * solution_save() functions.
+ * @details Saves the model and the solution in a single container file. The
+ * format of the file is described in rad_file.h. If the solver runs on several
+ * ranks, only rank zero saves.
  * @param u Setup to be saved
- * @param setup_path Path where binary model and solution data are to be stored
- */
-void setup_save(const setup_t *u, const char *setup_path) {
-  model_save(u->m, setup_path);
-  solution_save(u->s, setup_path);
+ * @param setup_path Save path relative to the output directory and without
+ * extension (e.g. `msol` is saved as `msol.rad`)
+ * @return Zero on success, non-zero otherwise */
+int setup_save(const setup_t *u, const char *setup_path) {
+  rad_ctx_set(u->x);
+  if (u->c->rank != 0) {
+    return 0;
+  }
+  return rad_file_save(u->m, u->s, setup_path);
 }
 
-void init_sync_resources(setup_t *u) {
-#if RAD_NUM_THREADS > 0
-  mtx_init(&u->c->mtx, mtx_plain);
-  cnd_init(&u->c->it_done);
-  cnd_init(&u->c->next_ready);
+/** @brief Append setup to sweep
+ * @details Appends the solution to a parameter sweep store (see rad_sweep.h).
+ * If the solver runs on several ranks, only rank zero appends.
+ * @param u Solved setup
+ * @param w Sweep store
+ * @param value Parameter value of the solution
+ * @return Zero on success, non-zero otherwise */
+int setup_sweep(const setup_t *u, struct sweep_st *w, double value) {
+  rad_ctx_set(u->x);
+  if (u->c->rank != 0) {
+    return 0;
+  }
+  return sweep_append(w, u->s, value);
+}
 
-  u->c->it_done_count = 0;
-  u->c->is_next_ready = false;
+void init_sync_resources(setup_t *u) {
+#if RAD_MULTITHREADING
+  rad_mtx_init(&u->c->mtx);
+  rad_cnd_init(&u->c->it_done);
+  rad_cnd_init(&u->c->next_ready);
+  rad_cnd_init(&u->c->job_ready);
+
+  atomic_init(&u->c->it_done_count, 0);
+  atomic_init(&u->c->sense, false);
+  atomic_init(&u->c->it_done_parked, false);
+  atomic_init(&u->c->next_ready_parked, 0);
 #endif
 }
 
-void create_thread(thread_init_t *td, int i, thrd_start_t thread_main) {
+void create_thread(thread_init_t *td, int i, rad_thrd_start_t thread_main) {
   int status = 0;
-#if RAD_NUM_THREADS > 0
-  status = thrd_create(&td->u->c->w[i].thread, thread_main, td);
+#if RAD_MULTITHREADING
+  status = rad_thrd_create(&td->u->c->w[i].thread, thread_main, td);
 #endif
 
   if (status != 0) {
@@ -491,8 +1153,195 @@ void create_thread(thread_init_t *td, int i, thrd_start_t thread_main) {
   }
 }
 
-void init_concurrency(setup_t *u) {
+void *calloc_lines(size_t n, size_t size) {
+  void *ptr = rad_alloc(n * size);
+  if (ptr) {
+    memset(ptr, 0, n * size);
+  }
+  return ptr;
+}
+
+/** Configure threads
+ * @details Sets the number of worker threads and the thread pinning. The
+ * number of worker threads is taken from the `threads` key of the parameter
+ * map, or else from the RAD_NUM_THREADS environment variable, or else from the
+ * RAD_NUM_THREADS configuration value. If the resulting number is negative, it
+ * is set to the number of available processors minus one. Available processors
+ * respect the process' affinity mask and cgroup CPU quota. A non-negative
+ * thread budget of the setup's context overrides the above. Pinning is
+ * similarly controlled by the `pin` key and the RAD_PIN_THREADS environment
+ * variable.
+ * @param u Execution setup
+ * @param pmap Parameter map (can be NULL) */
+void config_threads(setup_t *u, const struct pmap_st *pmap) {
+  int nt = RAD_NUM_THREADS;
+  bool pin = false;
+
+  // The processors are listed before any thread is pinned
+  u->c->ncpus = cpus_available(NULL, 0);
+  u->c->cpus = (int *)malloc(u->c->ncpus * sizeof(int));
+  cpus_available(u->c->cpus, u->c->ncpus);
+
+#if RAD_MULTITHREADING
+  const char *val = NULL;
+  if ((pmap && (val = pmap_find(pmap, "threads"))) ||
+      (val = getenv("RAD_NUM_THREADS"))) {
+    nt = atoi(val);
+  }
+  if (rad_ctx_get()->threads >= 0) {
+    nt = rad_ctx_get()->threads;
+  }
+  if (nt < 0) {
+    nt = u->c->ncpus - 1;
+  }
+  if ((pmap && (val = pmap_find(pmap, "pin"))) ||
+      (val = getenv("RAD_PIN_THREADS"))) {
+    pin = atoi(val) != 0;
+  }
+#endif /* RAD_MULTITHREADING */
+
+  u->c->nt = nt;
+  u->c->pin = pin;
+  LOGI("Using %d worker threads (%s backend) on %d available processors%s",
+       nt, RAD_THREAD_BACKEND, u->c->ncpus, pin ? " (pinned)" : "");
+}
+
+/** Configure budget
+ * @details Sets the wall-clock budget of the setup's solves in seconds. The
+ * budget is taken from the `budget` key of the parameter map, or else from the
+ * RAD_TIME_BUDGET environment variable. It starts with the configuration, i.e.
+ * it is shared by the solves of the setup. Non-positive values do not limit
+ * the solves.
+ * @param u Execution setup
+ * @param pmap Parameter map (can be NULL) */
+void config_budget(setup_t *u, const struct pmap_st *pmap) {
+  const char *val = NULL;
+
+  u->c->budget = 0;
+  if ((pmap && (val = pmap_find(pmap, "budget"))) ||
+      (val = getenv("RAD_TIME_BUDGET"))) {
+    u->c->budget = atof(val);
+  }
+  u->c->tbeg = rad_wall_time();
+  if (u->c->budget > 0) {
+    LOGI("Using a wall-clock budget of %.0f sec", u->c->budget);
+  }
+}
+
+/** Copy parameter value
+ * @details Copies a value of a parameter map or of the environment without
+ * its leading and trailing white space, e.g. the new line of a parameter file.
+ * @param dest Output buffer
+ * @param val Value
+ * @param sz Size of the output buffer
+ * @return Zero on success, non-zero if the value is empty or too long */
+static int copy_value(char *dest, const char *val, size_t sz) {
+  size_t n;
+
+  while (isspace((unsigned char)*val)) {
+    ++val;
+  }
+  for (n = strlen(val); n > 0 && isspace((unsigned char)val[n - 1]); --n) {
+  }
+  if (n == 0 || n >= sz) {
+    return -1;
+  }
+  memcpy(dest, val, n);
+  dest[n] = '\0';
+  return 0;
+}
+
+/** Configure live stream
+ * @details Enables the live stream (see rad_stream.h) if the `stream` key of
+ * the parameter map, or else the RAD_STREAM environment variable, names a
+ * shared memory segment. The solve is published every `streamcycle` (or
+ * RAD_STREAM_CYCLE) iterations, by default after every iteration, and when it
+ * ends. Only rank zero publishes.
+ * @param u Execution setup
+ * @param pmap Parameter map (can be NULL) */
+void config_stream(setup_t *u, const struct pmap_st *pmap) {
+  const char *name = NULL, *val = NULL;
+
+  if (!(pmap && (name = pmap_find(pmap, "stream"))) &&
+      !(name = getenv("RAD_STREAM"))) {
+    return;
+  }
+  u->c->livecycle = 1;
+  if ((pmap && (val = pmap_find(pmap, "streamcycle"))) ||
+      (val = getenv("RAD_STREAM_CYCLE"))) {
+    u->c->livecycle = atoi(val) > 0 ? atoi(val) : 1;
+  }
+  u->c->live = (stream_t *)calloc(1, sizeof(stream_t));
+  if (copy_value(u->c->live->name, name, RAD_PATH_BUFFER_SZ) != 0) {
+    LOGW("Invalid stream name, not streaming");
+    free(u->c->live);
+    u->c->live = NULL;
+    return;
+  }
+  LOGI("Streaming to '%s' every %d iterations", u->c->live->name,
+       u->c->livecycle);
+}
+
+/** Configure solution cache
+ * @details Caches the solves in the directory given by the `cache` key of the
+ * parameter map, or else by the RAD_CACHE_DIR environment variable (see
+ * rad_cache.h). Solves on several ranks are not cached.
+ * @param u Execution setup
+ * @param pmap Parameter map (can be NULL) */
+void config_cache(setup_t *u, const struct pmap_st *pmap) {
+  const char *dir = NULL;
+
+  if (!(pmap && (dir = pmap_find(pmap, "cache"))) &&
+      !(dir = getenv("RAD_CACHE_DIR"))) {
+    return;
+  }
+  if (u->c->nranks > 1) {
+    LOGW("Solves on several ranks are not cached");
+    return;
+  }
+  u->c->cache = (cache_t *)malloc(sizeof(cache_t));
+  if (cache_init(u->c->cache, dir) != 0) {
+    free(u->c->cache);
+    u->c->cache = NULL;
+    return;
+  }
+  LOGI("Caching solutions in '%s'", u->c->cache->dir);
+}
+
+void config_ranks(setup_t *u) {
+  if (rad_mpi_init(&u->c->rank, &u->c->nranks) != 0) {
+    LOGE("Failed to initialize MPI");
+    u->c->rank = 0;
+    u->c->nranks = 1;
+  }
+  u->c->counts = (int *)malloc(u->c->nranks * sizeof(int));
+  u->c->displs = (int *)malloc(u->c->nranks * sizeof(int));
+  if (u->c->nranks > 1) {
+    LOGI("Running as rank %d of %d", u->c->rank, u->c->nranks);
+  }
+}
+
+void alloc_workers(setup_t *u) {
+  u->c->w = (worker_t *)calloc_lines(u->c->nt + 1, sizeof(worker_t));
+  u->c->r = (slot_t *)calloc_lines(u->c->nt + 1, sizeof(slot_t));
+  u->c->tds =
+      (thread_init_t **)malloc(u->c->nt * sizeof(thread_init_t *));
+  for (int i = 0; i < u->c->nt; ++i) {
+    // Allocated separately, since the workers update their local maxima
+    // for every state
+    u->c->tds[i] = (thread_init_t *)calloc_lines(1, sizeof(thread_init_t));
+    u->c->tds[i]->wid = i;
+  }
+}
+
+void init_concurrency(setup_t *u, const struct pmap_st *pmap) {
   u->c = (concurrency_t *)calloc(1, sizeof(concurrency_t));
+  config_ranks(u);
+  config_threads(u, pmap);
+  config_budget(u, pmap);
+  config_stream(u, pmap);
+  config_cache(u, pmap);
+  alloc_workers(u);
 
   // set the initial buffer high enough, so that the solver does not
   // terminate in the starting / resuming iteration
@@ -503,21 +1352,63 @@ void init_concurrency(setup_t *u) {
   u->c->qM = u->s->qg->M;
 
   init_pipeline(u);
+  alloc_buffers(u);
 
-#if RAD_NUM_THREADS > 0
+#if RAD_MULTITHREADING
   init_sync_resources(u);
-#endif /* RAD_NUM_THREADS */
+#endif /* RAD_MULTITHREADING */
+}
+
+void reset_concurrency(setup_t *u) {
+  // Warm starts refer to the previous grids
+  free(u->c->warm);
+  u->c->warm = NULL;
+  u->c->warmfix = false;
+  // Delta saves and retained saves refer to the previous solve
+  if (u->c->k) {
+    ckpt_free(u->c->k);
+    free(u->c->k);
+    u->c->k = NULL;
+  }
+  u->c->accbuf = 0;
+  u->c->sMbuf = 0;
+  u->c->qMbuf = 0;
+  u->c->vMbuf = 0;
+  u->c->qM = u->s->qg->M;
+
+  init_pipeline(u);
+  alloc_buffers(u);
+
+#if RAD_MULTITHREADING
+  // Synchronization resources are reused. Workers start with a false sense.
+  atomic_store(&u->c->it_done_count, 0);
+  atomic_store(&u->c->sense, false);
+
+  u->c->imbsum = 0;
+  u->c->imbn = 0;
+  for (int i = 0; i <= u->c->nt; ++i) {
+    u->c->w[i].states = 0;
+    u->c->w[i].tit = 0;
+    u->c->w[i].tbusy = 0;
+#if RAD_CHUNK_SIZE > 0
+    u->c->w[i].steals = 0;
+#endif /* RAD_CHUNK_SIZE */
+  }
+#endif /* RAD_MULTITHREADING */
 }
 
-void log_title() {
+void log_title(const setup_t *u) {
 #if RAD_LOG_CYCLE > 0
-  LOGV("%10s|%10s|%10s|%10s|%10s", "iteration", "diff", "vfnc", "qmax", "smax");
+  if (u->c->rank == 0) {
+    LOGV("%10s|%10s|%10s|%10s|%10s", "iteration", "diff", "vfnc", "qmax",
+         "smax");
+  }
 #endif
 }
 
 void log_cycle(const setup_t *u) {
 #if RAD_LOG_CYCLE > 0
-  if (u->s->it && u->s->it % RAD_LOG_CYCLE == 0) {
+  if (u->c->rank == 0 && u->s->it && u->s->it % RAD_LOG_CYCLE == 0) {
     LOGV("%10d|%10.4e|%10.4e|%10.4e|%10.4e", u->s->it, u->c->accbuf,
          u->c->vMbuf, u->c->qMbuf, u->c->sMbuf);
   }
@@ -526,8 +1417,15 @@ void log_cycle(const setup_t *u) {
 
 void adjust_grid_bounds(const setup_t *u) {
   // if the adapted global maximum policy values are less that the solution's
-  // maximum grid values, copy them. Then reset the buffers.
-  if (u->s->it) {
+  // maximum grid values, copy them. Then reset the buffers. Warm started
+  // policies are adapted from the start with the margins of the first
+  // iteration, since the policies of a changed model can be greater.
+  // Continued solves keep their carried bounds, since their policies start
+  // close to the final ones and the decreasing margins would cut them off.
+  if (u->c->warmfix) {
+    return;
+  }
+  if (u->s->it || (u->c->warm && u->c->warmpol)) {
     double adp = u->c->qMbuf + u->s->qadp / (u->s->it + 1);
     if (adp < u->c->qM) {
       // Set also qg->M for resuming functionality
@@ -543,8 +1441,13 @@ void adjust_grid_bounds(const setup_t *u) {
 
 void resume_concurrency(setup_t *u) {
   u->c = (concurrency_t *)calloc(1, sizeof(concurrency_t));
+  config_ranks(u);
+  config_threads(u, NULL);
+  config_budget(u, NULL);
+  config_stream(u, NULL);
+  alloc_workers(u);
 
-  log_title();
+  log_title(u);
 
   for (int xi = 0; xi < u->s->xg->n; ++xi) {
     for (int ri = 0; ri < u->s->rg->n; ++ri) {
@@ -569,27 +1472,212 @@ void resume_concurrency(setup_t *u) {
   u->c->vMbuf = 0;
 
   init_pipeline(u);
+  alloc_buffers(u);
 
-#if RAD_NUM_THREADS > 0
+#if RAD_MULTITHREADING
   init_sync_resources(u);
-#endif /* RAD_NUM_THREADS */
+#endif /* RAD_MULTITHREADING */
 }
 
 /** @brief Load setup
- * @details Consolidates model and solution loading functionality. The format
- * and naming conventions of the binary data are set in the model_load() and
- * solution_load() functions. The order of the functions in the model's Inherits
- * the convention used in model loading.
+ * @details Loads the model and the solution from a container file created by
+ * setup_save() (see rad_file_load()) and prepares the setup for resuming.
  * @param u Setup to be populated
- * @param setup_path Path with stored binary model and solution data
+ * @param setup_path Save path relative to the output directory and without
+ * extension
  * @param obhparts Model's functional specification
+ * @return Zero on success, non-zero otherwise
  * @see objpart_st */
-void setup_load(setup_t *u, const char *setup_path,
-                const struct objpart_st *obhparts) {
-  model_load(u->m, setup_path, obhparts);
-  solution_load(u->s, setup_path);
+int setup_load(setup_t *u, const char *setup_path,
+               const struct objpart_st *obhparts) {
+  int ec = 0;
+  rad_ctx_set(u->x);
+  if ((ec = rad_file_load(u->m, u->s, setup_path, obhparts)) != 0) {
+    LOGE("Setup loading failed with code %d", ec);
+    return ec;
+  }
 
   resume_concurrency(u);
+
+  return 0;
+}
+
+/** Configure warm start
+ * @details Warm starts the setup (see setup_warm()) from the save path given
+ * by the `warm` key of the parameter map, or else by the RAD_WARM_START
+ * environment variable. The policies are interpolated as well if the `warmpol`
+ * key or the RAD_WARM_POLICIES environment variable is non-zero. If the warm
+ * start fails, the solve starts cold.
+ * @param u Execution setup
+ * @param pmap Parameter map */
+void config_warm(setup_t *u, const struct pmap_st *pmap) {
+  const char *val = NULL;
+  char path[RAD_PATH_BUFFER_SZ];
+  int policies = 0;
+
+  if (!(val = pmap_find(pmap, "warm")) && !(val = getenv("RAD_WARM_START"))) {
+    return;
+  }
+  if (copy_value(path, val, sizeof(path)) != 0) {
+    LOGW("Invalid warm start path, starting cold");
+    return;
+  }
+  if ((val = pmap_find(pmap, "warmpol")) ||
+      (val = getenv("RAD_WARM_POLICIES"))) {
+    policies = atoi(val);
+  }
+  if (setup_warm(u, path, policies) != 0) {
+    LOGW("Failed to warm start from %s, starting cold", path);
+  }
+}
+
+/** Lower interpolation index
+ * @details Similar to grid_liei(), but accepts the greatest grid value.
+ * @param g Grid
+ * @param X Domain value within the grid's range
+ * @return The index of the interpolation interval */
+short lower_index(const grid_t *g, double X) {
+  return X < g->d[g->n - 1] ? grid_liei(g, X) : g->n - 2;
+}
+
+/** Regrid variable
+ * @details Interpolates a variable of a saved solution bilinearly at the
+ * states of a solution's grids. States outside the saved grids take the values
+ * of the nearest saved boundary states, since extrapolated values are not
+ * reliable initial values.
+ * @param dest Interpolated values indexed by logical state index
+ * @param s Solution
+ * @param w Saved solution
+ * @param var Saved variable */
+void regrid(double *dest, const sol_t *s, const sol_t *w, double **var) {
+  const grid_t *wx = w->xg, *wr = w->rg;
+
+  for (int xi = 0; xi < s->xg->n; ++xi) {
+    double x = fmin(fmax(s->xg->d[xi], wx->d[0]), wx->d[wx->n - 1]);
+    short x1 = lower_index(wx, x);
+    double tx = (x - wx->d[x1]) / (wx->d[x1 + 1] - wx->d[x1]);
+    for (int ri = 0; ri < s->rg->n; ++ri) {
+      double r = fmin(fmax(s->rg->d[ri], wr->d[0]), wr->d[wr->n - 1]);
+      short r1 = lower_index(wr, r);
+      double tr = (r - wr->d[r1]) / (wr->d[r1 + 1] - wr->d[r1]);
+      double y1 = (1 - tr) * var[x1][r1] + tr * var[x1][r1 + 1];
+      double y2 = (1 - tr) * var[x1 + 1][r1] + tr * var[x1 + 1][r1 + 1];
+      dest[xi * s->rg->n + ri] = (1 - tx) * y1 + tx * y2;
+    }
+  }
+}
+
+/** Seed warm start
+ * @details Interpolates the final value function of a solution at the states
+ * of the setup's grids (see regrid()) and, if a second solution is passed,
+ * extrapolates linearly, i.e. the initial values are a + t (a - b).
+ * Extrapolated policies are clipped to the lower bounds of their grids.
+ * @param u Initialized setup
+ * @param a Solution
+ * @param b Second solution (NULL for none)
+ * @param t Extrapolation factor
+ * @param policies Interpolate the policies as well */
+void seed_warm(setup_t *u, const sol_t *a, const sol_t *b, double t,
+               int policies) {
+  size_t ls = u->c->ls;
+  double *tmp = b ? (double *)malloc(ls * sizeof(double)) : NULL;
+  const double lb[3] = {-INFINITY, u->s->qg->m, u->s->sg->m};
+  double **avars[3] = {a->v1, a->qpol, a->spol};
+  double **bvars[3] = {b ? b->v1 : NULL, b ? b->qpol : NULL,
+                       b ? b->spol : NULL};
+
+  free(u->c->warm);
+  u->c->warm = (double *)malloc(3 * ls * sizeof(double));
+  u->c->warmpol = policies != 0;
+  u->c->warmfix = false;
+  for (int k = 0; k < (u->c->warmpol ? 3 : 1); ++k) {
+    double *dest = u->c->warm + k * ls;
+    regrid(dest, u->s, a, avars[k]);
+    if (!tmp) {
+      continue;
+    }
+    regrid(tmp, u->s, b, bvars[k]);
+    for (size_t li = 0; li < ls; ++li) {
+      dest[li] = fmax(dest[li] + t * (dest[li] - tmp[li]), lb[k]);
+    }
+  }
+  free(tmp);
+}
+
+/** @brief Warm start
+ * @details Loads a solution saved by setup_save() and interpolates its final
+ * value function bilinearly at the states of the setup's grids (see
+ * regrid()). The next solve (see setup_solve()) starts its fixed point
+ * iteration from the interpolated value function instead of the one-period
+ * utility. The saved model parameters and grids can differ from the setup's
+ * ones; close models need a fraction of the iterations of a cold start. If
+ * policies is non-zero, the saved policies are interpolated as well and become
+ * the initial policies. The warm start is discarded by setup_reset().
+ * @param u Initialized setup
+ * @param setup_path Save path relative to the output directory and without
+ * extension
+ * @param policies Interpolate the policies as well
+ * @return Zero on success, non-zero otherwise */
+int setup_warm(setup_t *u, const char *setup_path, int policies) {
+  int ec = 0;
+  model_t wm;
+  sol_t ws;
+  const objpart_t objparts[4] = {u->m->util, u->m->cost, u->m->radt,
+                                 u->m->wltt};
+
+  rad_ctx_set(u->x);
+  if ((ec = rad_file_load(&wm, &ws, setup_path, objparts)) != 0) {
+    LOGE("Warm start loading failed with code %d", ec);
+    return ec;
+  }
+
+  seed_warm(u, &ws, NULL, 0, policies);
+  LOGI("Warm starting from %s (%dx%d states, %d iter)", setup_path,
+       ws.xg->n, ws.rg->n, ws.it);
+
+  solution_free(&ws);
+  return 0;
+}
+
+/** @brief Continuation warm start
+ * @details Warm starts the setup from solutions in memory, typically the
+ * converged solutions of neighbouring points of a parameter sweep. The value
+ * function of the first solution is interpolated at the states of the setup's
+ * grids as in setup_warm(). If a second solution is passed, the initial values
+ * are extrapolated linearly from both, i.e. they are a + t (a - b), where t is
+ * (p - pa) / (pa - pb) for the parameter values p, pa and pb of the setup and
+ * the solutions. A negative t interpolates between the solutions. The upper
+ * bounds of the quantity and effort grids are lowered to the adapted bounds of
+ * the first solution plus the adaptation margins of a first iteration, and
+ * they are not adapted further during the next solve. The warm start is
+ * discarded by setup_reset() and after the next solve.
+ * @param u Initialized setup
+ * @param a Solution
+ * @param b Second solution (NULL for none)
+ * @param t Extrapolation factor
+ * @param policies Interpolate the policies as well
+ * @return Zero on success, non-zero otherwise */
+int setup_continue(setup_t *u, const sol_t *a, const sol_t *b, double t,
+                   int policies) {
+  rad_ctx_set(u->x);
+  if (!a || (b && !isfinite(t))) {
+    return -1;
+  }
+
+  double M = a->qg->M + u->s->qadp;
+  if (M < u->c->qM) {
+    u->s->qg->M = u->c->qM = M;
+  }
+  M = a->sg->M + u->s->sadp;
+  if (M < u->s->sg->M) {
+    u->s->sg->M = M;
+    grid_calc(u->s->sg);
+  }
+  seed_warm(u, a, b, t, policies);
+  u->c->warmfix = true;
+  LOGD("Continuing from %d iter solution%s", a->it, b ? "s" : "");
+
+  return 0;
 }
 
 /** @brief Setup initialization
@@ -600,7 +1688,8 @@ void setup_load(setup_t *u, const char *setup_path,
  * specifications. The functional specification of the attentional costs,
  * temporal utility, radius and wealth dynamics is passed separately using the
  * obhparts variable. Pipeline calculations are performed here. Threads
- * initialization is not performed here.
+ * initialization is not performed here. If the parameter file names a save
+ * path with the `warm` key, the setup is warm started (see setup_warm()).
  * @param u Setup structure to be initialized.
  * @param parameter_filename Input key-value, text file
  * @param obhparts Function pointers to model's functional specifications
@@ -612,8 +1701,9 @@ int setup_init(setup_t *u, const char *parameter_filename,
   pmap_t pmap;
   char pfile_path[RAD_PATH_BUFFER_SZ];
 
+  rad_ctx_set(u->x);
   snprintf(pfile_path, RAD_PATH_BUFFER_SZ, "%s" CCM_FILE_SYSTEM_SEP "%s",
-           RAD_DATA_DIR, parameter_filename);
+           rad_data_dir(), parameter_filename);
   if ((ec = pmap_init(&pmap, pfile_path)) != 0) {
     LOGE("Setup initialization failed with code %d", ec);
     return -1;
@@ -622,9 +1712,40 @@ int setup_init(setup_t *u, const char *parameter_filename,
   model_init(u->m, &pmap, obhparts);
   solution_init(u->s, &pmap);
 
+  init_concurrency(u, &pmap);
+  if (u->c->cache) {
+    cache_key(u->c->cache, u->m, u->s);
+  }
+  config_warm(u, &pmap);
+
   pmap_free(&pmap);
 
-  init_concurrency(u);
+  return 0;
+}
+
+/** @brief Setup re-initialization
+ * @details Resets an initialized setup (see setup_init()) using the values of
+ * the passed parameter map. The memory footprint of the setup, i.e. grids,
+ * approximation variables, concurrency data and worker buffers, is reused in
+ * place when the grid shapes of the parameter map match the ones of the
+ * setup. Otherwise, only the parts with mismatching shapes are re-allocated.
+ * The function is intended for repeated solves such as parameter sweeps.
+ * @param u Initialized setup structure
+ * @param pmap Parameter map with initialization values
+ * @param obhparts Function pointers to model's functional specifications
+ * @return Zero on success, non-zero otherwise
+ * @see setup_init(), solution_reset() */
+int setup_reset(setup_t *u, const struct pmap_st *pmap,
+                const struct objpart_st *obhparts) {
+  rad_ctx_set(u->x);
+  model_init(u->m, pmap, obhparts);
+  solution_reset(u->s, pmap);
+
+  // The thread configuration of setup_init() is kept
+  reset_concurrency(u);
+  if (u->c->cache) {
+    cache_key(u->c->cache, u->m, u->s);
+  }
 
   return 0;
 }
@@ -638,21 +1759,189 @@ void swapv1v0(thread_init_t *td) {
   }
 }
 
-void main_sync(thread_init_t *td) {
-#if RAD_NUM_THREADS > 0
-  lock_mutex(td);
-#endif /* RAD_NUM_THREADS */
+#if RAD_MULTITHREADING
+void measure_balance(const setup_t *u) {
+  double tmax = 0, tsum = 0;
+  for (int i = 0; i <= u->c->nt; ++i) {
+    tsum += u->c->w[i].tit;
+    if (tmax < u->c->w[i].tit)
+      tmax = u->c->w[i].tit;
+  }
+  if (tsum > 0) {
+    // Ratio of the slowest worker's time over the mean time
+    u->c->imbsum += tmax * (u->c->nt + 1) / tsum;
+    ++u->c->imbn;
+  }
+}
+#endif /* RAD_MULTITHREADING */
+
+/** Log workload balance
+ * @details Logs the busy time, the processed states and, with dynamic
+ * scheduling, the stolen chunks of every worker. It also logs the mean
+ * iteration imbalance, i.e. the average ratio of the slowest worker's
+ * iteration time over the mean worker iteration time. A value of one indicates
+ * perfect balance.
+ * @param u Execution setup */
+void log_balance(const setup_t *u) {
+#if RAD_MULTITHREADING
+  LOGI("%10s|%10s|%10s|%10s", "worker", "busy", "states", "steals");
+  for (int i = 0; i <= u->c->nt; ++i) {
+#if RAD_CHUNK_SIZE > 0
+    long steals = u->c->w[i].steals;
+#else
+    long steals = 0;
+#endif /* RAD_CHUNK_SIZE */
+    LOGI("%10d|%10.4e|%10ld|%10ld", i, u->c->w[i].tbusy, u->c->w[i].states,
+         steals);
+  }
+  if (u->c->imbn) {
+    LOGI("Mean iteration imbalance %.4f", u->c->imbsum / u->c->imbn);
+  }
+#endif /* RAD_MULTITHREADING */
+}
 
+/** Exchange iteration results
+ * @details Combines the iteration results of the ranks. The accuracy, the
+ * policy and value function maxima and the halt reason are reduced, so that
+ * all ranks halt together, and the value function parts
+ * are exchanged, since every rank interpolates the whole value function in the
+ * next iteration. The policies are only needed for saving (see
+ * gather_policies()).
+ * @param u Execution setup */
+void exchange(const setup_t *u) {
+  if (u->c->nranks == 1) {
+    return;
+  }
+  double M[5] = {u->c->accbuf, u->c->qMbuf, u->c->sMbuf, u->c->vMbuf,
+                 u->c->halt};
+  rad_mpi_max(M, 5);
+  u->c->accbuf = M[0];
+  u->c->qMbuf = M[1];
+  u->c->sMbuf = M[2];
+  u->c->vMbuf = M[3];
+  u->c->halt = (int)M[4];
+  rad_mpi_allgather(u->s->v0[0], u->c->counts, u->c->displs);
+}
+
+/** Gather policies
+ * @details Collects the policy parts of the ranks in rank zero, which saves
+ * the setup (see setup_save()).
+ * @param u Execution setup */
+void gather_policies(const setup_t *u) {
+  if (u->c->nranks == 1) {
+    return;
+  }
+  rad_mpi_gather(u->s->qpol[0], u->c->counts, u->c->displs);
+  rad_mpi_gather(u->s->spol[0], u->c->counts, u->c->displs);
+}
+
+/** Periodic save
+ * @details Takes a snapshot of the running solve that is written in the
+ * background (see rad_ckpt.h). The checkpointer is created by the first save.
+ * If the solver runs on several ranks, only rank zero saves.
+ * @param u Execution setup
+ * @param path Save path */
+void checkpoint(const setup_t *u, const char *path) {
+  if (u->c->rank != 0) {
+    return;
+  }
+  if (!u->c->k) {
+    u->c->k = (ckpt_t *)malloc(sizeof(ckpt_t));
+    ckpt_init(u->c->k, RAD_SAVE_QUEUE, u->x);
+  }
+  ckpt_push(u->c->k, u->m, u->s, path);
+}
+
+/** Publish live stream
+ * @details Publishes the solve's state to the live stream every livecycle
+ * iterations and when the solve ends. The policies of all ranks are gathered
+ * first, thus all ranks call the function. The stream's segment is
+ * created by the first publication of rank zero.
+ * @param u Execution setup */
+void publish_live(const setup_t *u) {
+  int state = STREAM_SOLVING;
+  if (u->s->acc < u->s->tol) {
+    state = STREAM_CONVERGED;
+  } else if (u->c->halt != HALT_NONE) {
+    state = STREAM_HALTED;
+  }
+  if (state == STREAM_SOLVING && u->s->it % u->c->livecycle != 0) {
+    return;
+  }
+
+  gather_policies(u);
+  if (u->c->rank != 0) {
+    return;
+  }
+  stream_t *t = u->c->live;
+  if (!t->seg) {
+    // A failed creation leaves the segment size set and is not retried
+    if (t->size || stream_init(t, t->name, u->s->xg->n, u->s->rg->n) != 0) {
+      return;
+    }
+  }
+  stream_publish(t, u->s, state, rad_wall_time() - u->c->tbeg);
+}
+
+/** Halt reason
+ * @details Checks if the solve should halt after the current iteration, i.e.
+ * if a halt signal is caught (see setup_catch_signals()), if the next
+ * iteration would exceed the wall-clock budget or if the maximum number of
+ * iterations is reached. The next iteration is assumed to last as long as the
+ * current one.
+ * @param u Execution setup
+ * @return The halt reason (HALT_NONE if the solve continues) */
+int halt_reason(const setup_t *u) {
+  double now = rad_wall_time();
+  double tit = now - u->c->tsync;
+  u->c->tsync = now;
+
+  if (halt_signal) {
+    return HALT_SIGNAL;
+  }
+  if (u->c->budget > 0 && now + tit - u->c->tbeg > u->c->budget) {
+    return HALT_BUDGET;
+  }
+  if (u->s->maxit > 0 && u->s->it + 1 >= u->s->maxit) {
+    return HALT_MAXIT;
+  }
+  return HALT_NONE;
+}
+
+void log_halt(const setup_t *u) {
+  const char *reasons[] = {"", "maximum number of iterations reached",
+                           "wall-clock budget exhausted", "signal caught"};
+  if (u->c->rank == 0) {
+    LOGW("Halting solver at iteration %d (%s)", u->s->it,
+         reasons[u->c->halt]);
+  }
+}
+
+void main_sync(thread_init_t *td) {
   copybufs(td);
 
-#if RAD_NUM_THREADS > 0
-  while (td->u->c->it_done_count < RAD_NUM_THREADS) {
-    wait_it_done(td);
+#if RAD_MULTITHREADING
+  td->sense = !td->sense;
+  wait_it_done(td);
+  // If the main is here, all workers are waiting on the barrier
+
+  if (td->u->s->it) {
+    measure_balance(td->u);
+  }
+#if RAD_CHUNK_SIZE > 0
+  for (int i = 0; i <= td->u->c->nt; ++i) {
+    fill_deque(&td->u->c->w[i]);
   }
-  // If the main is here, all workers are waiting on next_ready condition
-  td->u->c->it_done_count = 0;
-  td->u->c->is_next_ready = false;
-#endif /* RAD_NUM_THREADS */
+#endif /* RAD_CHUNK_SIZE */
+#endif /* RAD_MULTITHREADING */
+
+  if (td->partial) {
+    reduce_parts(td->u);
+  } else {
+    reduce_slots(td->u);
+  }
+  td->u->c->halt = halt_reason(td->u);
+  exchange(td->u);
 
   log_cycle(td->u);
 
@@ -663,6 +1952,10 @@ void main_sync(thread_init_t *td) {
   // then reset the global buffer.
   td->u->s->acc = td->u->c->accbuf;
   td->u->c->accbuf = 0;
+  // A converged solve is complete, even if it should halt
+  if (td->u->s->acc < td->u->s->tol) {
+    td->u->c->halt = HALT_NONE;
+  }
 
   adjust_grid_bounds(td->u);
 
@@ -670,28 +1963,37 @@ void main_sync(thread_init_t *td) {
   td->u->c->sMbuf = 0;
   td->u->c->vMbuf = 0;
 
+  // A halted solve is saved at its last iteration, so that it can be resumed
+  bool save = td->u->c->halt != HALT_NONE;
 #if RAD_SAVE_CYCLE > 0
-  if (td->u->s->it && td->u->s->it % RAD_SAVE_CYCLE == 0) {
+  save = save || (td->u->s->it && td->u->s->it % RAD_SAVE_CYCLE == 0);
+#endif
+  if (save) {
     char buf[RAD_PATH_BUFFER_SZ];
     snprintf(buf, RAD_PATH_BUFFER_SZ, "save" CCM_FILE_SYSTEM_SEP "it%05d",
              td->u->s->it);
     // calculate the adjusted quantity grid for saving
     grid_calc(td->u->s->qg);
-    setup_save(td->u, buf);
+    gather_policies(td->u);
+    checkpoint(td->u, buf);
+  }
+  if (td->u->c->halt != HALT_NONE) {
+    log_halt(td->u);
+  }
+  if (td->u->c->live) {
+    publish_live(td->u);
   }
-#endif
 
   // increment iteration (should be after possible save)
   ++td->u->s->it;
 
-#if RAD_NUM_THREADS > 0
+#if RAD_MULTITHREADING
   broadcast_ready(td);
-  unlock_mutex(td);
-#endif /* RAD_NUM_THREADS */
+#endif /* RAD_MULTITHREADING */
 }
 
 void main_fixed_point(thread_init_t *td) {
-  while (td->u->s->acc >= td->u->s->tol) {
+  while (iterating(td->u)) {
     step_sovle(td);
     main_sync(td);
   }
@@ -702,45 +2004,242 @@ void main_fixed_point(thread_init_t *td) {
   }
 }
 
-/** @brief Model solver
- * @details This is the top-level main functionality call. The function expects
- * an initialized model setup (see setup_init()). If multi-threading mode is
- * enabled, the function initializes threading based on the pipeline
- * allocations calculated in the setup. The function initializes
- * the iterative solution procedure. It performs the fixed point calculation
- * steps and checks for convergence. The iterations stops if the maximum number
- * of iterations is reached, or if the convergence criterion is met. Then the
- * function disallocates threads and returns.
- * @param u Model setup
- * @return Zero on success, non-zero otherwise */
-int setup_solve(setup_t *u) {
-#if RAD_NUM_THREADS > 0
-  for (long i = 0; i < RAD_NUM_THREADS; ++i) {
-    thread_init_t *td = (thread_init_t *)calloc(1, sizeof(thread_init_t));
-    td->wid = i;
-    td->u = u;
-    td->pv0 = u->s->v0;
-    create_thread(td, i, thread_start);
+int main_start(void *vtd) {
+  thread_init_t *td = (thread_init_t *)vtd;
+
+  pin_worker(td);
+  alloc_thread_init(td);
+  td->u->c->accbuf = td->u->s->tol + 1;
+
+  log_title(td->u);
+
+  init_step(td);
+  main_sync(td);
+
+  main_fixed_point(td);
+
+  free_thread_init(td);
+  return EXIT_SUCCESS;
+}
+
+int main_resume(void *vtd) {
+  thread_init_t *td = (thread_init_t *)vtd;
+
+  pin_worker(td);
+  alloc_thread_init(td);
+
+  main_fixed_point(td);
+
+  free_thread_init(td);
+  return EXIT_SUCCESS;
+}
+
+/* Worker threads are started by the first solve and they persist until the
+ * setup is freed (see setup_free()). Between solves, they park on the job
+ * condition. The main thread hands them a job by setting the worker start
+ * function and incrementing the job generation. A worker signals the
+ * iteration barrier when it finishes a job, thus the main thread waits for the
+ * end of a job in the same way it waits for the end of an iteration. */
+
+int pool_main(void *vtd) {
+#if RAD_MULTITHREADING
+  thread_init_t *td = (thread_init_t *)vtd;
+  concurrency_t *c = td->u->c;
+  rad_thrd_start_t job_main = NULL;
+  int job = 0;
+
+  LOGT("Worker %d started", td->wid);
+  for (;;) {
+    lock_mutex(td);
+    while (c->job == job) {
+      rad_cnd_wait(&c->job_ready, &c->mtx);
+    }
+    job = c->job;
+    job_main = c->job_main;
+    unlock_mutex(td);
+
+    if (!job_main) {
+      break;
+    }
+    job_main(td);
+    signal_done(td);
   }
-#endif /* RAD_NUM_THREADS */
+  LOGT("Worker %d stopped", td->wid);
+#endif /* RAD_MULTITHREADING */
+
+  return EXIT_SUCCESS;
+}
 
+void hand_job(setup_t *u, rad_thrd_start_t job_main) {
+#if RAD_MULTITHREADING
+  thread_init_t td = {.u = u};
+  lock_mutex(&td);
+  u->c->job_main = job_main;
+  ++u->c->job;
+  rad_cnd_broadcast(&u->c->job_ready);
+  unlock_mutex(&td);
+#endif /* RAD_MULTITHREADING */
+}
+
+void start_pool(setup_t *u) {
+  for (int i = 0; i < u->c->nt; ++i) {
+    u->c->tds[i]->u = u;
+    create_thread(u->c->tds[i], i, pool_main);
+  }
+  u->c->pool = true;
+}
+
+void stop_pool(setup_t *u) {
+  if (u->c->pool) {
+    hand_job(u, NULL);
+    join_all_threads(u);
+    u->c->pool = false;
+  }
+}
+
+/** Run thread team
+ * @details Runs the passed worker function on the worker threads and the main
+ * thread's part on the calling thread. With fork-join backends, the team is
+ * launched by the backend for every solve. Otherwise, the job is handed to the
+ * persistent worker threads, which are started on first use. The worker data
+ * persist across solves, only their per-solve state is reset here.
+ * @param u Execution setup
+ * @param worker_main Worker start function
+ * @param main_main Main thread start function
+ * @return Zero on success, non-zero otherwise */
+int run_team(setup_t *u, rad_thrd_start_t worker_main,
+             rad_thrd_start_t main_main) {
+  int ec = 0;
   thread_init_t td = {
-      .wid = RAD_NUM_THREADS, .u = u, .pv0 = u->s->v0, .ovar = {.m = u->m}};
-  alloc_thread_init(&td);
-  u->c->accbuf = u->s->tol + 1;
+      .wid = u->c->nt, .u = u, .pv0 = u->s->v0, .ovar = {.m = u->m}};
+
+  for (int i = 0; i < u->c->nt; ++i) {
+    thread_init_t *wtd = u->c->tds[i];
+    wtd->u = u;
+    wtd->pv0 = u->s->v0;
+    wtd->sense = false;
+    wtd->partial = false;
+    wtd->acc = wtd->qM = wtd->sM = wtd->vM = 0;
+  }
+  u->c->halt = HALT_NONE;
+  u->c->tsync = rad_wall_time();
 
-  log_title();
+#ifdef RAD_THREADS_FORK_JOIN
+  void **args = (void **)malloc((u->c->nt + 1) * sizeof(void *));
+  for (int i = 0; i < u->c->nt; ++i) {
+    args[i] = u->c->tds[i];
+  }
+  args[u->c->nt] = &td;
+  if ((ec = rad_thrd_team(u->c->nt + 1, worker_main, main_main, args)) != 0) {
+    LOGE("Failed to start a team of %d threads", u->c->nt + 1);
+  }
+  free(args);
+#else
+  if (!u->c->pool) {
+    start_pool(u);
+  }
+  hand_job(u, worker_main);
+  ec = main_main(&td);
+  // Wait until all workers have finished the job
+  wait_it_done(&td);
+#if RAD_MULTITHREADING
+  atomic_store(&u->c->it_done_count, 0);
+#endif /* RAD_MULTITHREADING */
+#endif /* RAD_THREADS_FORK_JOIN */
+
+  return ec;
+}
 
-  init_sovle(&td);
-  main_sync(&td);
+/** Cached solve
+ * @details Looks the setup's configuration up in the solution cache (see
+ * rad_cache.h). A cached solution is copied into the setup, and the setup's
+ * warm start is released. Otherwise, the last state of a cached halted solve
+ * warm starts the setup, unless it is warm started already.
+ * @param u Execution setup
+ * @return True if the solution is cached */
+bool cached_solve(setup_t *u) {
+  cache_t *h = u->c->cache;
+  const objpart_t objparts[4] = {u->m->util, u->m->cost, u->m->radt,
+                                 u->m->wltt};
+  model_t cm;
+  sol_t cs;
+
+  if (!h || !h->text) {
+    return false;
+  }
+  if (cache_load(h, false, objparts, &cm, &cs) == 0) {
+    // The execution times are the ones of the running solve
+    cs.xbeg = u->s->xbeg;
+    cs.xend = u->s->xend;
+    solution_copy(u->s, &cs);
+    solution_free(&cs);
+    free(u->c->warm);
+    u->c->warm = NULL;
+    u->c->warmfix = false;
+    LOGI("Using the cached solution %s (%d iter)", h->key, u->s->it);
+    return true;
+  }
+  if (!u->c->warm && cache_load(h, true, objparts, &cm, &cs) == 0) {
+    seed_warm(u, &cs, NULL, 0, true);
+    LOGI("Warm starting from the cached halted solve %s (%d iter)", h->key,
+         cs.it);
+    solution_free(&cs);
+  }
+  return false;
+}
 
-  main_fixed_point(&td);
+/** End solve
+ * @details Completes a solve of the setup after its iterations. The warm
+ * start is released, the policies are gathered, the periodic saves are
+ * drained and the solution, or the state of a halted solve, is cached.
+ * @param u Execution setup
+ * @param ec Return value of the thread team (see run_team())
+ * @return Zero on convergence, SETUP_HALTED if the solve is halted, other
+ * values on failure */
+int end_solve(setup_t *u, int ec) {
+  if (ec == 0 && u->c->halt != HALT_NONE) {
+    ec = SETUP_HALTED;
+  }
+  // A warm start applies to a single solve
+  free(u->c->warm);
+  u->c->warm = NULL;
+  u->c->warmfix = false;
+  gather_policies(u);
+  if (u->c->k) {
+    ckpt_drain(u->c->k);
+  }
+  if (u->c->cache && (ec == 0 || ec == SETUP_HALTED)) {
+    cache_store(u->c->cache, ec == SETUP_HALTED, u->m, u->s);
+  }
 
-  free_thread_init(&td);
+  log_balance(u);
 
-  join_all_threads(td.u);
+  return ec;
+}
 
-  return 0;
+/** @brief Model solver
+ * @details This is the top-level main functionality call. The function expects
+ * an initialized model setup (see setup_init()). If multi-threading mode is
+ * enabled, the function initializes threading based on the pipeline
+ * allocations calculated in the setup. The function initializes
+ * the iterative solution procedure. It performs the fixed point calculation
+ * steps and checks for convergence. The iterations stops if the convergence
+ * criterion is met, or else the solve halts after the iteration that reaches
+ * the maximum number of iterations or the wall-clock budget or that catches a
+ * halt signal (see setup_catch_signals()). A halted solve is saved at its last
+ * iteration, so that it can be resumed (see setup_resume()). Then the function
+ * disallocates threads and returns. If the solves are cached (see
+ * rad_cache.h) and the setup's configuration is solved already, the cached
+ * solution is copied into the setup instead.
+ * @param u Model setup
+ * @return Zero on convergence, SETUP_HALTED if the solve is halted, other
+ * values on failure */
+int setup_solve(setup_t *u) {
+  rad_ctx_set(u->x);
+  if (cached_solve(u)) {
+    return 0;
+  }
+  return end_solve(u, run_team(u, thread_start, main_start));
 }
 
 /** @brief Resume model solver
@@ -752,67 +2251,522 @@ int setup_solve(setup_t *u) {
  * setup_solve(), this function does not call setup initialization routines. It
  * rather jumps directly to iteration functionality execution.
  * @param u Model setup
- * @return Zero on success, non-zero otherwise */
+ * @return Zero on convergence, SETUP_HALTED if the solve is halted, other
+ * values on failure */
 int setup_resume(setup_t *u) {
-#if RAD_NUM_THREADS > 0
-  for (long i = 0; i < RAD_NUM_THREADS; ++i) {
-    thread_init_t *td = (thread_init_t *)calloc(1, sizeof(thread_init_t));
-    td->wid = i;
-    td->u = u;
-    td->pv0 = u->s->v0;
-    create_thread(td, i, thread_resume);
+  rad_ctx_set(u->x);
+  return end_solve(u, run_team(u, thread_resume, main_resume));
+}
+
+/* Batched solves
+ *
+ * Sweep points that differ only in the scalar parameters of the model share
+ * the grids and the loop structure of solve_range(). A batch advances the
+ * setups of several points in lockstep: the state, effort and quantity loops
+ * are shared and the innermost loop runs over the lanes, whose parameters,
+ * effort grids, quantity bounds and intermediate results are held in arrays
+ * indexed by lane. The quantity grid weights are calculated once per batch.
+ * Every lane keeps its own convergence, bounds adaptation, saves and halts
+ * (see main_sync()). */
+
+/** Batch lane model
+ * @details Holds the scalar parameters of a lane with the member names of
+ * model_t, so that the macros of rad_specs.h evaluate them */
+typedef struct {
+  /** @brief Effort cost parameter */
+  double alpha;
+  /** @brief Radius transition parameter */
+  double delta;
+  /** @brief Cost scaling parameter */
+  double gamma;
+  /** @brief Wealth transition parameter */
+  double R;
+} batch_model_t;
+
+/** Batch lane variables
+ * @details The objective variables of a lane (see objvar_t) and the lane's
+ * radius transition of the current effort */
+typedef struct {
+  /** @brief Lane model */
+  const batch_model_t *m;
+  /** @brief Wealth */
+  double x;
+  /** @brief Radius */
+  double r;
+  /** @brief Effort */
+  double s;
+  /** @brief Quantity */
+  double q;
+  /** @brief Radius transition */
+  double rp;
+} batch_var_t;
+
+/** Batch structure
+ * @details The arrays of the active lanes are indexed by position, i.e. by
+ * the lane's index among the active lanes of the current iteration. */
+typedef struct {
+  /** @brief Setups of the lanes */
+  setup_t *const *us;
+  /** @brief Number of lanes */
+  int n;
+  /** @brief Worker data of the lanes */
+  thread_init_t *tds;
+  /** @brief The lanes are solving */
+  bool *busy;
+  /** @brief Lanes of the active positions */
+  int *act;
+  /** @brief Number of active lanes */
+  int na;
+  /** @brief The shared grids are set by the first lane */
+  bool shaped;
+  /** @brief Shared wealth grid */
+  grid_t xg;
+  /** @brief Shared radius grid */
+  grid_t rg;
+  /** @brief Shared quantity grid specification (the upper bound varies) */
+  grid_t qg;
+  /** @brief Effort grid size */
+  short sn;
+  /** @brief Quantity grid weights, i.e. the powers of the grid indices */
+  double *qw;
+  /** @brief Quantity grid scale, i.e. the power of the last grid index */
+  double qs;
+  /** @brief Arena of the position arrays */
+  double *buf;
+  /** @brief Discount factors */
+  double *beta;
+  /** @brief Effort cost parameters */
+  double *alpha;
+  /** @brief Radius transition parameters */
+  double *delta;
+  /** @brief Cost scaling parameters */
+  double *gamma;
+  /** @brief Wealth transition parameters */
+  double *R;
+  /** @brief Quantity grid bounds */
+  double *qM;
+  /** @brief Effort grids [effort x position] */
+  double *sv;
+  /** @brief Radius transitions of the current effort */
+  double *rp;
+  /** @brief Quantity grid steps of the current effort */
+  double *hq;
+  /** @brief Current quantities */
+  double *q;
+  /** @brief Values of the current quantities */
+  double *v;
+  /** @brief Maximum values of the current state */
+  double *vopt;
+  /** @brief Optimal quantities of the current state */
+  double *qopt;
+  /** @brief Optimal efforts of the current state */
+  double *sopt;
+  /** @brief Radius grid indices of the current effort */
+  short *rpli;
+  /** @brief Solutions of the active positions */
+  const sol_t **sols;
+} batch_t;
+
+/** Batch radius transition
+ * @param v Lane variables
+ * @return The radius transition of rad_specs.h */
+double batch_radt(const batch_var_t *v) { return _radt_; }
+
+bool same_grid(const grid_t *a, const grid_t *b) {
+  return a->n == b->n && memcmp(a->d, b->d, a->n * sizeof(double)) == 0;
+}
+
+/** Shape batch
+ * @details Sets the shared grids of the batch from the passed setup and
+ * allocates the arrays of the positions.
+ * @param b Batch
+ * @param u Setup of the first lane */
+void shape_batch(batch_t *b, const setup_t *u) {
+  const sol_t *s = u->s;
+  size_t n = b->n;
+
+  b->xg = *s->xg;
+  b->rg = *s->rg;
+  b->qg = *s->qg;
+  b->sn = s->sg->n;
+  b->xg.d = (double *)malloc(b->xg.n * sizeof(double));
+  b->rg.d = (double *)malloc(b->rg.n * sizeof(double));
+  b->qw = (double *)malloc(b->qg.n * sizeof(double));
+  memcpy(b->xg.d, s->xg->d, b->xg.n * sizeof(double));
+  memcpy(b->rg.d, s->rg->d, b->rg.n * sizeof(double));
+  // As in grid_calc()
+  b->qs = pow(b->qg.n - 1, b->qg.w);
+  for (int i = 0; i < b->qg.n; ++i) {
+    b->qw[i] = pow(i, b->qg.w);
   }
-#endif /* RAD_NUM_THREADS */
 
-  thread_init_t td = {
-      .wid = RAD_NUM_THREADS, .u = u, .pv0 = u->s->v0, .ovar = {.m = u->m}};
-  alloc_thread_init(&td);
+  double **arrays[] = {&b->beta, &b->alpha, &b->delta, &b->gamma, &b->R,
+                       &b->qM,   &b->rp,    &b->hq,    &b->q,     &b->v,
+                       &b->vopt, &b->qopt,  &b->sopt};
+  size_t na = sizeof(arrays) / sizeof(arrays[0]);
+  b->buf = (double *)malloc((na + b->sn) * n * sizeof(double));
+  double *p = b->buf;
+  for (size_t i = 0; i < na; ++i, p += n) {
+    *arrays[i] = p;
+  }
+  b->sv = p;
+  b->rpli = (short *)malloc(n * sizeof(short));
+  b->sols = (const sol_t **)malloc(n * sizeof(sol_t *));
+  b->shaped = true;
+}
+
+/** Batch fit
+ * @details A setup fits in a batch if it is solved by the calling thread on a
+ * single rank, its functional specification is the one of rad_specs.h and
+ * its grids match the shared grids of the batch, except for the quantity and
+ * effort bounds. The first fitting setup sets the shared grids.
+ * @param b Batch
+ * @param u Setup
+ * @return True if the setup fits */
+bool batch_fits(batch_t *b, const setup_t *u) {
+  const model_t *m = u->m;
+  const sol_t *s = u->s;
+
+  if (u->c->nt != 0 || u->c->nranks != 1 || m->util.fnc != util ||
+      m->cost.fnc != cost || m->radt.fnc != radt || m->wltt.fnc != wltt) {
+    return false;
+  }
+  if (!b->shaped) {
+    shape_batch(b, u);
+    return true;
+  }
+  return same_grid(&b->xg, s->xg) && same_grid(&b->rg, s->rg) &&
+         s->qg->n == b->qg.n && s->qg->m == b->qg.m &&
+         s->qg->w == b->qg.w && s->sg->n == b->sn;
+}
+
+/* The radius transition does not depend on the quantity (see solve_range()),
+ * thus the other parts of the specification use the transition of the
+ * current effort. */
+#pragma push_macro("_radt_")
+#undef _radt_
+#define _radt_ (v->rp)
+
+/** Solve batch range
+ * @details Calculates the value function and the policies of the logical
+ * states in [lbeg, lend) for all the active lanes. The values, the quantity
+ * grids and the maxima are calculated in the same way and order as in
+ * solve_range(), thus a lane's results equal the ones of its separate solve.
+ * @param b Batch
+ * @param lbeg First logical state index
+ * @param lend End logical state index */
+void batch_range(batch_t *b, int lbeg, int lend) {
+  int na = b->na;
+
+  for (int li = lbeg; li < lend; ++li) {
+    int xi = li / b->rg.n, ri = li % b->rg.n;
+    double x = b->xg.d[xi], r = b->rg.d[ri];
+
+    for (int si = 0; si < b->sn; ++si) {
+      const double *s = b->sv + (size_t)si * na;
+      for (int p = 0; p < na; ++p) {
+        batch_model_t pm = {b->alpha[p], b->delta[p], b->gamma[p], b->R[p]};
+        batch_var_t var = {.m = &pm, .x = x, .r = r, .s = s[p]};
+        b->rp[p] = batch_radt(&var);
+        b->rpli[p] = grid_liei(&b->rg, b->rp[p]);
+        b->hq[p] = (__min__(x / b->rp[p], b->qM[p]) - b->qg.m) / b->qs;
+      }
+      for (int qi = 0; qi < b->qg.n; ++qi) {
+        for (int p = 0; p < na; ++p) {
+          b->q[p] = b->qg.m + b->qw[qi] * b->hq[p];
+        }
+        for (int p = 0; p < na; ++p) {
+          batch_model_t pm = {b->alpha[p], b->delta[p], b->gamma[p], b->R[p]};
+          batch_var_t var = {&pm, x, r, s[p], b->q[p], b->rp[p]};
+          const batch_var_t *v = &var;
+          double xp = _wltt_;
+          double vp = linterpV12d(b->sols[p], grid_liei(&b->xg, xp),
+                                  b->rpli[p], xp, v->rp, NULL);
+          b->v[p] = _util_ - _cost_ + b->beta[p] * vp;
+        }
+        // Find maximum
+        bool first = qi == 0 && si == 0;
+        for (int p = 0; p < na; ++p) {
+          if (first || b->vopt[p] < b->v[p]) {
+            b->vopt[p] = b->v[p];
+            b->qopt[p] = b->q[p];
+            b->sopt[p] = s[p];
+          }
+        }
+      }
+    }
+
+    for (int p = 0; p < na; ++p) {
+      thread_init_t *td = &b->tds[b->act[p]];
+      td->v0buf[li] = b->vopt[p];
+      td->qpolbuf[li] = b->qopt[p];
+      td->spolbuf[li] = b->sopt[p];
+      double diff = fabs(td->v0buf[li] - b->sols[p]->v1[xi][ri]);
+      if (td->acc < diff)
+        td->acc = diff;
+      if (td->qM < td->qpolbuf[li])
+        td->qM = td->qpolbuf[li];
+      if (td->sM < td->spolbuf[li])
+        td->sM = td->spolbuf[li];
+      if (td->vM < td->v0buf[li])
+        td->vM = td->v0buf[li];
+    }
+  }
+}
+
+#pragma pop_macro("_radt_")
+
+/** Batch step
+ * @details Performs an iteration of the active lanes. The parameters, the
+ * effort grids and the quantity bounds of the lanes are gathered in the
+ * position arrays first.
+ * @param b Batch */
+void batch_step(batch_t *b) {
+  const range_t *g = &b->us[b->act[0]]->c->g;
+#if RAD_MULTITHREADING
+  double tbeg = rad_wall_time();
+#endif /* RAD_MULTITHREADING */
+
+  for (int p = 0; p < b->na; ++p) {
+    thread_init_t *td = &b->tds[b->act[p]];
+    const setup_t *u = td->u;
+    td->acc = 0;
+    td->qM = 0;
+    td->sM = 0;
+    td->vM = 0;
+    bind_buffers(td);
+    b->beta[p] = u->m->beta;
+    b->alpha[p] = u->m->alpha;
+    b->delta[p] = u->m->delta;
+    b->gamma[p] = u->m->gamma;
+    b->R[p] = u->m->R;
+    b->qM[p] = u->c->qM;
+    b->sols[p] = u->s;
+    for (int si = 0; si < b->sn; ++si) {
+      b->sv[(size_t)si * b->na + p] = u->s->sg->d[si];
+    }
+  }
 
-  main_fixed_point(&td);
+  batch_range(b, g->o, g->e);
+
+#if RAD_MULTITHREADING
+  for (int p = 0; p < b->na; ++p) {
+    thread_init_t *td = &b->tds[b->act[p]];
+#if !RAD_ZERO_COPY && RAD_CHUNK_SIZE > 0
+    copy_range(td, g->o, g->e);
+#endif /* RAD_ZERO_COPY && RAD_CHUNK_SIZE */
+    td->w->states += g->s;
+    td->w->tit = rad_wall_time() - tbeg;
+    td->w->tbusy += td->w->tit;
+  }
+#endif /* RAD_MULTITHREADING */
+}
 
-  free_thread_init(&td);
+/** Start batch lane
+ * @details Prepares the lane's setup as run_team() does for the main thread.
+ * A solve from the start calculates the initial values.
+ * @param b Batch
+ * @param k Lane index
+ * @param mode SETUP_BATCH_SOLVE or SETUP_BATCH_RESUME
+ * @return True if the lane iterates */
+bool start_lane(batch_t *b, int k, int mode) {
+  setup_t *u = b->us[k];
+  thread_init_t *td = &b->tds[k];
+
+  *td = (thread_init_t){
+      .wid = u->c->nt, .u = u, .pv0 = u->s->v0, .ovar = {.m = u->m}};
+  u->c->halt = HALT_NONE;
+  u->c->tsync = rad_wall_time();
+  alloc_thread_init(td);
+  if (mode == SETUP_BATCH_SOLVE) {
+    u->c->accbuf = u->s->tol + 1;
+    log_title(u);
+    init_step(td);
+    main_sync(td);
+  }
+  return iterating(u);
+}
 
-  join_all_threads(td.u);
+/** End batch lane
+ * @details Completes the lane's solve as main_fixed_point() and
+ * setup_solve() do.
+ * @param b Batch
+ * @param k Lane index
+ * @return The return value of the solve (see setup_solve()) */
+int end_lane(batch_t *b, int k) {
+  thread_init_t *td = &b->tds[k];
+
+  // swap if needed
+  if (td->u->s->it % 2 != 0) {
+    swapv1v0(td);
+  }
+  free_thread_init(td);
+  return end_solve(b->us[k], 0);
+}
 
+/** Fill batch lane
+ * @details Starts the next solves of the lane until one of them iterates or
+ * the lane is retired. A setup that does not fit in the batch is solved
+ * separately.
+ * @param b Batch
+ * @param k Lane index
+ * @param next Next solve callback
+ * @param done Solve result callback
+ * @param arg Callback argument */
+void fill_lane(batch_t *b, int k, setup_next_t next, setup_done_t done,
+               void *arg) {
+  int mode;
+
+  b->busy[k] = false;
+  while ((mode = next(arg, k)) != SETUP_BATCH_RETIRE) {
+    setup_t *u = b->us[k];
+    rad_ctx_set(u->x);
+    if (mode == SETUP_BATCH_SOLVE && cached_solve(u)) {
+      done(arg, k, 0);
+      continue;
+    }
+    if (!batch_fits(b, u)) {
+      LOGI("Lane %d does not fit in the batch, solving it separately", k);
+      done(arg, k,
+           mode == SETUP_BATCH_RESUME ? setup_resume(u) : setup_solve(u));
+      continue;
+    }
+    if (start_lane(b, k, mode)) {
+      b->busy[k] = true;
+      return;
+    }
+    done(arg, k, end_lane(b, k));
+  }
+}
+
+/** @brief Batched model solver
+ * @details Solves the setups of several lanes in lockstep (see the batched
+ * solves above). The next callback prepares the next solve of a lane, e.g. by
+ * resetting its setup (see setup_reset()) or loading a periodic save (see
+ * setup_load()), and it returns SETUP_BATCH_SOLVE or SETUP_BATCH_RESUME, or
+ * SETUP_BATCH_RETIRE if the lane has no further solves. The done callback
+ * receives the return value of every solve as soon as the lane's solve ends,
+ * i.e. its setup holds the solution until the next callback is called for the
+ * lane again. The setups must have no worker threads, i.e. their contexts
+ * have a zero thread budget, and they are solved by the calling thread. The
+ * grids of the setups must be the same except for the quantity and effort
+ * bounds, otherwise the setup is solved separately. Each solve converges,
+ * adapts its grids, saves and halts as in setup_solve().
+ * @param us Setups of the lanes
+ * @param n Number of lanes
+ * @param next Next solve callback (called with the lane index)
+ * @param done Solve result callback (called with the lane index)
+ * @param arg Callback argument
+ * @return Zero when all the lanes are retired */
+int setup_batch(setup_t *const *us, int n, setup_next_t next,
+                setup_done_t done, void *arg) {
+  batch_t b = {.us = us, .n = n};
+
+  b.tds = (thread_init_t *)calloc(n, sizeof(thread_init_t));
+  b.busy = (bool *)calloc(n, sizeof(bool));
+  b.act = (int *)malloc(n * sizeof(int));
+  for (int k = 0; k < n; ++k) {
+    fill_lane(&b, k, next, done, arg);
+  }
+
+  while (true) {
+    b.na = 0;
+    for (int k = 0; k < n; ++k) {
+      if (b.busy[k]) {
+        b.act[b.na++] = k;
+      }
+    }
+    if (b.na == 0) {
+      break;
+    }
+    batch_step(&b);
+    for (int p = 0; p < b.na; ++p) {
+      int k = b.act[p];
+      rad_ctx_set(us[k]->x);
+      main_sync(&b.tds[k]);
+      if (!iterating(us[k])) {
+        done(arg, k, end_lane(&b, k));
+        fill_lane(&b, k, next, done, arg);
+      }
+    }
+  }
+
+  if (b.shaped) {
+    free(b.xg.d);
+    free(b.rg.d);
+    free(b.qw);
+    free(b.buf);
+    free(b.rpli);
+    free(b.sols);
+  }
+  free(b.tds);
+  free(b.busy);
+  free(b.act);
   return 0;
 }
 
+/** @brief Setup rank
+ * @param u Initialized setup
+ * @return The rank of the calling process in the setup's solves (zero without
+ * MPI) */
+int setup_rank(const setup_t *u) { return u->c->rank; }
+
+void catch_halt(int sig) { halt_signal = sig; }
+
+/** @brief Catch halt signals
+ * @details Installs handlers of the SIGTERM and, where available, SIGUSR1
+ * signals that halt the running solves gracefully (see setup_solve()). Batch
+ * schedulers send them before they kill a job. The handlers are process-wide,
+ * thus they halt all the setups of the process. A caught signal halts later
+ * solves after their first iteration. */
+void setup_catch_signals(void) {
+  signal(SIGTERM, catch_halt);
+#ifdef SIGUSR1
+  signal(SIGUSR1, catch_halt);
+#endif
+}
+
 /** @brief Automatic last save point acquisition
  * @details This is an auxiliary function that located the last setup save point
  * in a particular folder. It is intended to be used in conjunction with the
  * periodic iteration backup functionality of the applications. When
  * RAD_SAVE_CYCLE is positive, the applications create backup binary files of
  * the execution status in the file system every RAD_SAVE_CYCLE iterations. The
- * files are stored in directories of the form ´itN`, where N is replaced by the
- * iteration count. This function searches into the applications' data path for
- * the greatest saved iteration. It stores the located path into the passed
- * character pointer.
- * @param save_point An output string that stores the last save point directory
+ * files are named ´itN.rad`, where N is replaced by the iteration count. This
+ * function searches into the applications' data path for the greatest saved
+ * iteration of the current context's output directory (see rad_ctx_set()). It
+ * stores the located path into the passed character pointer.
+ * @param save_point An output string that stores the last save point path
+ * without extension
  * @return Zero on success and non-zero otherwise */
 int setup_find_last_saved(char *save_point) {
   char dir_path[RAD_PATH_BUFFER_SZ];
 #if defined(__unix__) || defined(__APPLE__)
   DIR *dir;
-  struct dirent *ent, *last = NULL;
+  struct dirent *ent;
 
   snprintf(dir_path, RAD_PATH_BUFFER_SZ, "%s" CCM_FILE_SYSTEM_SEP "save",
-           RAD_TEMP_DIR);
+           rad_temp_dir());
   if ((dir = opendir(dir_path)) != NULL) {
     /* print all the files and directories within directory */
+    char name[sizeof(ent->d_name)] = {0};
     while ((ent = readdir(dir)) != NULL) {
-      if (strncmp("it", ent->d_name, 2) == 0) {
-        if (!last || strcmp(ent->d_name, last->d_name) > 0) {
-          last = ent;
+      size_t len = strlen(ent->d_name);
+      size_t ext = sizeof(RAD_FILE_EXT) - 1;
+      if (strncmp("it", ent->d_name, 2) == 0 && len > ext &&
+          strcmp(ent->d_name + len - ext, RAD_FILE_EXT) == 0) {
+        if (!name[0] || strcmp(ent->d_name, name) > 0) {
+          snprintf(name, sizeof(name), "%.*s", (int)(len - ext), ent->d_name);
         }
       }
     }
-    if (last) {
+    closedir(dir);
+    if (name[0]) {
       snprintf(save_point, RAD_PATH_BUFFER_SZ, "save" CCM_FILE_SYSTEM_SEP "%s",
-               last->d_name);
+               name);
     } else {
       return -1;
     }
-    closedir(dir);
   } else {
     LOGE("Failed to open directory");
     return -2;
@@ -823,8 +2777,9 @@ int setup_find_last_saved(char *save_point) {
   char last[RAD_PATH_BUFFER_SZ] = {0};
 
   snprintf(dir_path, RAD_PATH_BUFFER_SZ,
-           "%s" CCM_FILE_SYSTEM_SEP "save" CCM_FILE_SYSTEM_SEP "it*",
-           RAD_TEMP_DIR);
+           "%s" CCM_FILE_SYSTEM_SEP "save" CCM_FILE_SYSTEM_SEP
+           "it*" RAD_FILE_EXT,
+           rad_temp_dir());
 
   hFind = FindFirstFileA(dir_path, &ffd);
   if (hFind == INVALID_HANDLE_VALUE) {
@@ -837,10 +2792,64 @@ int setup_find_last_saved(char *save_point) {
       strncpy(last, ffd.cFileName, RAD_PATH_BUFFER_SZ);
     }
   } while (FindNextFileA(hFind, &ffd) != 0);
+  FindClose(hFind);
+  last[strlen(last) - (sizeof(RAD_FILE_EXT) - 1)] = '\0';
   snprintf(save_point, RAD_PATH_BUFFER_SZ, "save" CCM_FILE_SYSTEM_SEP "%s",
            last);
-  FindClose(hFind);
 #endif
 
   return 0;
 }
+
+/** @brief Clear save points
+ * @details Removes the periodic saves (`save/itN.rad`) of the current
+ * context's output directory (see setup_find_last_saved()), so that a new
+ * solve in the directory is not confused with an earlier one.
+ * @return The number of saves that could not be removed */
+int setup_clear_saved(void) {
+  char path[2 * RAD_PATH_BUFFER_SZ];
+  int failed = 0;
+#if defined(__unix__) || defined(__APPLE__)
+  DIR *dir;
+  struct dirent *ent;
+
+  snprintf(path, RAD_PATH_BUFFER_SZ, "%s" CCM_FILE_SYSTEM_SEP "save",
+           rad_temp_dir());
+  if ((dir = opendir(path)) == NULL) {
+    return 0;
+  }
+  while ((ent = readdir(dir)) != NULL) {
+    size_t len = strlen(ent->d_name);
+    size_t ext = sizeof(RAD_FILE_EXT) - 1;
+    if (strncmp("it", ent->d_name, 2) == 0 && len > ext &&
+        strcmp(ent->d_name + len - ext, RAD_FILE_EXT) == 0) {
+      snprintf(path, sizeof(path),
+               "%s" CCM_FILE_SYSTEM_SEP "save" CCM_FILE_SYSTEM_SEP "%s",
+               rad_temp_dir(), ent->d_name);
+      failed += remove(path) != 0;
+    }
+  }
+  closedir(dir);
+#else
+  WIN32_FIND_DATA ffd;
+  HANDLE hFind;
+
+  snprintf(path, RAD_PATH_BUFFER_SZ,
+           "%s" CCM_FILE_SYSTEM_SEP "save" CCM_FILE_SYSTEM_SEP
+           "it*" RAD_FILE_EXT,
+           rad_temp_dir());
+  hFind = FindFirstFileA(path, &ffd);
+  if (hFind == INVALID_HANDLE_VALUE) {
+    return 0;
+  }
+  do {
+    snprintf(path, sizeof(path),
+             "%s" CCM_FILE_SYSTEM_SEP "save" CCM_FILE_SYSTEM_SEP "%s",
+             rad_temp_dir(), ffd.cFileName);
+    failed += remove(path) != 0;
+  } while (FindNextFileA(hFind, &ffd) != 0);
+  FindClose(hFind);
+#endif
+
+  return failed;
+}
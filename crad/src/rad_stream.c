@@ -0,0 +1,316 @@
+#include "rad_stream.h"
+
+#include "cross_comp.h"
+#include "grid_t.h"
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+
+#ifndef __STDC_NO_ATOMICS__
+#include "stdatomic.h"
+#endif /* __STDC_NO_ATOMICS__ */
+
+#define LM_LEVEL 3
+#include "logger.h"
+
+/** Magic string */
+#define MAGIC "RADLIVE"
+/** Array alignment in bytes */
+#define ALIGN 64
+/** Number of copy attempts of stream_read() */
+#define READ_TRIES 64
+
+/** Header field offsets */
+#define OFF_VERSION 8
+#define OFF_XN 12
+#define OFF_RN 16
+#define OFF_SEQ 24
+#define OFF_IT 32
+#define OFF_STATE 36
+#define OFF_ACC 40
+#define OFF_TOL 48
+#define OFF_QM 56
+#define OFF_SM 64
+#define OFF_TIME 72
+
+/** Number of arrays (grids and variables) */
+#define NARRAYS 5
+
+static void put_i32(uint8_t *p, int32_t v) { memcpy(p, &v, sizeof(v)); }
+
+static int32_t get_i32(const uint8_t *p) {
+  int32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static void put_f64(uint8_t *p, double v) { memcpy(p, &v, sizeof(v)); }
+
+static double get_f64(const uint8_t *p) {
+  double v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+/* Without C11 atomics, the sequence number is a volatile variable. Then the
+ * accesses are ordered only on hosts with a total store order (e.g. x86). */
+
+static uint64_t seq_get(const uint8_t *seg) {
+#ifndef __STDC_NO_ATOMICS__
+  return atomic_load_explicit((const _Atomic uint64_t *)(seg + OFF_SEQ),
+                              memory_order_acquire);
+#else
+  return *(const volatile uint64_t *)(seg + OFF_SEQ);
+#endif /* __STDC_NO_ATOMICS__ */
+}
+
+/** Begin update
+ * @details Makes the sequence number odd before the segment is updated */
+static void write_begin(uint8_t *seg) {
+#ifndef __STDC_NO_ATOMICS__
+  _Atomic uint64_t *seq = (_Atomic uint64_t *)(seg + OFF_SEQ);
+  uint64_t next = atomic_load_explicit(seq, memory_order_relaxed) + 1;
+  atomic_store_explicit(seq, next, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+#else
+  ++*(volatile uint64_t *)(seg + OFF_SEQ);
+#endif /* __STDC_NO_ATOMICS__ */
+}
+
+/** End update
+ * @details Makes the sequence number even after the segment is updated */
+static void write_end(uint8_t *seg) {
+#ifndef __STDC_NO_ATOMICS__
+  _Atomic uint64_t *seq = (_Atomic uint64_t *)(seg + OFF_SEQ);
+  uint64_t next = atomic_load_explicit(seq, memory_order_relaxed) + 1;
+  atomic_store_explicit(seq, next, memory_order_release);
+#else
+  ++*(volatile uint64_t *)(seg + OFF_SEQ);
+#endif /* __STDC_NO_ATOMICS__ */
+}
+
+/** Check copy
+ * @details Checks that the sequence number did not change while the segment
+ * was copied */
+static bool read_valid(const uint8_t *seg, uint64_t seq) {
+#ifndef __STDC_NO_ATOMICS__
+  atomic_thread_fence(memory_order_acquire);
+  return atomic_load_explicit((const _Atomic uint64_t *)(seg + OFF_SEQ),
+                              memory_order_relaxed) == seq;
+#else
+  return *(const volatile uint64_t *)(seg + OFF_SEQ) == seq;
+#endif /* __STDC_NO_ATOMICS__ */
+}
+
+/** Segment layout
+ * @param xn Wealth grid size
+ * @param rn Radius grid size
+ * @param off Output offsets of the arrays (NARRAYS elements)
+ * @return The segment size in bytes */
+static size_t layout(int xn, int rn, size_t *off) {
+  size_t n[NARRAYS] = {xn, rn, (size_t)xn * rn, (size_t)xn * rn,
+                       (size_t)xn * rn};
+  size_t o = STREAM_HEAD_SZ;
+  for (int i = 0; i < NARRAYS; ++i) {
+    off[i] = o;
+    o = (o + n[i] * sizeof(double) + ALIGN - 1) / ALIGN * ALIGN;
+  }
+  return o;
+}
+
+/** Segment name
+ * @details Shared memory names start with a slash, which is added if the
+ * passed name lacks it */
+static void segment_name(char *dest, const char *name) {
+  snprintf(dest, RAD_PATH_BUFFER_SZ, "%s%s", name[0] == '/' ? "" : "/", name);
+}
+
+/** @brief Initialize stream writer
+ * @details Creates the named shared memory segment for solutions of the passed
+ * grid sizes, replacing an existing segment of the same name. The segment
+ * holds no frame until the first stream_publish().
+ * @param t Stream (uninitialized or freed)
+ * @param name Segment name
+ * @param xn Wealth grid size
+ * @param rn Radius grid size
+ * @return Zero on success, non-zero otherwise */
+int stream_init(stream_t *t, const char *name, int xn, int rn) {
+  size_t off[NARRAYS];
+  char buf[RAD_PATH_BUFFER_SZ];
+
+  // The name can be the stream's own one
+  segment_name(buf, name);
+  memset(t, 0, sizeof(*t));
+  memcpy(t->name, buf, sizeof(buf));
+  t->size = layout(xn, rn, off);
+  if ((t->seg = (uint8_t *)shm_create(t->name, t->size)) == NULL) {
+    LOGE("Failed to create stream segment '%s'", t->name);
+    return -1;
+  }
+  memset(t->seg, 0, STREAM_HEAD_SZ);
+  memcpy(t->seg, MAGIC, sizeof(MAGIC));
+  uint32_t version = STREAM_VERSION;
+  memcpy(t->seg + OFF_VERSION, &version, sizeof(version));
+  put_i32(t->seg + OFF_XN, xn);
+  put_i32(t->seg + OFF_RN, rn);
+  t->xn = xn;
+  t->rn = rn;
+  t->owner = true;
+
+  return 0;
+}
+
+/** @brief Publish frame
+ * @details Copies the passed solution's grids, value function and policies
+ * and its iteration state into the stream's segment. If the grid sizes of the
+ * solution differ from the segment's ones, the segment is replaced by a new
+ * one of the same name. The function never waits for readers.
+ * @param t Stream writer
+ * @param s Solution
+ * @param state Solve state (e.g. STREAM_SOLVING)
+ * @param time Wall-clock time in seconds */
+void stream_publish(stream_t *t, const sol_t *s, int state, double time) {
+  size_t off[NARRAYS];
+
+  if (!t->seg) {
+    return;
+  }
+  if (s->xg->n != t->xn || s->rg->n != t->rn) {
+    stream_free(t);
+    if (stream_init(t, t->name, s->xg->n, s->rg->n) != 0) {
+      return;
+    }
+  }
+  layout(t->xn, t->rn, off);
+  size_t ls = (size_t)t->xn * t->rn;
+
+  write_begin(t->seg);
+  put_i32(t->seg + OFF_IT, s->it);
+  put_i32(t->seg + OFF_STATE, state);
+  put_f64(t->seg + OFF_ACC, s->acc);
+  put_f64(t->seg + OFF_TOL, s->tol);
+  put_f64(t->seg + OFF_QM, s->qg->M);
+  put_f64(t->seg + OFF_SM, s->sg->M);
+  put_f64(t->seg + OFF_TIME, time);
+  memcpy(t->seg + off[0], s->xg->d, t->xn * sizeof(double));
+  memcpy(t->seg + off[1], s->rg->d, t->rn * sizeof(double));
+  // The rows of the variables are contiguous
+  memcpy(t->seg + off[2], s->v1[0], ls * sizeof(double));
+  memcpy(t->seg + off[3], s->qpol[0], ls * sizeof(double));
+  memcpy(t->seg + off[4], s->spol[0], ls * sizeof(double));
+  write_end(t->seg);
+}
+
+/** @brief Attach stream reader
+ * @details Maps the named segment of a stream writer for reading.
+ * @param t Uninitialized stream
+ * @param name Segment name
+ * @return Zero on success, non-zero otherwise */
+int stream_attach(stream_t *t, const char *name) {
+  size_t off[NARRAYS];
+  uint32_t version;
+
+  memset(t, 0, sizeof(*t));
+  segment_name(t->name, name);
+  if ((t->seg = (uint8_t *)shm_attach(t->name, &t->size)) == NULL) {
+    return -1;
+  }
+  memcpy(&version, t->seg + OFF_VERSION, sizeof(version));
+  t->xn = get_i32(t->seg + OFF_XN);
+  t->rn = get_i32(t->seg + OFF_RN);
+  if (t->size < STREAM_HEAD_SZ || memcmp(t->seg, MAGIC, sizeof(MAGIC)) ||
+      version != STREAM_VERSION || t->xn < 0 || t->rn < 0 ||
+      t->size < layout(t->xn, t->rn, off)) {
+    unmap_file(t->seg, t->size);
+    t->seg = NULL;
+    return -2;
+  }
+
+  return 0;
+}
+
+/** @brief Read frame
+ * @details Copies the stream's segment into the passed frame if it holds a
+ * newer frame than the passed one. Copies that overlap with an update of the
+ * writer are retried. The frame must be zero-initialized before its first
+ * read.
+ * @param t Stream reader
+ * @param f Frame
+ * @return Zero if a new frame is read, one if there is no new frame, -1 if
+ * the writer updated the segment during every copy attempt and -2 if the
+ * segment is closed (the frame holds the last published data then) */
+int stream_read(const stream_t *t, stream_frame_t *f) {
+  size_t off[NARRAYS];
+  size_t size = layout(t->xn, t->rn, off);
+
+  if (f->bufsz < size) {
+    free(f->buf);
+    f->buf = (uint8_t *)malloc(size);
+    f->bufsz = f->buf ? size : 0;
+    f->seq = 0;
+    if (!f->buf) {
+      return -1;
+    }
+  }
+
+  for (int i = 0; i < READ_TRIES; ++i) {
+    uint64_t seq = seq_get(t->seg);
+    if (seq & 1) {
+      continue;
+    }
+    if (seq == f->seq) {
+      return 1;
+    }
+    memcpy(f->buf, t->seg, size);
+    if (!read_valid(t->seg, seq)) {
+      continue;
+    }
+
+    f->seq = seq;
+    f->it = get_i32(f->buf + OFF_IT);
+    f->state = get_i32(f->buf + OFF_STATE);
+    f->acc = get_f64(f->buf + OFF_ACC);
+    f->tol = get_f64(f->buf + OFF_TOL);
+    f->qM = get_f64(f->buf + OFF_QM);
+    f->sM = get_f64(f->buf + OFF_SM);
+    f->time = get_f64(f->buf + OFF_TIME);
+    f->xn = t->xn;
+    f->rn = t->rn;
+    f->xg = (const double *)(f->buf + off[0]);
+    f->rg = (const double *)(f->buf + off[1]);
+    f->v1 = (const double *)(f->buf + off[2]);
+    f->qpol = (const double *)(f->buf + off[3]);
+    f->spol = (const double *)(f->buf + off[4]);
+    return f->state == STREAM_CLOSED ? -2 : 0;
+  }
+
+  return -1;
+}
+
+/** @brief Free frame
+ * @param f Frame */
+void stream_frame_free(stream_frame_t *f) {
+  free(f->buf);
+  memset(f, 0, sizeof(*f));
+}
+
+/** @brief Free stream
+ * @details A writer marks its segment closed and removes it; readers that are
+ * still attached keep their mapping. A reader detaches from the segment.
+ * @param t Stream */
+void stream_free(stream_t *t) {
+  if (!t->seg) {
+    return;
+  }
+  if (t->owner) {
+    write_begin(t->seg);
+    put_i32(t->seg + OFF_STATE, STREAM_CLOSED);
+    write_end(t->seg);
+  }
+  unmap_file(t->seg, t->size);
+  if (t->owner) {
+    shm_remove(t->name);
+  }
+  t->seg = NULL;
+}
@@ -0,0 +1,743 @@
+#include "rad_sweep.h"
+
+#include "cross_comp.h"
+#include "grid_t.h"
+#include "rad_codec.h"
+#include "rad_ctx.h"
+
+#include "ctype.h"
+#include "errno.h"
+#include "stdbool.h"
+#include "stdlib.h"
+#include "string.h"
+
+#define LM_LEVEL 3
+#include "logger.h"
+
+/** Magic string (without terminating zero) */
+#define MAGIC "RADSWEEP"
+/** Offset of the parameter and variable names */
+#define OFF_NAMES (2 * SWEEP_SLOT_SZ)
+/** Offset of the stored indices */
+#define OFF_INDEX (OFF_NAMES + (1 + SWEEP_NVARS) * SWEEP_NAME_SZ)
+/** Number of arrays (indices, grid values, point table and variables) */
+#define NARRAYS (5 + SWEEP_NVARS)
+
+/** Variable names */
+static const char *vnames[SWEEP_NVARS] = {"v0", "qpol", "spol"};
+
+static void put_u32(uint8_t *p, uint32_t v) {
+  for (int i = 0; i < 4; ++i) {
+    p[i] = (uint8_t)(v >> (8 * i));
+  }
+}
+
+static void put_u64(uint8_t *p, uint64_t v) {
+  for (int i = 0; i < 8; ++i) {
+    p[i] = (uint8_t)(v >> (8 * i));
+  }
+}
+
+static void put_f64(uint8_t *p, double v) {
+  uint64_t bits;
+  memcpy(&bits, &v, sizeof(bits));
+  put_u64(p, bits);
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+  uint32_t v = 0;
+  for (int i = 0; i < 4; ++i) {
+    v |= (uint32_t)p[i] << (8 * i);
+  }
+  return v;
+}
+
+static uint64_t get_u64(const uint8_t *p) {
+  uint64_t v = 0;
+  for (int i = 0; i < 8; ++i) {
+    v |= (uint64_t)p[i] << (8 * i);
+  }
+  return v;
+}
+
+static double get_f64(const uint8_t *p) {
+  uint64_t bits = get_u64(p);
+  double v;
+  memcpy(&v, &bits, sizeof(v));
+  return v;
+}
+
+static uint64_t align_up(uint64_t n) {
+  return (n + SWEEP_ALIGN - 1) / SWEEP_ALIGN * SWEEP_ALIGN;
+}
+
+/** Store layout
+ * @param cap Point capacity
+ * @param xn Number of stored wealth indices
+ * @param rn Number of stored radius indices
+ * @param off Output offsets of the arrays (NARRAYS elements); the wealth
+ * indices and values, the radius indices and values, the point table and the
+ * variables
+ * @return The file size in bytes */
+static uint64_t layout(uint64_t cap, int xn, int rn, uint64_t *off) {
+  uint64_t ls = (uint64_t)xn * rn;
+  uint64_t n[NARRAYS] = {4 * (uint64_t)xn, 8 * (uint64_t)xn, 4 * (uint64_t)rn,
+                         8 * (uint64_t)rn, cap * SWEEP_ENTRY_SZ};
+  for (int i = 0; i < SWEEP_NVARS; ++i) {
+    n[5 + i] = cap * ls * sizeof(double);
+  }
+  uint64_t o = align_up(OFF_INDEX);
+  for (int i = 0; i < NARRAYS; ++i) {
+    off[i] = o;
+    o = align_up(o + n[i]);
+  }
+  return o;
+}
+
+/** Parse index subset
+ * @param spec Comma separated list of indices (can be NULL)
+ * @param n Output number of indices (zero for NULL)
+ * @return The indices, or NULL if the list is NULL or invalid */
+static int *parse_subset(const char *spec, int *n) {
+  char *end;
+  int *idx = NULL;
+
+  *n = 0;
+  if (!spec) {
+    return NULL;
+  }
+  idx = (int *)malloc((strlen(spec) / 2 + 1) * sizeof(int));
+  while (*spec) {
+    long v = strtol(spec, &end, 10);
+    if (end == spec || v < 0) {
+      LOGE("Invalid index subset '%s'", spec);
+      free(idx);
+      *n = 0;
+      return NULL;
+    }
+    idx[(*n)++] = (int)v;
+    for (spec = end; *spec == ',' || isspace((unsigned char)*spec); ++spec) {
+    }
+  }
+  return idx;
+}
+
+/** Store file names
+ * @details Creates the missing directories of the store's path.
+ * @param w Sweep store
+ * @param filename Output file name
+ * @param part Output name of the hidden file of rewrites
+ * @param sz Size of the name buffers */
+static void file_names(const sweep_t *w, char *filename, char *part,
+                       size_t sz) {
+  const char *sep = strrchr(w->path, CCM_FILE_SYSTEM_SEP[0]);
+  int dn = sep ? (int)(sep - w->path) : 0;
+
+  if (sep) {
+    snprintf(filename, sz, "%s" CCM_FILE_SYSTEM_SEP "%.*s", rad_temp_dir(), dn,
+             w->path);
+    mkdirp(filename, 0755);
+    ++dn;
+  }
+  snprintf(filename, sz, "%s" CCM_FILE_SYSTEM_SEP "%s" RAD_SWEEP_EXT,
+           rad_temp_dir(), w->path);
+  snprintf(part, sz, "%s" CCM_FILE_SYSTEM_SEP "%.*s.%s" RAD_SWEEP_EXT,
+           rad_temp_dir(), dn, w->path, w->path + dn);
+}
+
+/** Write data
+ * @return Zero on success, non-zero otherwise */
+static int write_at(FILE *fh, uint64_t offset, const void *data, size_t n) {
+  return seek_file(fh, offset) != 0 || fwrite(data, 1, n, fh) != n;
+}
+
+/** Commit header
+ * @details Writes the store's state as the next header generation to the
+ * older slot and synchronizes the file.
+ * @param w Sweep store
+ * @param fh Store file
+ * @return Zero on success, non-zero otherwise */
+static int commit(sweep_t *w, FILE *fh) {
+  uint8_t slot[SWEEP_SLOT_SZ] = {0};
+
+  ++w->gen;
+  memcpy(slot, MAGIC, 8);
+  put_u32(slot + 8, SWEEP_VERSION);
+  put_u32(slot + 12, SWEEP_NVARS);
+  put_u64(slot + 16, w->gen);
+  put_u64(slot + 24, w->cap);
+  put_u64(slot + 32, w->count);
+  put_u32(slot + 40, w->xn);
+  put_u32(slot + 44, w->rn);
+  put_u32(slot + 48, w->xN);
+  put_u32(slot + 52, w->rN);
+  put_u32(slot + 56, codec_crc32(0, slot, 56));
+
+  return write_at(fh, (w->gen % 2) * SWEEP_SLOT_SZ, slot, sizeof(slot)) ||
+         sync_file(fh);
+}
+
+/** Read header
+ * @details Reads the valid header slot of the greatest generation of a mapped
+ * store file into the passed store's state.
+ * @param w Sweep store
+ * @param map Mapped store file
+ * @param size File size in bytes
+ * @return Zero on success, non-zero if no slot is valid */
+static int read_header(sweep_t *w, const uint8_t *map, size_t size) {
+  uint64_t off[NARRAYS];
+  int ec = -1;
+
+  for (int k = 0; k < 2 && size >= 2 * SWEEP_SLOT_SZ; ++k) {
+    const uint8_t *p = map + k * SWEEP_SLOT_SZ;
+    if (memcmp(p, MAGIC, 8) || get_u32(p + 8) != SWEEP_VERSION ||
+        get_u32(p + 12) != SWEEP_NVARS ||
+        get_u32(p + 56) != codec_crc32(0, p, 56) ||
+        (ec == 0 && get_u64(p + 16) < w->gen)) {
+      continue;
+    }
+    w->gen = get_u64(p + 16);
+    w->cap = get_u64(p + 24);
+    w->count = get_u64(p + 32);
+    w->xn = (int)get_u32(p + 40);
+    w->rn = (int)get_u32(p + 44);
+    w->xN = (int)get_u32(p + 48);
+    w->rN = (int)get_u32(p + 52);
+    ec = 0;
+  }
+  if (ec == 0 && (w->count > w->cap || layout(w->cap, w->xn, w->rn, off) >
+                                           (uint64_t)size)) {
+    ec = -2;
+  }
+  return ec;
+}
+
+/** Create store file
+ * @details Writes the store with the passed capacity in the hidden file and
+ * renames it to the store's file name. The committed points of the previous
+ * store file are copied.
+ * @param w Sweep store
+ * @param cap Point capacity
+ * @param old Mapped previous store file (NULL for a new store)
+ * @param ocap Point capacity of the previous store file
+ * @return Zero on success, non-zero otherwise */
+static int create(sweep_t *w, uint64_t cap, const uint8_t *old,
+                  uint64_t ocap) {
+  char filename[2 * RAD_PATH_BUFFER_SZ], part[2 * RAD_PATH_BUFFER_SZ];
+  uint64_t off[NARRAYS], ooff[NARRAYS];
+  uint8_t names[(1 + SWEEP_NVARS) * SWEEP_NAME_SZ] = {0};
+  uint8_t *buf;
+  int ec = 0;
+
+  file_names(w, filename, part, sizeof(filename));
+  uint64_t size = layout(cap, w->xn, w->rn, off);
+  FILE *fh = fopen(part, "wb");
+  if (!fh) {
+    LOGE("Failed to open '%s' with errno %d", part, errno);
+    return -1;
+  }
+
+  memcpy(names, w->param, strlen(w->param));
+  for (int i = 0; i < SWEEP_NVARS; ++i) {
+    memcpy(names + (1 + i) * SWEEP_NAME_SZ, vnames[i], strlen(vnames[i]));
+  }
+  ec |= write_at(fh, OFF_NAMES, names, sizeof(names));
+
+  buf = (uint8_t *)malloc(8 * (size_t)(w->xn > w->rn ? w->xn : w->rn));
+  for (int i = 0; i < w->xn; ++i) {
+    put_u32(buf + 4 * i, w->xi[i]);
+  }
+  ec |= write_at(fh, off[0], buf, 4 * (size_t)w->xn);
+  for (int i = 0; i < w->xn; ++i) {
+    put_f64(buf + 8 * i, w->xv[i]);
+  }
+  ec |= write_at(fh, off[1], buf, 8 * (size_t)w->xn);
+  for (int i = 0; i < w->rn; ++i) {
+    put_u32(buf + 4 * i, w->ri[i]);
+  }
+  ec |= write_at(fh, off[2], buf, 4 * (size_t)w->rn);
+  for (int i = 0; i < w->rn; ++i) {
+    put_f64(buf + 8 * i, w->rv[i]);
+  }
+  ec |= write_at(fh, off[3], buf, 8 * (size_t)w->rn);
+  free(buf);
+
+  if (old) {
+    // The arrays are copied in their little-endian representation
+    size_t ls = (size_t)w->xn * w->rn * sizeof(double);
+    layout(ocap, w->xn, w->rn, ooff);
+    for (int i = 4; i < NARRAYS; ++i) {
+      size_t n = (size_t)w->count * (i == 4 ? SWEEP_ENTRY_SZ : ls);
+      ec |= write_at(fh, off[i], old + ooff[i], n);
+    }
+  }
+  // The file is extended to its final size
+  ec |= write_at(fh, size - 1, "", 1);
+
+  uint64_t gen = w->gen, prev = w->cap;
+  w->cap = cap;
+  ec |= commit(w, fh);
+  ec |= fclose(fh) != 0;
+  if (ec || (ec = rename_replace(part, filename)) != 0) {
+    LOGE("Failed to write sweep store '%s' with errno %d", part, errno);
+    remove(part);
+    w->gen = gen;
+    w->cap = prev;
+    return -2;
+  }
+  if (!(w->fh = fopen(filename, "r+b"))) {
+    LOGE("Failed to open '%s' with errno %d", filename, errno);
+    return -3;
+  }
+
+  return 0;
+}
+
+/** Grow store
+ * @details Rewrites the store with twice its capacity.
+ * @param w Sweep store
+ * @return Zero on success, non-zero otherwise */
+static int grow(sweep_t *w) {
+  char filename[2 * RAD_PATH_BUFFER_SZ], part[2 * RAD_PATH_BUFFER_SZ];
+  size_t size;
+
+  file_names(w, filename, part, sizeof(filename));
+  fclose(w->fh);
+  w->fh = NULL;
+  uint8_t *old = (uint8_t *)map_file(filename, &size);
+  if (!old) {
+    LOGE("Failed to map sweep store '%s'", filename);
+    return -1;
+  }
+  int ec = create(w, 2 * w->cap, old, w->cap);
+  unmap_file(old, size);
+  return ec;
+}
+
+/** Open new store
+ * @details Selects the stored indices for the passed solution's grids and
+ * creates the store file, replacing an existing one.
+ * @param w Sweep store
+ * @param s Solution
+ * @return Zero on success, non-zero otherwise */
+static int open_new(sweep_t *w, const sol_t *s) {
+  int **sub[2] = {&w->xi, &w->ri}, *n[2] = {&w->xn, &w->rn};
+  int N[2] = {w->xN = s->xg->n, w->rN = s->rg->n};
+
+  for (int k = 0; k < 2; ++k) {
+    if (!*sub[k]) {
+      *n[k] = N[k];
+      *sub[k] = (int *)malloc(N[k] * sizeof(int));
+      for (int i = 0; i < N[k]; ++i) {
+        (*sub[k])[i] = i;
+      }
+    }
+    for (int i = 0; i < *n[k]; ++i) {
+      if ((*sub[k])[i] >= N[k]) {
+        LOGE("Stored index %d exceeds the grid size %d", (*sub[k])[i], N[k]);
+        return -1;
+      }
+    }
+  }
+
+  w->xv = (double *)malloc(w->xn * sizeof(double));
+  w->rv = (double *)malloc(w->rn * sizeof(double));
+  for (int i = 0; i < w->xn; ++i) {
+    w->xv[i] = s->xg->d[w->xi[i]];
+  }
+  for (int i = 0; i < w->rn; ++i) {
+    w->rv[i] = s->rg->d[w->ri[i]];
+  }
+  w->count = 0;
+  w->gen = 0;
+
+  return create(w, w->cap, NULL, 0);
+}
+
+/** @brief Initialize sweep store
+ * @details Prepares a sweep store writer. The store file is created by the
+ * first append, replacing an existing file of the same path, unless the
+ * existing file is opened with sweep_open().
+ * @param w Uninitialized sweep store
+ * @param param Parameter name
+ * @param path Store path relative to the output directory and without
+ * extension (e.g. `delta` is stored as `delta.sweep`)
+ * @param cap Expected number of points (the store grows if it is exceeded)
+ * @param xsub Comma separated list of the stored wealth indices (NULL for all)
+ * @param rsub Comma separated list of the stored radius indices (NULL for all)
+ * @return Zero on success, non-zero if a list is invalid */
+int sweep_init(sweep_t *w, const char *param, const char *path, int cap,
+               const char *xsub, const char *rsub) {
+  memset(w, 0, sizeof(*w));
+  snprintf(w->param, SWEEP_NAME_SZ, "%s", param);
+  snprintf(w->path, RAD_PATH_BUFFER_SZ, "%s", path);
+  w->cap = cap > 0 ? cap : 1;
+  w->xi = parse_subset(xsub, &w->xn);
+  w->ri = parse_subset(rsub, &w->rn);
+
+  return (xsub && !w->xi) || (rsub && !w->ri);
+}
+
+/** Match grids
+ * @details Adopts the stored indices and grid values of a mapped store file,
+ * or compares them with the ones of the passed store if they are known.
+ * @param w Sweep store
+ * @param o Header of the store file (see read_header())
+ * @param map Mapped store file
+ * @return Zero on success, non-zero if the stored grids differ */
+static int match_grids(sweep_t *w, const sweep_t *o, const uint8_t *map) {
+  uint64_t off[NARRAYS];
+  int ec = 0;
+
+  if ((w->xi && w->xn != o->xn) || (w->ri && w->rn != o->rn) ||
+      (w->xv && (w->xN != o->xN || w->rN != o->rN))) {
+    return -1;
+  }
+  layout(o->cap, o->xn, o->rn, off);
+  int **sub[2] = {&w->xi, &w->ri}, n[2] = {o->xn, o->rn};
+  double **v[2] = {&w->xv, &w->rv};
+  for (int k = 0; k < 2; ++k) {
+    const uint8_t *idx = map + off[2 * k], *val = map + off[2 * k + 1];
+    if (!*sub[k]) {
+      *sub[k] = (int *)malloc(n[k] * sizeof(int));
+      for (int i = 0; i < n[k]; ++i) {
+        (*sub[k])[i] = (int)get_u32(idx + 4 * i);
+      }
+    }
+    for (int i = 0; i < n[k]; ++i) {
+      ec |= (*sub[k])[i] != (int)get_u32(idx + 4 * i);
+    }
+    if (*v[k]) {
+      for (int i = 0; i < n[k]; ++i) {
+        ec |= (*v[k])[i] != get_f64(val + 8 * i);
+      }
+      continue;
+    }
+    *v[k] = (double *)malloc(n[k] * sizeof(double));
+    for (int i = 0; i < n[k]; ++i) {
+      (*v[k])[i] = get_f64(val + 8 * i);
+    }
+  }
+  if (ec) {
+    return -2;
+  }
+
+  w->xn = o->xn;
+  w->rn = o->rn;
+  w->xN = o->xN;
+  w->rN = o->rN;
+  return 0;
+}
+
+/** @brief Open sweep store
+ * @details Prepares an initialized store (see sweep_init()) to append to its
+ * existing file instead of replacing it. The file's parameter name and, if
+ * subsets are initialized, its stored indices must match.
+ * @param w Initialized sweep store
+ * @return Zero on success, -1 if there is no file, non-zero if the file cannot
+ * be appended to */
+int sweep_open(sweep_t *w) {
+  char filename[2 * RAD_PATH_BUFFER_SZ], part[2 * RAD_PATH_BUFFER_SZ];
+  sweep_t o;
+  size_t size;
+
+  file_names(w, filename, part, sizeof(filename));
+  uint8_t *map = (uint8_t *)map_file(filename, &size);
+  if (!map) {
+    return -1;
+  }
+  memset(&o, 0, sizeof(o));
+  if (read_header(&o, map, size) != 0 ||
+      strncmp((const char *)map + OFF_NAMES, w->param, SWEEP_NAME_SZ)) {
+    unmap_file(map, size);
+    return -2;
+  }
+  int ec = match_grids(w, &o, map);
+  unmap_file(map, size);
+  if (ec) {
+    return -3;
+  }
+
+  w->cap = o.cap;
+  w->count = o.count;
+  w->gen = o.gen;
+  if (!(w->fh = fopen(filename, "r+b"))) {
+    LOGE("Failed to open '%s' with errno %d", filename, errno);
+    return -4;
+  }
+  return 0;
+}
+
+/** @brief Append point
+ * @details Appends the passed solution of a parameter value to the store and
+ * commits it (see rad_sweep.h). The grids of all the points must be equal.
+ * @param w Sweep store
+ * @param s Solution
+ * @param value Parameter value
+ * @return Zero on success, non-zero otherwise */
+int sweep_append(sweep_t *w, const sol_t *s, double value) {
+  uint64_t off[NARRAYS];
+  uint8_t entry[SWEEP_ENTRY_SZ] = {0};
+  uint32_t crc = 0;
+  int ec = 0;
+
+  if (!w->fh) {
+    // A store that failed to be created or rewritten is not retried
+    if (w->xN || open_new(w, s) != 0) {
+      return -1;
+    }
+  }
+  if (s->xg->n != w->xN || s->rg->n != w->rN) {
+    LOGE("Grid sizes differ from the ones of sweep store '%s'", w->path);
+    return -2;
+  }
+  for (int i = 0; i < w->xn; ++i) {
+    ec |= s->xg->d[w->xi[i]] != w->xv[i];
+  }
+  for (int i = 0; i < w->rn; ++i) {
+    ec |= s->rg->d[w->ri[i]] != w->rv[i];
+  }
+  if (ec) {
+    LOGE("Grids differ from the ones of sweep store '%s'", w->path);
+    return -2;
+  }
+  if (w->count == w->cap && grow(w) != 0) {
+    return -3;
+  }
+
+  layout(w->cap, w->xn, w->rn, off);
+  size_t ls = (size_t)w->xn * w->rn * sizeof(double);
+  uint8_t *buf = (uint8_t *)malloc(ls);
+  double **const vars[SWEEP_NVARS] = {s->v0, s->qpol, s->spol};
+  for (int k = 0; k < SWEEP_NVARS; ++k) {
+    for (int i = 0; i < w->xn; ++i) {
+      for (int j = 0; j < w->rn; ++j) {
+        put_f64(buf + ((size_t)i * w->rn + j) * sizeof(double),
+                vars[k][w->xi[i]][w->ri[j]]);
+      }
+    }
+    crc = codec_crc32(crc, buf, ls);
+    ec |= write_at(w->fh, off[5 + k] + w->count * ls, buf, ls);
+  }
+  free(buf);
+
+  put_f64(entry, value);
+  put_f64(entry + 8, s->acc);
+  put_u32(entry + 16, (uint32_t)s->it);
+  put_u32(entry + 20, crc);
+  ec |= write_at(w->fh, off[4] + w->count * SWEEP_ENTRY_SZ, entry,
+                 sizeof(entry));
+  // The point's data must be durable before the header refers to them
+  ec |= sync_file(w->fh);
+  if (ec) {
+    LOGE("Failed to append to sweep store '%s' with errno %d", w->path, errno);
+    return -4;
+  }
+
+  ++w->count;
+  if (commit(w, w->fh) != 0) {
+    --w->count;
+    LOGE("Failed to commit sweep store '%s' with errno %d", w->path, errno);
+    return -5;
+  }
+  return 0;
+}
+
+/** @brief Copy point
+ * @details Appends the last point of the passed parameter value of another
+ * store file to the store and commits it. The parameter names and the stored
+ * grids of the stores must be equal. A store that is not created yet adopts
+ * the stored grids of the other store file.
+ * @param w Sweep store
+ * @param path Path of the other store relative to the output directory and
+ * without extension
+ * @param value Parameter value
+ * @param it Output iteration count of the point
+ * @param acc Output achieved accuracy of the point
+ * @return Zero on success, non-zero otherwise */
+int sweep_copy(sweep_t *w, const char *path, double value, int *it,
+               double *acc) {
+  char filename[2 * RAD_PATH_BUFFER_SZ];
+  uint64_t off[NARRAYS], ooff[NARRAYS];
+  const uint8_t *entry = NULL;
+  sweep_t o;
+  size_t size;
+  int ec = 0;
+
+  snprintf(filename, sizeof(filename),
+           "%s" CCM_FILE_SYSTEM_SEP "%s" RAD_SWEEP_EXT, rad_temp_dir(), path);
+  uint8_t *map = (uint8_t *)map_file(filename, &size);
+  if (!map) {
+    LOGE("Failed to map sweep store '%s'", filename);
+    return -1;
+  }
+  memset(&o, 0, sizeof(o));
+  if (read_header(&o, map, size) != 0 ||
+      strncmp((const char *)map + OFF_NAMES, w->param, SWEEP_NAME_SZ)) {
+    LOGE("Sweep store '%s' does not match '%s'", filename, w->path);
+    unmap_file(map, size);
+    return -2;
+  }
+  layout(o.cap, o.xn, o.rn, ooff);
+  for (uint64_t i = 0; i < o.count; ++i) {
+    const uint8_t *e = map + ooff[4] + i * SWEEP_ENTRY_SZ;
+    entry = get_f64(e) == value ? e : entry;
+  }
+  if (!entry) {
+    unmap_file(map, size);
+    return -3;
+  }
+
+  if (!w->fh) {
+    // A store that failed to be created or rewritten is not retried
+    ec = w->xN || match_grids(w, &o, map) != 0 || create(w, w->cap, NULL, 0);
+  } else {
+    ec = match_grids(w, &o, map);
+  }
+  if (ec) {
+    LOGE("Grids differ from the ones of sweep store '%s'", w->path);
+    unmap_file(map, size);
+    return -4;
+  }
+  if (w->count == w->cap && grow(w) != 0) {
+    unmap_file(map, size);
+    return -5;
+  }
+
+  // The point's entry and data are copied in their little-endian form
+  uint64_t k = (uint64_t)(entry - map - ooff[4]) / SWEEP_ENTRY_SZ;
+  size_t ls = (size_t)w->xn * w->rn * sizeof(double);
+  layout(w->cap, w->xn, w->rn, off);
+  for (int v = 0; v < SWEEP_NVARS; ++v) {
+    const uint8_t *data = map + ooff[5 + v] + k * ls;
+    ec |= write_at(w->fh, off[5 + v] + w->count * ls, data, ls);
+  }
+  ec |= write_at(w->fh, off[4] + w->count * SWEEP_ENTRY_SZ, entry,
+                 SWEEP_ENTRY_SZ);
+  *it = (int)get_u32(entry + 16);
+  *acc = get_f64(entry + 8);
+  unmap_file(map, size);
+  ec |= sync_file(w->fh);
+  if (ec) {
+    LOGE("Failed to append to sweep store '%s' with errno %d", w->path, errno);
+    return -6;
+  }
+
+  ++w->count;
+  if (commit(w, w->fh) != 0) {
+    --w->count;
+    LOGE("Failed to commit sweep store '%s' with errno %d", w->path, errno);
+    return -7;
+  }
+  return 0;
+}
+
+/** @brief Read sweep index
+ * @details Reads the parameter values and the iteration counts of the
+ * committed points of a store file.
+ * @param path Store path relative to the output directory and without
+ * extension
+ * @param values Output parameter values (freed by the caller)
+ * @param its Output iteration counts (freed by the caller)
+ * @return The number of points, or a negative value if the store cannot be
+ * read */
+int sweep_index(const char *path, double **values, int **its) {
+  char filename[2 * RAD_PATH_BUFFER_SZ];
+  uint64_t off[NARRAYS];
+  sweep_t w;
+  size_t size;
+
+  snprintf(filename, sizeof(filename),
+           "%s" CCM_FILE_SYSTEM_SEP "%s" RAD_SWEEP_EXT, rad_temp_dir(), path);
+  uint8_t *map = (uint8_t *)map_file(filename, &size);
+  if (!map) {
+    return -1;
+  }
+  memset(&w, 0, sizeof(w));
+  if (read_header(&w, map, size) != 0) {
+    LOGW("Invalid sweep store '%s'", filename);
+    unmap_file(map, size);
+    return -2;
+  }
+
+  layout(w.cap, w.xn, w.rn, off);
+  *values = (double *)malloc((w.count + 1) * sizeof(double));
+  *its = (int *)malloc((w.count + 1) * sizeof(int));
+  for (uint64_t i = 0; i < w.count; ++i) {
+    const uint8_t *entry = map + off[4] + i * SWEEP_ENTRY_SZ;
+    (*values)[i] = get_f64(entry);
+    (*its)[i] = (int)get_u32(entry + 16);
+  }
+  unmap_file(map, size);
+
+  return (int)w.count;
+}
+
+/** @brief Read sweep variable
+ * @details Reads the parameter values and the stored data of a variable of
+ * the committed points of a store file.
+ * @param path Store path relative to the output directory and without
+ * extension
+ * @param var Variable name (e.g. `qpol`)
+ * @param values Output parameter values (freed by the caller)
+ * @param data Output variable data of dimensions [point x stored wealth x
+ * stored radius] (freed by the caller)
+ * @param ls Output number of stored elements per point
+ * @return The number of points, or a negative value if the store cannot be
+ * read */
+int sweep_read(const char *path, const char *var, double **values,
+               double **data, int *ls) {
+  char filename[2 * RAD_PATH_BUFFER_SZ];
+  uint64_t off[NARRAYS];
+  sweep_t w;
+  size_t size;
+  int v = 0;
+
+  while (v < SWEEP_NVARS && strcmp(vnames[v], var)) {
+    ++v;
+  }
+  if (v == SWEEP_NVARS) {
+    LOGE("Unknown sweep variable '%s'", var);
+    return -3;
+  }
+  snprintf(filename, sizeof(filename),
+           "%s" CCM_FILE_SYSTEM_SEP "%s" RAD_SWEEP_EXT, rad_temp_dir(), path);
+  uint8_t *map = (uint8_t *)map_file(filename, &size);
+  if (!map) {
+    return -1;
+  }
+  memset(&w, 0, sizeof(w));
+  if (read_header(&w, map, size) != 0) {
+    LOGW("Invalid sweep store '%s'", filename);
+    unmap_file(map, size);
+    return -2;
+  }
+
+  layout(w.cap, w.xn, w.rn, off);
+  *ls = w.xn * w.rn;
+  *values = (double *)malloc((w.count + 1) * sizeof(double));
+  *data = (double *)malloc((w.count * *ls + 1) * sizeof(double));
+  for (uint64_t i = 0; i < w.count; ++i) {
+    (*values)[i] = get_f64(map + off[4] + i * SWEEP_ENTRY_SZ);
+  }
+  for (uint64_t i = 0; i < w.count * *ls; ++i) {
+    (*data)[i] = get_f64(map + off[5 + v] + i * sizeof(double));
+  }
+  unmap_file(map, size);
+
+  return (int)w.count;
+}
+
+/** @brief Free sweep store
+ * @details Closes the store file. The committed points remain stored.
+ * @param w Sweep store */
+void sweep_free(sweep_t *w) {
+  if (w->fh) {
+    fclose(w->fh);
+  }
+  free(w->xi);
+  free(w->ri);
+  free(w->xv);
+  free(w->rv);
+  memset(w, 0, sizeof(*w));
+}
@@ -0,0 +1,232 @@
+#if defined(__unix__) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif /* __unix__ */
+
+#include "rad_threads.h"
+
+#include "stdlib.h"
+#include "time.h"
+
+#if defined(RAD_THREADS_OPENMP) && defined(__unix__)
+#include "sched.h"
+#endif /* RAD_THREADS_OPENMP && __unix__ */
+
+#if defined(RAD_THREADS_C11)
+
+int rad_thrd_create(rad_thrd_t *thr, rad_thrd_start_t func, void *arg) {
+  return thrd_create(thr, func, arg) != thrd_success;
+}
+
+int rad_thrd_join(rad_thrd_t thr) { return thrd_join(thr, NULL); }
+
+int rad_mtx_init(rad_mtx_t *mtx) { return mtx_init(mtx, mtx_plain); }
+
+void rad_mtx_destroy(rad_mtx_t *mtx) { mtx_destroy(mtx); }
+
+int rad_mtx_lock(rad_mtx_t *mtx) { return mtx_lock(mtx); }
+
+int rad_mtx_unlock(rad_mtx_t *mtx) { return mtx_unlock(mtx); }
+
+int rad_cnd_init(rad_cnd_t *cnd) { return cnd_init(cnd); }
+
+void rad_cnd_destroy(rad_cnd_t *cnd) { cnd_destroy(cnd); }
+
+int rad_cnd_wait(rad_cnd_t *cnd, rad_mtx_t *mtx) { return cnd_wait(cnd, mtx); }
+
+int rad_cnd_signal(rad_cnd_t *cnd) { return cnd_signal(cnd); }
+
+int rad_cnd_broadcast(rad_cnd_t *cnd) { return cnd_broadcast(cnd); }
+
+double rad_wall_time() {
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+#elif defined(RAD_THREADS_POSIX)
+
+struct start_st {
+  rad_thrd_start_t func;
+  void *arg;
+};
+
+static void *start_thread(void *vst) {
+  struct start_st st = *(struct start_st *)vst;
+  free(vst);
+  st.func(st.arg);
+  return NULL;
+}
+
+int rad_thrd_create(rad_thrd_t *thr, rad_thrd_start_t func, void *arg) {
+  // The start data are freed by the started thread
+  struct start_st *st = (struct start_st *)malloc(sizeof(struct start_st));
+  st->func = func;
+  st->arg = arg;
+  int ec = pthread_create(thr, NULL, start_thread, st);
+  if (ec != 0) {
+    free(st);
+  }
+  return ec;
+}
+
+int rad_thrd_join(rad_thrd_t thr) { return pthread_join(thr, NULL); }
+
+int rad_mtx_init(rad_mtx_t *mtx) { return pthread_mutex_init(mtx, NULL); }
+
+void rad_mtx_destroy(rad_mtx_t *mtx) { pthread_mutex_destroy(mtx); }
+
+int rad_mtx_lock(rad_mtx_t *mtx) { return pthread_mutex_lock(mtx); }
+
+int rad_mtx_unlock(rad_mtx_t *mtx) { return pthread_mutex_unlock(mtx); }
+
+int rad_cnd_init(rad_cnd_t *cnd) { return pthread_cond_init(cnd, NULL); }
+
+void rad_cnd_destroy(rad_cnd_t *cnd) { pthread_cond_destroy(cnd); }
+
+int rad_cnd_wait(rad_cnd_t *cnd, rad_mtx_t *mtx) {
+  return pthread_cond_wait(cnd, mtx);
+}
+
+int rad_cnd_signal(rad_cnd_t *cnd) { return pthread_cond_signal(cnd); }
+
+int rad_cnd_broadcast(rad_cnd_t *cnd) { return pthread_cond_broadcast(cnd); }
+
+double rad_wall_time() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+#elif defined(RAD_THREADS_OPENMP)
+
+int rad_thrd_create(rad_thrd_t *thr, rad_thrd_start_t func, void *arg) {
+  // Single threads cannot be created (see rad_thrd_team())
+  (void)thr, (void)func, (void)arg;
+  return -1;
+}
+
+int rad_thrd_join(rad_thrd_t thr) {
+  (void)thr;
+  return -1;
+}
+
+/** @brief Run thread team
+ * @details Runs the worker function on n - 1 threads and the master function
+ * on the calling thread. The i-th worker is passed the i-th argument and the
+ * master the last one. The function returns after all team members return.
+ * The members must be able to synchronize with each other, thus the team is
+ * not started if OpenMP cannot provide n threads.
+ * @param n Team size
+ * @param worker Worker start function
+ * @param master Master start function
+ * @param args Start function arguments (n elements)
+ * @return Zero on success, non-zero otherwise */
+int rad_thrd_team(int n, rad_thrd_start_t worker, rad_thrd_start_t master,
+                  void **args) {
+  int ec = 0;
+  omp_set_dynamic(0);
+#pragma omp parallel num_threads(n)
+  {
+    int id = omp_get_thread_num();
+    if (omp_get_num_threads() != n) {
+#pragma omp single
+      ec = -1;
+    } else if (id == 0) {
+      master(args[n - 1]);
+    } else {
+      worker(args[id - 1]);
+    }
+  }
+  return ec;
+}
+
+int rad_mtx_init(rad_mtx_t *mtx) {
+  omp_init_lock(mtx);
+  return 0;
+}
+
+void rad_mtx_destroy(rad_mtx_t *mtx) { omp_destroy_lock(mtx); }
+
+int rad_mtx_lock(rad_mtx_t *mtx) {
+  omp_set_lock(mtx);
+  return 0;
+}
+
+int rad_mtx_unlock(rad_mtx_t *mtx) {
+  omp_unset_lock(mtx);
+  return 0;
+}
+
+int rad_cnd_init(rad_cnd_t *cnd) {
+  atomic_init(&cnd->gen, 0);
+  return 0;
+}
+
+void rad_cnd_destroy(rad_cnd_t *cnd) { (void)cnd; }
+
+int rad_cnd_wait(rad_cnd_t *cnd, rad_mtx_t *mtx) {
+  // The generation is read with the mutex held, thus signals sent by threads
+  // that take the mutex are not lost. Wake-ups can be spurious.
+  unsigned gen = atomic_load(&cnd->gen);
+  omp_unset_lock(mtx);
+  while (atomic_load(&cnd->gen) == gen) {
+#if defined(__unix__)
+    sched_yield();
+#endif /* __unix__ */
+  }
+  omp_set_lock(mtx);
+  return 0;
+}
+
+int rad_cnd_signal(rad_cnd_t *cnd) {
+  atomic_fetch_add(&cnd->gen, 1);
+  return 0;
+}
+
+int rad_cnd_broadcast(rad_cnd_t *cnd) {
+  atomic_fetch_add(&cnd->gen, 1);
+  return 0;
+}
+
+double rad_wall_time() { return omp_get_wtime(); }
+
+#else
+
+int rad_thrd_create(rad_thrd_t *thr, rad_thrd_start_t func, void *arg) {
+  (void)thr, (void)func, (void)arg;
+  return -1;
+}
+
+int rad_thrd_join(rad_thrd_t thr) {
+  (void)thr;
+  return -1;
+}
+
+int rad_mtx_init(rad_mtx_t *mtx) { return *mtx = 0; }
+
+void rad_mtx_destroy(rad_mtx_t *mtx) { (void)mtx; }
+
+int rad_mtx_lock(rad_mtx_t *mtx) { return *mtx = 0; }
+
+int rad_mtx_unlock(rad_mtx_t *mtx) { return *mtx = 0; }
+
+int rad_cnd_init(rad_cnd_t *cnd) { return *cnd = 0; }
+
+void rad_cnd_destroy(rad_cnd_t *cnd) { (void)cnd; }
+
+int rad_cnd_wait(rad_cnd_t *cnd, rad_mtx_t *mtx) {
+  (void)cnd, (void)mtx;
+  return -1;
+}
+
+int rad_cnd_signal(rad_cnd_t *cnd) { return *cnd = 0; }
+
+int rad_cnd_broadcast(rad_cnd_t *cnd) { return *cnd = 0; }
+
+double rad_wall_time() {
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+#endif /* RAD_THREADS_C11, RAD_THREADS_POSIX, RAD_THREADS_OPENMP */
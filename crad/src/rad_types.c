@@ -3,63 +3,19 @@
 
 #include "grid_t.h"
 #include "pmap_t.h"
+#include "rad_ctx.h"
 
 #include "cross_comp.h"
 
-#include "errno.h"
 #include "limits.h"
+#include "stdint.h"
 #include "stdio.h"
 #include "stdlib.h"
 #include "string.h"
-#include "time.h"
-
-#if defined(__unix__) || defined(__APPLE__)
-#include "sys/stat.h"
-#include "unistd.h"
-#if __APPLE__
-#define HOST_NAME_MAX 64
-#define LOGIN_NAME_MAX 256
-#endif /* __APPLE__ */
-#else
-#include "winsock2.h"
-#endif /* __unix__ || __APPLE__ */
 
 #define LM_LEVEL 3
 #include "logger.h"
 
-#if RAD_SAFE_MODE
-
-#define rad_fopen(fh, filename, modes, errno)                                  \
-  fh = fopen(filename, modes);                                                 \
-  if (!fh) {                                                                   \
-    LOGE("Failed to open '%s' with errno %d", filename, errno);                \
-    return;                                                                    \
-  }
-
-#define rad_fread(ptr, size, n, stream, filename, errno)                       \
-  if (fread(ptr, size, n, stream) != n) {                                      \
-    LOGE("Failed to read data from file '%s' with errno %d", filename, errno); \
-    return;                                                                    \
-  }
-
-#define rad_fwrite(ptr, size, n, stream, filename, errno)                      \
-  if (fwrite(ptr, size, n, stream) != n) {                                     \
-    LOGE("Failed to write data to file '%s' with errno %d", filename, errno);  \
-    return;                                                                    \
-  }
-
-#else
-
-#define rad_fopen(fh, filename, modes, errno) fh = fopen(filename, modes);
-
-#define rad_fread(ptr, size, n, stream, filename, errno)                       \
-  fread(ptr, size, n, stream)
-
-#define rad_fwrite(ptr, size, n, stream, filename, errno)                      \
-  fwrite(ptr, size, n, stream)
-
-#endif /* RAD_SAFE_MODE */
-
 void set_model_callbacks(model_t *m, const objpart_t *objparts) {
   m->util = objparts[0];
   m->cost = objparts[1];
@@ -67,6 +23,16 @@ void set_model_callbacks(model_t *m, const objpart_t *objparts) {
   m->wltt = objparts[3];
 }
 
+/** Count conversion
+ * @details Converts a count that can be given in floating point notation
+ * (e.g. `1e+10`), clamping it to the range of int.
+ * @param str String
+ * @return The count */
+int atoc(const char *str) {
+  double val = atof(str);
+  return val >= INT_MAX ? INT_MAX : val <= INT_MIN ? INT_MIN : (int)val;
+}
+
 #define ifvar(st, v, c, fmt)                                                   \
   else if (!strcmp(pmap_gkey(pmap, i), #v)) {                                  \
     st->v = c(pmap_gvalue(pmap, i));                                           \
@@ -109,11 +75,65 @@ void model_init(model_t *m, const struct pmap_st *pmap,
   set_model_callbacks(m, objparts);
 }
 
+#define NUM_VARIABLES 4
+
+size_t variable_stride(const sol_t *s) {
+  // Each variable is padded to whole cache lines
+  size_t line = RAD_CACHE_LINE_SZ / sizeof(double);
+  return ((size_t)s->xg->n * s->rg->n + line - 1) / line * line;
+}
+
+void assign_variables(sol_t *s) {
+  double **rows = (double **)s->mem;
+  // The data start on a cache line boundary
+  uintptr_t addr = (uintptr_t)(rows + NUM_VARIABLES * s->xg->n);
+  double *data = (double *)((addr + RAD_CACHE_LINE_SZ - 1) &
+                            ~(uintptr_t)(RAD_CACHE_LINE_SZ - 1));
+  size_t vsz = variable_stride(s);
+
+  s->v0 = rows;
+  s->v1 = rows + s->xg->n;
+  s->qpol = rows + 2 * s->xg->n;
+  s->spol = rows + 3 * s->xg->n;
+
+  for (int i = 0; i < s->xg->n; ++i) {
+    s->v0[i] = data + (size_t)i * s->rg->n;
+    s->v1[i] = data + vsz + (size_t)i * s->rg->n;
+    s->qpol[i] = data + 2 * vsz + (size_t)i * s->rg->n;
+    s->spol[i] = data + 3 * vsz + (size_t)i * s->rg->n;
+  }
+}
+
+size_t variables_size(const sol_t *s) {
+  return NUM_VARIABLES * (sizeof(double *) * s->xg->n +
+                          sizeof(double) * variable_stride(s)) +
+         RAD_CACHE_LINE_SZ;
+}
+
+void alloc_variables(sol_t *s) {
+  // One block holds the row pointers and the data of all the variables. The
+  // rows of each variable are contiguous. The data are not initialized here,
+  // but by the workers that use them (see first_touch() in rad_setup.c).
+  s->mem = rad_alloc(variables_size(s));
+  assign_variables(s);
+}
+
+void reset_variables(sol_t *s) { assign_variables(s); }
+
+void unmap_variables(sol_t *s) {
+  if (s->map) {
+    unmap_file(s->map, s->map_sz);
+    s->map = NULL;
+    s->map_sz = 0;
+  }
+}
+
 /** @brief Initialize solution structure
  * @details The function is responsible for assigning the passed values of the
  * parameter map to solution parameters. It constructs the state and control
  * grids. It also allocates memory to hold the value function and policy
- * approximations.
+ * approximations. The approximations are allocated in a single memory arena
+ * that is reused by solution_reset().
  * @param s An uninitialized solution structure
  * @param pmap A parameter map with initialization values
  * @see model_init(), solution_free() */
@@ -123,22 +143,14 @@ void solution_init(sol_t *s, const struct pmap_st *pmap) {
   for (int i = 0; i < pmap->n; ++i) {
     if (0) {
     }
-    ifvar(s, maxit, atoi, f) ifvar(s, tol, atof, f) ifvar(s, qadp, atoi, f)
+    ifvar(s, maxit, atoc, d) ifvar(s, tol, atof, f) ifvar(s, qadp, atoi, f)
         ifvar(s, sadp, atof, f) ifgrid(s, xg) ifgrid(s, rg) ifgrid(s, qg)
             ifgrid(s, sg)
   }
 
-  s->v0 = (double **)malloc(sizeof(double *) * (s->xg->n));
-  s->v1 = (double **)malloc(sizeof(double *) * (s->xg->n));
-  s->qpol = (double **)malloc(sizeof(double *) * (s->xg->n));
-  s->spol = (double **)malloc(sizeof(double *) * (s->xg->n));
-
-  for (int i = 0; i < s->xg->n; ++i) {
-    s->v0[i] = (double *)calloc(s->rg->n, sizeof(double));
-    s->v1[i] = (double *)calloc(s->rg->n, sizeof(double));
-    s->qpol[i] = (double *)calloc(s->rg->n, sizeof(double));
-    s->spol[i] = (double *)calloc(s->rg->n, sizeof(double));
-  }
+  s->map = NULL;
+  s->map_sz = 0;
+  alloc_variables(s);
 
   s->acc = s->tol + 1;
   s->it = 0;
@@ -146,314 +158,121 @@ void solution_init(sol_t *s, const struct pmap_st *pmap) {
   s->xend = 0;
 }
 
-#undef ifvar
-#undef ifgrid
+#define ifgridr(st, v)                                                         \
+  else if (!strcmp(pmap_gkey(pmap, i), #v)) {                                  \
+    pmap_cvalue(&buf, pmap, i);                                                \
+    grid_reset_str(st->v, buf);                                                \
+    LOGD("Resetting " #v " = %d,%f,%f,%f (from %s)", st->v->n, st->v->m,       \
+         st->v->M, st->v->w, pmap->p->key);                                    \
+    free(buf);                                                                 \
+  }
 
-void save_head(const char *filename) {
-  FILE *fh = NULL;
-  rad_fopen(fh, filename, "w", errno);
-
-#if defined(__unix__) || defined(__APPLE__)
-  char hostname[HOST_NAME_MAX];
-  char username[LOGIN_NAME_MAX];
-  gethostname(hostname, HOST_NAME_MAX);
-  getlogin_r(username, LOGIN_NAME_MAX);
-#else
-#define INFO_BUFFER_SIZE 32767
-  DWORD bufCharCount = INFO_BUFFER_SIZE;
-  TCHAR hostname[INFO_BUFFER_SIZE];
-  TCHAR username[INFO_BUFFER_SIZE];
-
-  GetComputerName(hostname, &bufCharCount);
-  GetUserName(username, &bufCharCount);
-#undef INFO_BUFFER_SIZE
-#endif
-
-  time_t rawtime;
-  struct tm timeinfo;
-  time(&rawtime);
-  localtime_r(&rawtime, &timeinfo);
-#define ASCTIME_BUFFER_SIZE 26
-  char timestamp[ASCTIME_BUFFER_SIZE];
-  asctime_r(&timeinfo, timestamp);
-#undef ASCTIME_BUFFER_SIZE
-
-  fprintf(fh, "%-10s:%s", "Created", timestamp);
-  fprintf(fh, "%-10s:%s\n", "Host", hostname);
-  fprintf(fh, "%-10s:%s\n", "User", username);
-
-  fclose(fh);
-}
+/** @brief Reset solution structure
+ * @details Re-initializes a solution structure that was created by
+ * solution_init() or rad_file_load() using the values of the passed parameter
+ * map. Grids and approximation variables are recalculated in place. Memory is
+ * re-allocated only if the shapes of the grids change. The function is
+ * intended for repeated solves of models with the same grid specifications.
+ * @param s An initialized solution structure
+ * @param pmap A parameter map with initialization values
+ * @see solution_init() */
+void solution_reset(sol_t *s, const struct pmap_st *pmap) {
+  char *buf;
+  short xn = s->xg->n, rn = s->rg->n;
 
-void mkmodel_dir(const char *model_path) {
-  char path_buffer[RAD_PATH_BUFFER_SZ];
-  char filename[2 * RAD_PATH_BUFFER_SZ];
-
-  snprintf(path_buffer, RAD_PATH_BUFFER_SZ, "%s" CCM_FILE_SYSTEM_SEP "%s",
-           RAD_TEMP_DIR, model_path);
-  int status =
-      mkdirp(path_buffer, S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH);
-  if (!status) {
-    snprintf(filename, sizeof(filename), "%s" CCM_FILE_SYSTEM_SEP "head",
-             path_buffer);
-    save_head(filename);
-  } else if (status < 0) {
-    if (errno != EEXIST) {
-      LOGE("Failed to create directory '%s' with errno %d", path_buffer, errno);
+  for (int i = 0; i < pmap->n; ++i) {
+    if (0) {
     }
+    ifvar(s, maxit, atoc, d) ifvar(s, tol, atof, f) ifvar(s, qadp, atoi, f)
+        ifvar(s, sadp, atof, f) ifgridr(s, xg) ifgridr(s, rg) ifgridr(s, qg)
+            ifgridr(s, sg)
   }
-}
 
-/** @brief Load model
- * @details Performs a binary loads of the model's parameters. The parameters
- * are stored to the passed model object. They are read from the passed model
- * path. The function expects that a binary model file name `model´ exists in
- * the passed directory. The model functional specification is load by the the
- * passed objective parts objects and uses the same rules as the model_init()
- * function.
- * @param m Model object were the loaded data are stored
- * @param model_path The path that contains binary saved data
- * @param objparts The model's functional specification
- * @see objpart_t, model_init() */
-void model_load(model_t *m, const char *model_path, const objpart_t *objparts) {
-  char filename[RAD_PATH_BUFFER_SZ];
-  snprintf(filename, RAD_PATH_BUFFER_SZ,
-           "%s" CCM_FILE_SYSTEM_SEP "%s" CCM_FILE_SYSTEM_SEP "model",
-           RAD_TEMP_DIR, model_path);
-  FILE *fh = NULL;
-  rad_fopen(fh, filename, "rb", errno);
-  rad_fread(m, sizeof(*m), 1, fh, filename, errno);
-  fclose(fh);
-
-  set_model_callbacks(m, objparts);
-}
+  // The variables are recalculated in the memory arena
+  unmap_variables(s);
+  if (xn != s->xg->n || rn != s->rg->n) {
+    LOGD("Reallocating solution variables (%d,%d)", s->xg->n, s->rg->n);
+    rad_free(s->mem);
+    alloc_variables(s);
+  } else {
+    reset_variables(s);
+  }
 
-/** @brief Save model
- * @details Performs a binary save of the model to he file system. The resulting
- * resulting binary files are intended to be used  by model_load() to replicated
- * the saved data. The function creates the model directory if it does not
- * exist. Then it saves
- *  - a binary dump file of the object and
- *  - a text file with the model's functional specification.
- * @param m Model object to be saved
- * @param model_path Save path
- * @see solution_load() */
-void model_save(const model_t *m, const char *model_path) {
-  mkmodel_dir(model_path);
-
-  char filename[RAD_PATH_BUFFER_SZ];
-
-  snprintf(filename, RAD_PATH_BUFFER_SZ,
-           "%s" CCM_FILE_SYSTEM_SEP "%s" CCM_FILE_SYSTEM_SEP "model",
-           RAD_TEMP_DIR, model_path);
-  FILE *fh = NULL;
-  rad_fopen(fh, filename, "wb", errno);
-  rad_fwrite(m, sizeof(*m), 1, fh, filename, errno);
-  fclose(fh);
-
-  pmap_t pmap = {.p = NULL, .n = 0};
-  pmap_add(&pmap, "util", m->util.str);
-  pmap_add(&pmap, "cost", m->cost.str);
-  pmap_add(&pmap, "radt", m->radt.str);
-  pmap_add(&pmap, "wltt", m->wltt.str);
-  snprintf(filename, RAD_PATH_BUFFER_SZ,
-           "%s" CCM_FILE_SYSTEM_SEP "%s" CCM_FILE_SYSTEM_SEP "fncs",
-           RAD_TEMP_DIR, model_path);
-  pmap_save(&pmap, filename);
+  s->acc = s->tol + 1;
+  s->it = 0;
+  s->xbeg = 0;
+  s->xend = 0;
 }
 
-void load_variable2(double ***var, const char *filename) {
-  FILE *fh = NULL;
-  short d1, d2;
-
-  rad_fopen(fh, filename, "rb", errno);
-  rad_fread(&d1, sizeof(short), 1, fh, filename, errno);
-  rad_fread(&d2, sizeof(short), 1, fh, filename, errno);
-
-  *var = (double **)malloc(sizeof(double *) * d1);
-  for (int i1 = 0; i1 < d1; ++i1) {
-    (*var)[i1] = (double *)malloc(sizeof(double) * d2);
-    rad_fread((*var)[i1], sizeof(double), d2, fh, filename, errno);
-  }
-
-  fclose(fh);
+#undef ifgridr
+#undef ifvar
+#undef ifgrid
 
-#ifdef RAD_DEBUG
-  double varm = (*var)[0][0], varM = (*var)[0][0];
-  for (int xi = 0; xi < d1; ++xi) {
-    for (int ri = 0; ri < d2; ++ri) {
-      if (varm > (*var)[xi][ri])
-        varm = (*var)[xi][ri];
-      if (varM < (*var)[xi][ri])
-        varM = (*var)[xi][ri];
-    }
+void copy_grid(grid_t **dest, const grid_t *source) {
+  if (!*dest) {
+    *dest = (grid_t *)malloc(sizeof(grid_t));
+    grid_copy(*dest, source);
+  } else if ((*dest)->n != source->n) {
+    grid_free(*dest);
+    grid_copy(*dest, source);
+  } else {
+    double *d = (*dest)->d;
+    memcpy(*dest, source, sizeof(*source));
+    (*dest)->d = d;
+    memcpy(d, source->d, source->n * sizeof(double));
   }
-  LOGD("Variable range is [%f,%f]", varm, varM);
-#endif
 }
 
-void save_variable2(short d1, short d2, double **const var,
-                    const char *filename) {
-  FILE *fh = NULL;
-  rad_fopen(fh, filename, "wb", errno);
-  rad_fwrite(&d1, sizeof(d1), 1, fh, filename, errno);
-  rad_fwrite(&d2, sizeof(d2), 1, fh, filename, errno);
-  for (int i1 = 0; i1 < d1; ++i1) {
-    rad_fwrite(var[i1], sizeof(double), d2, fh, filename, errno);
+/** @brief Copy solution
+ * @details Performs a deep copy of one solution to another. The destination is
+ * either zero-initialized or a previous copy. The grids and the approximation
+ * variables of a previous copy are reused when their shapes match, so that
+ * repeated copies (e.g. checkpoint snapshots) allocate only once. The copy is
+ * freed using solution_free().
+ * @param dest Destination solution
+ * @param source Source solution */
+void solution_copy(sol_t *dest, const sol_t *source) {
+  sol_t prev = *dest;
+  *dest = *source;
+  // The copy's variables are always stored in its own memory arena
+  dest->map = NULL;
+  dest->map_sz = 0;
+  dest->xg = prev.xg;
+  dest->rg = prev.rg;
+  dest->qg = prev.qg;
+  dest->sg = prev.sg;
+  copy_grid(&dest->xg, source->xg);
+  copy_grid(&dest->rg, source->rg);
+  copy_grid(&dest->qg, source->qg);
+  copy_grid(&dest->sg, source->sg);
+
+  if (prev.mem && prev.xg->n == source->xg->n &&
+      prev.rg->n == source->rg->n) {
+    dest->mem = prev.mem;
+    reset_variables(dest);
+  } else {
+    rad_free(prev.mem);
+    alloc_variables(dest);
   }
 
-  fclose(fh);
-}
-
-/** @brief Load solution
- * @details Loads binary saved solution data from the file system. The resulting
- * solution structure creates a binary equivalent data object with the one that
- * called the solution_save() function. The function expect to find
- *  - a global solution binary file,
- *  - four grid binary files (wealth, radius, quantity and effort) and
- *  - two optimal control binary files and two (current and next date's) value
- * function binary files in the passed directory.
- * @param s Solution structure to be populated
- * @param model_path Base file system directory containing saved execution data
- * @see solution_free() */
-void solution_load(sol_t *s, const char *model_path) {
-  char filename[RAD_PATH_BUFFER_SZ];
-
-  snprintf(filename, RAD_PATH_BUFFER_SZ,
-           "%s" CCM_FILE_SYSTEM_SEP "%s" CCM_FILE_SYSTEM_SEP "solution",
-           RAD_TEMP_DIR, model_path);
-  FILE *fh = NULL;
-  rad_fopen(fh, filename, "rb", errno);
-  rad_fread(s, sizeof(*s), 1, fh, filename, errno);
-
-  fclose(fh);
-
-#define loadg(gname)                                                           \
-  s->gname = (grid_t *)malloc(sizeof(grid_t));                                 \
-  snprintf(filename, RAD_PATH_BUFFER_SZ,                                       \
-           "%s" CCM_FILE_SYSTEM_SEP "%s" CCM_FILE_SYSTEM_SEP #gname,           \
-           RAD_TEMP_DIR, model_path);                                          \
-  grid_load(s->gname, filename);
-
-  loadg(xg);
-  loadg(rg);
-  loadg(qg);
-  loadg(sg);
-
-#undef loadg
-
-#define loadv(vname)                                                           \
-  snprintf(filename, RAD_PATH_BUFFER_SZ,                                       \
-           "%s" CCM_FILE_SYSTEM_SEP "%s" CCM_FILE_SYSTEM_SEP #vname,           \
-           RAD_TEMP_DIR, model_path);                                          \
-  load_variable2(&s->vname, filename);
-
-  loadv(qpol);
-  loadv(spol);
-  loadv(v0);
-  loadv(v1);
-
-#undef loadv
-}
-
-void debug_check_save(const sol_t *s, const char *model_path,
-                      double **const svar, const char *varname) {
-  char filename[RAD_PATH_BUFFER_SZ];
-  double **var;
-
-  snprintf(filename, RAD_PATH_BUFFER_SZ,
-           "%s" CCM_FILE_SYSTEM_SEP "%s" CCM_FILE_SYSTEM_SEP "%s", RAD_TEMP_DIR,
-           model_path, varname);
-  load_variable2(&var, filename);
-  for (int xi = 0; xi < s->xg->n; ++xi) {
-    for (int ri = 0; ri < s->rg->n; ++ri) {
-      if (svar[xi][ri] != var[xi][ri]) {
-        LOGW("Inaccurate save for variable %s at (%d,%d)", varname, xi, ri);
-      }
-    }
-    free(var[xi]);
+  // The value function rows are swapped every iteration, thus the variables
+  // are copied row by row
+  size_t sz = source->rg->n * sizeof(double);
+  for (int i = 0; i < source->xg->n; ++i) {
+    memcpy(dest->v0[i], source->v0[i], sz);
+    memcpy(dest->v1[i], source->v1[i], sz);
+    memcpy(dest->qpol[i], source->qpol[i], sz);
+    memcpy(dest->spol[i], source->spol[i], sz);
   }
-  free(var);
-}
-
-/** @brief Save solution
- * @details Saves the given solution structure in binary format to the file
- * system. The created binary files are intended to be used by solution_load()
- * to create a binary replica of the saved object. The function creates
- *  - a text file with the model's function specifications (see rad_specs.h)
- *  - a head file with creation information in key-value pairs
- *  - a global solution binary dump file of the solution structure,
- *  - four grid binary dump files (wealth, radius, quantity and effort) and
- *  - two optimal control and two (current and next date's) value function
- * binary dump files in the passed directory.
- * @param s Solution structure to be saved
- * @param model_path Base file system save directory */
-void solution_save(const sol_t *s, const char *model_path) {
-  char filename[RAD_PATH_BUFFER_SZ];
-
-#define saveg(gname)                                                           \
-  snprintf(filename, RAD_PATH_BUFFER_SZ,                                       \
-           "%s" CCM_FILE_SYSTEM_SEP "%s" CCM_FILE_SYSTEM_SEP #gname,           \
-           RAD_TEMP_DIR, model_path);                                          \
-  grid_save(s->gname, filename);
-
-  saveg(xg);
-  saveg(rg);
-  saveg(qg);
-  saveg(sg);
-
-#undef saveg
-
-#define savev(vname)                                                           \
-  snprintf(filename, RAD_PATH_BUFFER_SZ,                                       \
-           "%s" CCM_FILE_SYSTEM_SEP "%s" CCM_FILE_SYSTEM_SEP #vname,           \
-           RAD_TEMP_DIR, model_path);                                          \
-  save_variable2(s->xg->n, s->rg->n, s->vname, filename);
-
-  savev(qpol);
-  savev(spol);
-  savev(v0);
-  savev(v1);
-
-#undef savev
-
-#ifdef RAD_DEBUG
-
-#define checkv(vname) debug_check_save(s, model_path, s->vname, #vname);
-
-  checkv(qpol);
-  checkv(spol);
-  checkv(v0);
-  checkv(v1);
-
-#undef checkv
-
-#endif
-
-  snprintf(filename, RAD_PATH_BUFFER_SZ,
-           "%s" CCM_FILE_SYSTEM_SEP "%s" CCM_FILE_SYSTEM_SEP "solution",
-           RAD_TEMP_DIR, model_path);
-  FILE *fh = NULL;
-  rad_fopen(fh, filename, "wb", errno);
-  rad_fwrite(s, sizeof(*s), 1, fh, filename, errno);
-  fclose(fh);
 }
 
 /** @brief Free solution
  * @details Disallocates a solution object. Object created using solution_init()
- * and solution_load() are expected to be finalized using this function.
+ * and rad_file_load() are expected to be finalized using this function.
  * @param s Solution structure to be destroyed. */
 void solution_free(sol_t *s) {
-  for (int i = 0; i < s->xg->n; ++i) {
-    free(s->v0[i]);
-    free(s->v1[i]);
-    free(s->qpol[i]);
-    free(s->spol[i]);
-  }
-  free(s->v0);
-  free(s->v1);
-  free(s->qpol);
-  free(s->spol);
+  unmap_variables(s);
+  rad_free(s->mem);
 
   grid_free(s->xg);
   grid_free(s->rg);
@@ -1,18 +1,20 @@
 """@package rad
 Python radial attention model classes.
 
-The file contains three basic classes; namely a grid, a variable and a model
-class. These classes provide are used as a bridge between the c applications
-and the Python Jupyter notebook. The c applications solve the radial attention
-model, generate solution approximation data and store them in the file system.
+The file contains seven basic classes; namely a save file, a live stream, a
+sweep store, a sweep manifest, a grid, a variable and a model class. These
+classes provide are used as a bridge between the c applications and the Python
+Jupyter notebook. The c applications solve the radial attention model, generate
+solution approximation data and store them in the file system.
 These classes load the data and provide an interface for them to be used in a
 Python Jupyter notebook. The notebook functionality creates the tables and the
 figures that are used in the article.
 """
 
-import glob
 import os.path
 import struct
+import zlib
+from multiprocessing import resource_tracker, shared_memory
 from string import Template
 
 import matplotlib.pyplot as plt
@@ -24,13 +26,418 @@ from mpl_toolkits.mplot3d import Axes3D
 from scipy.ndimage.filters import gaussian_filter1d
 
 
+class SaveFile:
+    """Save file class.
+
+    Reads a solution container file created by the c applications. The format
+    of the file is specified in the documentation of rad_file.h. Only the
+    header, the section table and the meta data are read when the object is
+    created. The sections are exposed as read-only numpy memory maps, so that
+    their data are read when they are accessed. Encoded sections (compressed
+    periodic saves, see rad_codec.h) are decoded by the c applications only.
+
+    Attributes:
+        filename (str): The filename of the container file.
+        meta (dict): The meta data as strings.
+        sections (dict): The data type, shape, encoding, offset, size and
+                         checksum of each section.
+    """
+
+    MAGIC = b"RADSAVE\0"
+    VERSION = 2
+    ALIGN = 64
+
+    filename = None
+    meta = None
+    sections = None
+
+    def __init__(self, filename, verify=False):
+        """Constructor.
+
+        Args:
+            filename (str): The filename of the container file.
+
+        Kwargs:
+            verify (bool): Verify the checksums of all the sections (reads the
+                           whole file). The checksums of the section table and
+                           of the meta data are always verified.
+        """
+
+        self.filename = filename
+        with open(filename, "rb") as file_handle:
+            head = file_handle.read(self.ALIGN)
+            if len(head) < self.ALIGN or head[:8] != self.MAGIC:
+                raise RuntimeError("'{}' is not a save file".format(filename))
+            version, nsec, size, table_crc = struct.unpack_from("<IIQI", head, 8)
+            if version > self.VERSION:
+                raise RuntimeError(
+                    "'{}' has unsupported version {}".format(filename, version)
+                )
+            table = file_handle.read(self.ALIGN * nsec)
+        if size != os.path.getsize(filename) or zlib.crc32(table) != table_crc:
+            raise RuntimeError("'{}' is corrupted".format(filename))
+
+        self.sections = {}
+        for i in range(nsec):
+            entry = table[i * self.ALIGN : (i + 1) * self.ALIGN]
+            ndim, encoding, crc, dim0, dim1, offset, length = struct.unpack_from(
+                "<HHIQQQQ", entry, 24
+            )
+            self.sections[entry[:16].rstrip(b"\0").decode()] = {
+                "dtype": entry[16:24].rstrip(b"\0").decode(),
+                "shape": (dim0, dim1)[:ndim],
+                "encoding": encoding,
+                "offset": offset,
+                "size": length,
+                "crc": crc,
+            }
+
+        for name in self.sections if verify else ["meta"]:
+            self.verify(name)
+
+        self.meta = {}
+        for line in self.array("meta").tobytes().decode().splitlines():
+            key, sep, value = line.partition("=")
+            if sep:
+                self.meta[key.strip()] = value.strip()
+
+    def verify(self, name):
+        """Verify a section's checksum.
+
+        Args:
+            name (str): The section name.
+        """
+
+        section = self.sections[name]
+        data = b""
+        if section["size"]:
+            data = np.memmap(
+                self.filename,
+                dtype=np.uint8,
+                mode="r",
+                offset=section["offset"],
+                shape=(section["size"],),
+            )
+        if zlib.crc32(data) != section["crc"]:
+            raise RuntimeError(
+                "Section '{}' of '{}' is corrupted".format(name, self.filename)
+            )
+
+    def array(self, name):
+        """Get a section's data.
+
+        Args:
+            name (str): The section name.
+
+        Returns:
+            A read-only numpy memory map of the section.
+        """
+
+        section = self.sections[name]
+        if section["encoding"]:
+            raise RuntimeError(
+                "Section '{}' of '{}' is encoded".format(name, self.filename)
+            )
+        return np.memmap(
+            self.filename,
+            dtype=np.dtype(section["dtype"]),
+            mode="r",
+            offset=section["offset"],
+            shape=section["shape"],
+        )
+
+
+class LiveStream:
+    """Live stream class.
+
+    Reads the frames that a running solve publishes in a shared memory segment
+    (see the `stream` parameter of the c applications). The format of the
+    segment is specified in the documentation of rad_stream.h. Every frame is
+    copied, so that it stays valid while the solve continues.
+
+    Attributes:
+        name (str): The segment name.
+        xn (int): The wealth grid size.
+        rn (int): The radius grid size.
+    """
+
+    MAGIC = b"RADLIVE\0"
+    VERSION = 1
+    HEAD = 128
+    ALIGN = 64
+    TRIES = 64
+    STATES = ["solving", "converged", "halted", "closed"]
+
+    name = None
+    xn = None
+    rn = None
+
+    def __init__(self, name):
+        """Constructor.
+
+        Args:
+            name (str): The segment name.
+        """
+
+        self.name = name.lstrip("/")
+        self.__shm = shared_memory.SharedMemory(name=self.name)
+        # the segment is owned and removed by the solve
+        resource_tracker.unregister(self.__shm._name, "shared_memory")
+        buf = self.__shm.buf
+        version, self.xn, self.rn = struct.unpack_from("=Iii", buf, 8)
+        if bytes(buf[:8]) != self.MAGIC or version != self.VERSION:
+            self.close()
+            raise RuntimeError("'{}' is not a live stream".format(name))
+        self.__offsets = []
+        offset = self.HEAD
+        for size in [self.xn, self.rn] + 3 * [self.xn * self.rn]:
+            self.__offsets.append(offset)
+            offset += -(-8 * size // self.ALIGN) * self.ALIGN
+        self.__size = offset
+        self.__seq = 0
+
+    def read(self):
+        """Read the next frame.
+
+        Returns:
+            A dictionary with the iteration count (`it`), the state, the
+            accuracy (`acc`), the tolerance (`tol`), the quantity and effort
+            grid bounds (`qM` and `sM`), the wall-clock time, the grids (`xg`
+            and `rg`) and the variables (`v1`, `qpol` and `spol`), or None if
+            there is no new frame.
+        """
+
+        buf = self.__shm.buf
+        for _ in range(self.TRIES):
+            seq = struct.unpack_from("=Q", buf, 24)[0]
+            if seq & 1:
+                continue
+            if seq == self.__seq:
+                return None
+            data = bytes(buf[: self.__size])
+            if struct.unpack_from("=Q", buf, 24)[0] != seq:
+                continue
+            self.__seq = seq
+            it, state, acc, tol, qM, sM, time = struct.unpack_from(
+                "=iiddddd", data, 32
+            )
+            frame = {
+                "it": it,
+                "state": self.STATES[state],
+                "acc": acc,
+                "tol": tol,
+                "qM": qM,
+                "sM": sM,
+                "time": time,
+            }
+            shapes = [self.xn, self.rn] + 3 * [(self.xn, self.rn)]
+            names = ["xg", "rg", "v1", "qpol", "spol"]
+            for name, shape, offset in zip(names, shapes, self.__offsets):
+                frame[name] = np.frombuffer(
+                    data, dtype=np.float64, count=np.prod(shape), offset=offset
+                ).reshape(shape)
+            return frame
+        return None
+
+    def close(self):
+        """Detach from the segment."""
+
+        self.__shm.close()
+
+
+class SweepStore:
+    """Sweep store class.
+
+    Reads a parameter sweep store created by rad_pardep. The format of the file
+    is specified in the documentation of rad_sweep.h. The whole file is mapped
+    once and the variables are exposed as read-only numpy arrays of dimensions
+    [point x wealth x radius] that refer to the mapping. Only the committed
+    points are exposed.
+
+    Attributes:
+        filename (str): The filename of the store.
+        parameter (str): The parameter name.
+        values (ndarray): The parameter values of the points.
+        accuracy (ndarray): The achieved accuracy of the points.
+        iterations (ndarray): The iteration counts of the points.
+        x_indices (ndarray): The stored wealth grid indices.
+        x_values (ndarray): The stored wealth grid values.
+        r_indices (ndarray): The stored radius grid indices.
+        r_values (ndarray): The stored radius grid values.
+        variables (dict): The variable arrays by name.
+    """
+
+    MAGIC = b"RADSWEEP"
+    VERSION = 1
+    ALIGN = 64
+    SLOT = 64
+    NAME = 16
+    ENTRY = np.dtype(
+        [("value", "<f8"), ("acc", "<f8"), ("it", "<i4"), ("crc", "<u4"), ("", "V8")]
+    )
+
+    filename = None
+    parameter = None
+    values = None
+    accuracy = None
+    iterations = None
+    x_indices = None
+    x_values = None
+    r_indices = None
+    r_values = None
+    variables = None
+
+    def __align__(self, offset):
+        return -(-offset // self.ALIGN) * self.ALIGN
+
+    def __init__(self, filename):
+        """Constructor.
+
+        Args:
+            filename (str): The filename of the store.
+        """
+
+        self.filename = filename
+        data = np.memmap(filename, dtype=np.uint8, mode="r")
+        head = None
+        for slot in range(2):
+            raw = data[slot * self.SLOT : (slot + 1) * self.SLOT].tobytes()
+            crc = struct.unpack_from("<I", raw, 56)[0]
+            if raw[:8] != self.MAGIC or zlib.crc32(raw[:56]) != crc:
+                continue
+            fields = struct.unpack_from("<IIQQQIIII", raw, 8)
+            if head is None or fields[2] > head[2]:
+                head = fields
+        if head is None:
+            raise RuntimeError("'{}' is not a sweep store".format(filename))
+        version, nvar, _, cap, count, xn, rn, _, _ = head
+        if version > self.VERSION:
+            raise RuntimeError(
+                "'{}' has unsupported version {}".format(filename, version)
+            )
+
+        names = []
+        for k in range(1 + nvar):
+            offset = 2 * self.SLOT + k * self.NAME
+            name = data[offset : offset + self.NAME].tobytes().rstrip(b"\0")
+            names.append(name.decode())
+        self.parameter = names[0]
+
+        offset = self.__align__(2 * self.SLOT + (1 + nvar) * self.NAME)
+        arrays = []
+        for dtype, size in [("<u4", xn), ("<f8", xn), ("<u4", rn), ("<f8", rn)]:
+            size *= np.dtype(dtype).itemsize
+            arrays.append(data[offset : offset + size].view(dtype))
+            offset = self.__align__(offset + size)
+        self.x_indices, self.x_values, self.r_indices, self.r_values = arrays
+
+        table = data[offset : offset + count * self.ENTRY.itemsize].view(self.ENTRY)
+        offset = self.__align__(offset + cap * self.ENTRY.itemsize)
+        self.values = table["value"]
+        self.accuracy = table["acc"]
+        self.iterations = table["it"]
+        self.__crc = table["crc"]
+
+        self.variables = {}
+        for name in names[1:]:
+            size = count * xn * rn * 8
+            self.variables[name] = (
+                data[offset : offset + size].view("<f8").reshape((count, xn, rn))
+            )
+            offset = self.__align__(offset + cap * xn * rn * 8)
+
+    def verify(self):
+        """Verify the checksums of the points' variable data."""
+
+        for point, crc in enumerate(self.__crc):
+            value = 0
+            for var in self.variables.values():
+                value = zlib.crc32(var[point], value)
+            if value != crc:
+                raise RuntimeError(
+                    "Point {} of '{}' is corrupted".format(point, self.filename)
+                )
+
+
+class SweepManifest:
+    """Sweep manifest class.
+
+    Reads the manifest of a parameter sweep created by rad_pardep (see
+    rad_plan.h). The stored parameter values of a sweep with several
+    dimensions are the indices of its points, whose values are listed by the
+    manifest. The state of a point is the last one of its events. The points
+    that are inserted by the refinement of a sweep follow the events of their
+    preceding points.
+
+    Attributes:
+        filename (str): The filename of the manifest.
+        name (str): The sweep name.
+        design (str): The design of the sweep (e.g. "product").
+        dimensions (list): The swept keys.
+        points (list): The values of the points as lists of strings.
+        status (list): The states of the points ("pending", "start", "halted",
+            "failed" or "done").
+        iterations (list): The iteration counts of the done points.
+        accuracy (list): The achieved accuracy of the done points.
+    """
+
+    filename = None
+    name = None
+    design = None
+    dimensions = None
+    points = None
+    status = None
+    iterations = None
+    accuracy = None
+
+    def __init__(self, filename):
+        """Constructor.
+
+        Args:
+            filename (str): The filename of the manifest.
+        """
+
+        self.filename = filename
+        self.points = []
+        with open(filename, "r") as file:
+            for line in file:
+                if not line.endswith("\n"):
+                    # A torn event of an interrupted sweep
+                    break
+                key, _, value = line.strip().partition(" = ")
+                fields = key.split()
+                if key == "sweep":
+                    self.name = value
+                elif key == "design":
+                    self.design = value
+                elif key == "dims":
+                    self.dimensions = value.split("; ")
+                elif key == "points":
+                    count = int(value)
+                    self.status = ["pending"] * count
+                    self.iterations = [None] * count
+                    self.accuracy = [None] * count
+                elif fields[0] == "point" and value:
+                    self.points.append(value.split("; "))
+                    if len(self.points) > len(self.status):
+                        self.status.append("pending")
+                        self.iterations.append(None)
+                        self.accuracy.append(None)
+                elif fields[0] in ("start", "halted", "failed", "done"):
+                    point = int(fields[1])
+                    self.status[point] = fields[0]
+                    if fields[0] == "done":
+                        self.iterations[point] = int(fields[2])
+                        self.accuracy[point] = float(fields[3])
+
+
 class Grid:
     """Grid wrapper class.
 
-    Loads and holds the binary data created by the c grid_t structure.
+    Holds the data of a c grid_t structure stored in a save file.
 
     Attributes:
-        datafile (str): The filename of the binary grid data file.
+        datafile (str): The name of the grid data (file and section).
         data (ndarray): The grid data.
         weight (double): The grid point weighting.
     """
@@ -39,22 +446,21 @@ class Grid:
     data = None
     weight = None
 
-    def __init__(self, datafile):
+    def __init__(self, save_file=None, name=None, data=None):
         """Constructor.
 
-        Args:
-            datafile (str): The filename of the binary grid data file.
+        Kwargs:
+            save_file (SaveFile): The save file.
+            name (str): The section name of the grid.
+            data (ndarray): Grid data array (without weighting).
         """
 
-        self.datafile = datafile
-        with open(datafile, "rb") as file_handle:
-            byte = file_handle.read(2)
-            self.data = np.zeros(int.from_bytes(byte, byteorder="little"))
-            byte = file_handle.read(8)
-            self.weight = struct.unpack("d", byte)[0]
-            for i in range(0, self.data.size):
-                byte = file_handle.read(8)
-                self.data[i] = struct.unpack("d", byte)[0]
+        if save_file is not None:
+            self.datafile = save_file.filename + ":" + name
+            self.data = save_file.array(name)
+            self.weight = float(save_file.meta[name].split(",")[3])
+        elif data is not None:
+            self.data = data
 
     def __str__(self):
         """String representation of the grid object.
@@ -114,11 +520,11 @@ class Grid:
 class Variable:
     """Variable class.
 
-    Loads and holds the binary data that approximate the optimal controls and
-    the value functions generated by the c applications.
+    Holds the data that approximate the optimal controls and the value functions
+    generated by the c applications. The data are indexed by radius and wealth.
 
     Attributes:
-        datafile (str): The filename of the binary variable data file.
+        datafile (str): The name of the variable data (file and section).
         x_grid (Grid): The wealth grid data.
         r_grid (Grid): The radius grid data.
         data (ndarray): The variable data.
@@ -129,7 +535,7 @@ class Variable:
     r_grid = None
     data = None
 
-    def __init__(self, xgrid, rgrid, datafile=None, zvar=None):
+    def __init__(self, xgrid, rgrid, save_file=None, name=None, zvar=None):
         """Constructor.
 
         Args:
@@ -137,28 +543,19 @@ class Variable:
             rgrid (Grid): The radius grid data.
 
         Kwargs:
-            datafile (str): The filename of the binary variable data file.
+            save_file (SaveFile): The save file.
+            name (str): The section name of the variable.
             zvar (ndarray): Variable data array.
         """
 
         self.x_grid = xgrid
         self.r_grid = rgrid
-        if datafile is not None:
-            self.datafile = datafile
-            with open(datafile, "rb") as file_handle:
-                byte = file_handle.read(2)
-                x_size = int.from_bytes(byte, byteorder="little")
-                if x_size != self.x_grid.data.size:
-                    raise "Invalid 1st dimension size"
-                byte = file_handle.read(2)
-                r_size = int.from_bytes(byte, byteorder="little")
-                if r_size != self.r_grid.data.size:
-                    raise "Invalid 2nd dimension size"
-                self.data = np.zeros((x_size, r_size))
-                for i in range(0, x_size):
-                    for j in range(0, r_size):
-                        byte = file_handle.read(8)
-                        self.data[j, i] = struct.unpack("d", byte)[0]
+        if save_file is not None:
+            self.datafile = save_file.filename + ":" + name
+            data = save_file.array(name)
+            if data.shape != (self.x_grid.data.size, self.r_grid.data.size):
+                raise RuntimeError("Invalid shape of '{}'".format(self.datafile))
+            self.data = data.T
         elif zvar is not None:
             if zvar.shape != (self.x_grid.data.size, self.r_grid.data.size):
                 raise "Invalid shape"
@@ -182,7 +579,7 @@ class Variable:
         data = [surface]
 
         layout = go.Layout(
-            title=self.datafile.split("/")[-1],
+            title=self.datafile.split(":")[-1],
             scene=dict(
                 xaxis=dict(
                     title="x",
@@ -322,13 +719,12 @@ class Variable:
 class RadialAttentionModel:
     """Radial attention Model class.
 
-    Loads binary data of the c setup structure. The format of the binary data
-    is specified in the documentation of the c applications.
+    Loads a save file of the c setup structure (see SaveFile).
 
     Attributes:
         __ltbl_prototype__ (str): Latex table template string.
 
-        data_path (str): Model setup save directory
+        data_path (str): Model setup save file
 
         parameters (dict): Model's parameters.
         specification (dict): Model's functional specification.
@@ -376,8 +772,7 @@ returns ($$R$$) & $$\frac{1}{\beta}$$ \\\bottomrule\bottomrule
     def __parse_fnc__(self, spec):
         """Prepare functional specification string."""
 
-        output_str = spec.split("=")[1]
-        output_str = output_str.replace(
+        output_str = spec.replace(
             "v->m->alpha", "{}".format(self.parameters["alpha"])
         )
         output_str = output_str.replace(
@@ -394,75 +789,47 @@ returns ($$R$$) & $$\frac{1}{\beta}$$ \\\bottomrule\bottomrule
         output_str = output_str.replace("v->x", "x")
         return output_str.strip()
 
-    def __init__(self, save_dir):
+    def __init__(self, save_name):
         """Constructor.
 
         Args:
-            save_dir (str): Model setup save directory.
+            save_name (str): Model setup save name (the extension is optional).
         """
 
-        self.data_path = rad_conf.RAD_DATA_DIR + "/" + save_dir
-
-        def construct_if_data_exist(data_path):
-            if os.path.isfile(data_path):
-                return Grid(data_path)
-            else:
-                raise RuntimeError(
-                    "Data path '{}' does not exist. Consider executing 'rad_msol'.".format(
-                        data_path
-                    )
+        self.data_path = rad_conf.RAD_DATA_DIR + "/" + save_name
+        if not self.data_path.endswith(".rad"):
+            self.data_path += ".rad"
+        if not os.path.isfile(self.data_path):
+            raise RuntimeError(
+                "Data path '{}' does not exist. Consider executing 'rad_msol'.".format(
+                    self.data_path
                 )
+            )
+        save_file = SaveFile(self.data_path)
 
-        self.grids["x"] = construct_if_data_exist(self.data_path + "/xg")
-        self.grids["r"] = construct_if_data_exist(self.data_path + "/rg")
-        self.grids["q"] = construct_if_data_exist(self.data_path + "/qg")
-        self.grids["s"] = construct_if_data_exist(self.data_path + "/sg")
+        for grid in ["x", "r", "q", "s"]:
+            self.grids[grid] = Grid(save_file, grid + "g")
 
-        self.variables["v0"] = Variable(
-            self.grids["x"], self.grids["r"], datafile=self.data_path + "/v0"
-        )
-        self.variables["v1"] = Variable(
-            self.grids["x"], self.grids["r"], datafile=self.data_path + "/v1"
-        )
-        self.variables["s"] = Variable(
-            self.grids["x"], self.grids["r"], datafile=self.data_path + "/spol"
-        )
-        self.variables["q"] = Variable(
-            self.grids["x"], self.grids["r"], datafile=self.data_path + "/qpol"
-        )
+        for key, name in [("v0", "v0"), ("v1", "v1"), ("s", "spol"), ("q", "qpol")]:
+            self.variables[key] = Variable(
+                self.grids["x"], self.grids["r"], save_file=save_file, name=name
+            )
 
-        with open(self.data_path + "/model", "rb") as file_handle:
-            self.parameters["alpha"] = struct.unpack("d", file_handle.read(8))[0]
-            self.parameters["beta"] = struct.unpack("d", file_handle.read(8))[0]
-            self.parameters["delta"] = struct.unpack("d", file_handle.read(8))[0]
-            self.parameters["gamma"] = struct.unpack("d", file_handle.read(8))[0]
-            self.parameters["R"] = struct.unpack("d", file_handle.read(8))[0]
-
-        with open(self.data_path + "/fncs", "r") as file_handle:
-            while True:
-                line = file_handle.readline()
-                if not line:
-                    break
-                if line.startswith("util"):
-                    self.specification["util"] = {"str": self.__parse_fnc__(line[:-1])}
-                    self.specification["util"]["fnc"] = eval(
-                        "lambda q, r, s: " + self.specification["util"]["str"]
-                    )
-                elif line.startswith("cost"):
-                    self.specification["cost"] = {"str": self.__parse_fnc__(line[:-1])}
-                    self.specification["cost"]["fnc"] = eval(
-                        "lambda r, s: " + self.specification["cost"]["str"]
-                    )
-                elif line.startswith("radt"):
-                    self.specification["radt"] = {"str": self.__parse_fnc__(line[:-1])}
-                    self.specification["radt"]["fnc"] = eval(
-                        "lambda r, s: " + self.specification["radt"]["str"]
-                    )
-                elif line.startswith("wltt"):
-                    self.specification["wltt"] = {"str": self.__parse_fnc__(line[:-1])}
-                    self.specification["wltt"]["fnc"] = eval(
-                        "lambda q, r, s, x: " + self.specification["wltt"]["str"]
-                    )
+        for param in ["alpha", "beta", "delta", "gamma", "R"]:
+            self.parameters[param] = float(save_file.meta[param])
+
+        for fnc, args in [
+            ("util", "q, r, s"),
+            ("cost", "r, s"),
+            ("radt", "r, s"),
+            ("wltt", "q, r, s, x"),
+        ]:
+            self.specification[fnc] = {
+                "str": self.__parse_fnc__(save_file.meta[fnc])
+            }
+            self.specification[fnc]["fnc"] = eval(
+                "lambda " + args + ": " + self.specification[fnc]["str"]
+            )
 
     def model_string(self):
         """Get a brace-nested, string description of the model object."""
@@ -590,15 +957,15 @@ class ParameterDependence:
     """Parameter dependence class.
 
     Comprises of functionality relevant for parameter dependence analysis of the radial attention
-    model.
+    model. The data are read from the parameter's sweep store (see SweepStore).
 
     Attributes:
         parameter_string (str): Parameter name.
-        data_files (list): List of data filenames.
+        store (SweepStore): The parameter's sweep store.
     """
 
     parameter_string = None
-    data_files = None
+    store = None
 
     def __init__(self, parameter_string):
         """Constructor.
@@ -608,15 +975,9 @@ class ParameterDependence:
         """
 
         self.parameter_string = parameter_string
-
-        self.data_files = [
-            file.replace(rad_conf.RAD_DATA_DIR + "/", "")
-            for file in glob.glob(
-                rad_conf.RAD_DATA_DIR
-                + "/{}/{}*".format(self.parameter_string, self.parameter_string)
-            )
-        ]
-        self.data_files.sort()
+        self.store = SweepStore(
+            rad_conf.RAD_DATA_DIR + "/{}.sweep".format(self.parameter_string)
+        )
 
     def save_fig(self, domain_data, ylab, yval):
         """Create, show and save in png format the figures with the responses of the value function
@@ -652,48 +1013,36 @@ class ParameterDependence:
     def save_figs(self, r_indices=None, x_indices=None):
         """Create, show and save in png format the figures with the responses of the value function
         and the optimal controls on value changes of each parameter.
-        """
 
-        if r_indices is None or x_indices is None:
-            model = RadialAttentionModel(self.data_files[0])
-            if r_indices is None:
-                r_indices = model.grids["r"].eqpart(4)[1:3]
-            if x_indices is None:
-                x_indices = model.grids["x"].eqpart(4)[1:3]
+        Kwargs:
+            r_indices (list): Radius grid indices (must be stored).
+            x_indices (list): Wealth grid indices (must be stored).
+        """
 
-        index_count = len(r_indices) * len(x_indices)
-        point_count = len(self.data_files)
+        store = self.store
+        if r_indices is None:
+            r_pos = Grid(data=store.r_values).eqpart(4)[1:3]
+        else:
+            r_pos = [list(store.r_indices).index(idx) for idx in r_indices]
+        if x_indices is None:
+            x_pos = Grid(data=store.x_values).eqpart(4)[1:3]
+        else:
+            x_pos = [list(store.x_indices).index(idx) for idx in x_indices]
+        order = np.argsort(store.values)
 
+        r_mesh, x_mesh = np.meshgrid(r_pos, x_pos, indexing="ij")
         domain_data = {
-            "param_grid": np.zeros(point_count),
-            "r_indices": r_indices,
-            "r_points": np.zeros(index_count),
-            "x_indices": x_indices,
-            "x_points": np.zeros(index_count),
-        }
-        range_data = {
-            "spol": np.zeros((index_count, point_count)),
-            "qpol": np.zeros((index_count, point_count)),
-            "v": np.zeros((index_count, point_count)),
+            "param_grid": store.values[order],
+            "r_indices": r_pos,
+            "r_points": store.r_values[r_mesh].ravel(),
+            "x_indices": x_pos,
+            "x_points": store.x_values[x_mesh].ravel(),
         }
-
-        for p_idx, p_val in enumerate(self.data_files):
-            model = RadialAttentionModel(p_val)
-            domain_data["param_grid"][p_idx] = model.parameters[self.parameter_string]
-            for r_idx, r_val in enumerate(r_indices):
-                for x_idx, x_val in enumerate(x_indices):
-                    g_idx = r_idx * len(x_indices) + x_idx
-                    domain_data["r_points"][g_idx] = model.grids["r"].data[r_val]
-                    domain_data["x_points"][g_idx] = model.grids["x"].data[x_val]
-                    range_data["spol"][g_idx, p_idx] = model.variables["s"].data[
-                        r_val, x_val
-                    ]
-                    range_data["qpol"][g_idx, p_idx] = model.variables["q"].data[
-                        r_val, x_val
-                    ]
-                    range_data["v"][g_idx, p_idx] = model.variables["v0"].data[
-                        r_val, x_val
-                    ]
+        range_data = {}
+        for key, name in [("spol", "spol"), ("qpol", "qpol"), ("v", "v0")]:
+            # [point x wealth x radius] to [(radius, wealth) x point]
+            data = store.variables[name][order][:, x_mesh, r_mesh]
+            range_data[key] = data.reshape(len(order), -1).T
 
         for key, value in range_data.items():
             self.save_fig(domain_data, key, value)